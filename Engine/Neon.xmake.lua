@@ -1,4 +1,21 @@
 includes("./Plugins/Plugins.xmake.lua")
+includes("./Tools/Tools.xmake.lua")
+
+option("shader_compiler")
+do
+    set_default(true)
+    set_showmenu(true)
+    set_description("Link shaderc and SPIRV-Cross into Neon, turn it off for shipping builds that only load the cooked shader library")
+end
+option_end()
+
+option("asset_importer")
+do
+    set_default(true)
+    set_showmenu(true)
+    set_description("Link Assimp into Neon to import source models at runtime, turn it off for builds that only load assets cooked by neon-cook")
+end
+option_end()
 
 --add_requires("vulkansdk")
 add_requires("spdlog")
@@ -38,11 +55,23 @@ do
     add_packages("libsdl3")
     add_packages("libsdl3_image")
     add_packages("glm")
-    add_packages("shaderc")
-    add_packages("spirv-cross")
     add_packages("imgui")
     --add_packages("glad")
-    add_packages("assimp")
+
+    if has_config("asset_importer") then
+        add_packages("assimp")
+        add_defines("NE_WITH_ASSET_IMPORTER=1")
+    else
+        add_defines("NE_WITH_ASSET_IMPORTER=0")
+    end
+
+    if has_config("shader_compiler") then
+        add_packages("shaderc")
+        add_packages("spirv-cross")
+        add_defines("NE_WITH_SHADER_COMPILER=1")
+    else
+        add_defines("NE_WITH_SHADER_COMPILER=0")
+    end
 
     -- set_runtimes("MT")
 
@@ -50,6 +79,9 @@ do
     if is_plat("windows") then
         add_ldflags("/subsystem:console")
     end
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
 
     before_run(function(target)
         print("before run", target:name())
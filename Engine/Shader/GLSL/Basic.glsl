@@ -1,18 +1,34 @@
+// variants cooked into the shader library, see Engine/Tools/ShaderCook
+#permutation LIT TEXTURED
+#permutation TEXTURED
+#permutation LIT TEXTURED PACKED_VERTEX DRAW_DATA
+#permutation LIT TEXTURED DRAW_DATA
+
 #type vertex
 
 #version 450 core
 
+#ifdef PACKED_VERTEX
+// VertexCompression::PackedVertex
+layout(location = 0) in vec4 aPos;    // quantized to the mesh bounds
+layout(location = 1) in vec4 aColor;
+layout(location = 2) in vec2 aUV;     // aka aTexCoord
+layout(location = 3) in vec2 aNormal; // octahedral
+#else
 layout(location = 0) in vec3 aPos; 
 layout(location = 1) in vec4 aColor;
 layout(location = 2) in vec2 aUV; // aka aTexCoord
 layout(location = 3) in vec3 aNormal; 
+#endif
 
-// Camera/transform uniforms
-layout(set = 1, binding = 0) uniform CameraBuffer {
-    mat4 model;
-    mat4 view;
-    mat4 projection;
-} uCamera;
+#include "Include/Camera.glsl"
+#ifdef PACKED_VERTEX
+#include "Include/VertexCompression.glsl"
+#define DRAW_INDEX_BINDING 2
+#endif
+#ifdef DRAW_DATA
+#include "Include/DrawData.glsl"
+#endif
 
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec2 fragUV;
@@ -23,11 +39,25 @@ void main()
 {
     // Transform vertex position with view-projection matrix
     // mvp
-    gl_Position = uCamera.projection * uCamera.view * uCamera.model * vec4(aPos, 1.0);
+#ifdef PACKED_VERTEX
+    vec3 position = dequantizePosition(aPos.xyz);
+    vec3 normal   = octahedralDecode(aNormal);
+#else
+    vec3 position = aPos;
+    vec3 normal   = aNormal;
+#endif
+#ifdef DRAW_DATA
+    DrawData drawData = currentDrawData();
+    mat4 model = drawData.model;
+    fragColor = aColor * drawData.color;
+#else
+    mat4 model = uCamera.model;
     fragColor = aColor;
+#endif
+    gl_Position = uCamera.projection * uCamera.view * model * vec4(position, 1.0);
     fragUV = aUV; 
-    fragPosition =  vec3(uCamera.view * vec4(aPos,1.0)); // Pass the vertex position to the fragment shader
-    fragNormal = normalize(aNormal);
+    fragPosition =  vec3(uCamera.view * vec4(position,1.0)); // Pass the vertex position to the fragment shader
+    fragNormal = normalize(normal);
 }
 
 // =================================================================================================
@@ -41,26 +71,35 @@ layout(location = 1) in vec2 fragUV;
 layout(location = 2) in vec3 fragPosition; // for lighting
 layout(location = 3) in vec3 fragNormal; // for lighting
 
+// Permutations: TEXTURED samples uTexture0, LIT applies the directional light, the rest is compiled out
+#ifdef TEXTURED
 layout(set=2, binding=0) uniform sampler2D uTexture0; // see comment of SDL_CreateGPUShader, the set is the rule of SDL3!!!
+#endif
 
-layout(set = 3, binding = 0) uniform CameraBuffer{
-    mat4 model;
-    mat4 view;
-    mat4 projection;
-} uCamera;
+#define CAMERA_BUFFER_SET 3
+#include "Include/Camera.glsl"
 
+#ifdef LIT
 layout(set = 3, binding = 1) uniform LightBuffer {
     vec4 lightDir; 
     vec4 lightColor;
     float ambientIntensity;  
     float specularPower; 
 } uLight; 
+#endif
 
 
 layout(location = 0) out vec4 outColor;
 
 void main() 
 {
+#ifdef TEXTURED
+    vec4 texColor = texture(uTexture0, fragUV);
+#else
+    vec4 texColor = fragColor;
+#endif
+
+#ifdef LIT
     vec3 N = normalize(fragNormal); 
     vec3 L = normalize(- vec3(uLight.lightDir)); // Light direction
     vec3 halfDir = normalize(L + fragPosition); // Halfway vector between light and view direction
@@ -70,10 +109,12 @@ void main()
     float specular = pow(max(0.0, dot(N, halfDir)), uLight.specularPower);  // 高光
     vec3 ambient = uLight.ambientIntensity * LC; // 环境光
 
-    // Sample texture and compute final color
-    vec4 texColor = texture(uTexture0, fragUV);
+    // compute final color
     vec3 lighting = (ambient + diffuse) * texColor.rgb 
                     + specular * LC;
+#else
+    vec3 lighting = texColor.rgb;
+#endif
 
     outColor = vec4(lighting, fragColor.a);
 }
@@ -0,0 +1,21 @@
+// Camera/transform uniforms shared by the stages
+// SDL wants the vertex uniforms in set 1 and the fragment uniforms in set 3, define CAMERA_BUFFER_SET before the include.
+// The DRAW_DATA variants take the model matrix from Include/DrawData.glsl instead.
+// CAMERA_VIEW_PROJECTION is the 2D layout: a single premultiplied matrix, the vertices are already in world space
+#ifndef CAMERA_BUFFER_SET
+#define CAMERA_BUFFER_SET 1
+#endif
+
+#ifdef CAMERA_VIEW_PROJECTION
+layout(set = CAMERA_BUFFER_SET, binding = 0) uniform CameraBuffer {
+    mat4 viewProjection;
+} uCamera;
+#else
+layout(set = CAMERA_BUFFER_SET, binding = 0) uniform CameraBuffer {
+#ifndef DRAW_DATA
+    mat4 model;
+#endif
+    mat4 view;
+    mat4 projection;
+} uCamera;
+#endif
@@ -0,0 +1,30 @@
+// Per-draw data written once per frame by SDL::SDLUniformRing, indexed with the draw index pushed before each draw
+// SDL wants the vertex storage buffers in set 0 and the vertex uniforms in set 1, define DRAW_INDEX_BINDING
+// before the include when binding 1 of the uniforms is taken
+#ifndef DRAW_DATA_GLSL
+#define DRAW_DATA_GLSL
+
+#ifndef DRAW_INDEX_BINDING
+#define DRAW_INDEX_BINDING 1
+#endif
+
+// SDLRender3D::DrawData
+struct DrawData {
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData entries[];
+} uDrawData;
+
+layout(set = 1, binding = DRAW_INDEX_BINDING) uniform DrawIndex {
+    uint index;
+} uDrawIndex;
+
+DrawData currentDrawData()
+{
+    return uDrawData.entries[uDrawIndex.index];
+}
+
+#endif
@@ -0,0 +1,26 @@
+// Decoding of the compact vertex streams, see Engine/Source/Render/VertexCompression.h
+// The vertex uniforms live in set 1, binding 0 is the camera
+#ifndef VERTEX_COMPRESSION_GLSL
+#define VERTEX_COMPRESSION_GLSL
+
+// VertexCompression::QuantizationUniform
+layout(set = 1, binding = 1) uniform QuantizationBuffer {
+    vec4 offset;
+    vec4 scale;
+} uQuantization;
+
+vec3 dequantizePosition(vec3 packed)
+{
+    return packed * uQuantization.scale.xyz + uQuantization.offset.xyz;
+}
+
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+#endif
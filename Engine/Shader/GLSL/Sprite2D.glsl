@@ -6,9 +6,8 @@ layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec4 aColor;
 // layout(location = 2) in vec2 aUV;
 
-layout(set = 1, binding = 0) uniform CameraData {
-    mat4 viewProjection;
-} uCamera;
+#define CAMERA_VIEW_PROJECTION
+#include "Include/Camera.glsl"
 
 layout(location = 0) out vec4 fragColor;
 // layout(location = 1) out vec2 fragUV;
@@ -7,12 +7,7 @@ layout(location = 1) in vec4 aColor;
 layout(location = 2) in vec2 aUV; // aka aTexCoord
 layout(location = 3) in vec3 aNormal; 
 
-// Camera/transform uniforms
-layout(set = 1, binding = 0) uniform CameraBuffer {
-    mat4 model;
-    mat4 view;
-    mat4 projection;
-} uCamera;
+#include "Include/Camera.glsl"
 
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec2 fragUV;
@@ -51,11 +46,8 @@ layout(set=2, binding=0) uniform sampler2D uTexture0; // see comment of SDL_Crea
 
 
 
-layout(set = 3, binding = 0) uniform CameraBuffer{
-    mat4 model;
-    mat4 view;
-    mat4 projection;
-} uCamera;
+#define CAMERA_BUFFER_SET 3
+#include "Include/Camera.glsl"
 layout(set = 3, binding = 1) uniform LightBuffer {
     vec3 lightDir; // Direction of light
 } uLight; // for lighting
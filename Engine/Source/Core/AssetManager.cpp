@@ -1,160 +1,266 @@
 #include "AssetManager.h"
 
-
-#include "assimp/Importer.hpp"
-#include "assimp/ObjMaterial.h"
+#include <algorithm>
 
 #include "Core/FileSystem/FileSystem.h"
 #include "Core/Log.h"
+#include "Render/MeshFile.h"
+#include "Render/ModelImporter.h"
+
+
+
+namespace
+{
 
+// for requests of a finished model, the cache keeps the model but not the future of its load
+ModelFuture readyFuture(std::shared_ptr<Model> model)
+{
+    std::promise<std::shared_ptr<Model>> promise;
+    promise.set_value(std::move(model));
+    return promise.get_future().share();
+}
 
+} // namespace
 
 AssetManager *AssetManager::instance = nullptr;
 
 void AssetManager::init()
 {
     instance = new AssetManager();
+    NE_CORE_INFO("AssetManager started with {} load workers, {} MB model cache budget",
+                 instance->loadPool.size(),
+                 instance->memoryBudget.load() >> 20);
 }
 
-std::shared_ptr<Model> AssetManager::loadModel(const std::string &filepath, std::shared_ptr<CommandBuffer> commandBuffer)
+void AssetManager::shutdown()
 {
-    // Check if the model is already loaded
-    if (isModelLoaded(filepath)) {
-        return modelCache[filepath];
-    }
-
-    // Create a new model
-    auto             model = std::make_shared<Model>();
-    Assimp::Importer importer;
-
-    // Get directory path for texture loading
-    size_t      lastSlash = filepath.find_last_of("/\\");
-    std::string directory = (lastSlash != std::string::npos) ? filepath.substr(0, lastSlash + 1) : "";
+    // joins the workers, pending loads are finished first
+    delete instance;
+    instance = nullptr;
+}
 
-    // Check if file exists using FileSystem
-    if (!FileSystem::get()->isFileExists(filepath)) {
-        NE_CORE_ERROR("Model file does not exist: {}", filepath);
-        return nullptr;
-    }
+ModelFuture AssetManager::loadModelAsync(const std::string &filepath, ModelCallback onLoaded)
+{
+    auto        promise = std::make_shared<std::promise<std::shared_ptr<Model>>>();
+    ModelFuture future  = promise->get_future().share();
+    {
+        ModelShard     &shard = shardOf(filepath);
+        std::lock_guard lock(shard.mutex);
+        if (auto it = shard.models.find(filepath); it != shard.models.end()) {
+            ModelEntry &entry = it->second;
+            entry.lastUse     = ++useClock;
+            ++hits;
+            if (!entry.bDone) {
+                if (onLoaded) {
+                    entry.callbacks.push_back(std::move(onLoaded));
+                }
+                return entry.future;
+            }
+            if (onLoaded) {
+                queueCompletion(std::move(onLoaded), entry.model);
+            }
+            return readyFuture(entry.model);
+        }
 
-    // Read the file using FileSystem
-    std::string fileContent;
-    if (!FileSystem::get()->readFileToString(filepath, fileContent)) {
-        NE_CORE_ERROR("Failed to read model file: {}", filepath);
-        return nullptr;
+        ++misses;
+        ModelEntry &entry = shard.models[filepath];
+        entry.future      = future;
+        entry.lastUse     = ++useClock;
+        if (onLoaded) {
+            entry.callbacks.push_back(std::move(onLoaded));
+        }
     }
 
-    // Load the model using Assimp
-    const aiScene *scene = importer.ReadFileFromMemory(
-        fileContent.data(),
-        fileContent.size(),
-        aiProcess_Triangulate |
-            aiProcess_GenSmoothNormals |
-            aiProcess_FlipUVs |
-            aiProcess_CalcTangentSpace);
+    loadPool.enqueue([this, filepath, promise]() mutable {
+        auto model = load(filepath);
+        // the entry first, so a request racing with the promise already sees the model as done
+        finish(filepath, model);
+        promise->set_value(std::move(model));
+        // the shared state holds the model as long as the promise, only the futures handed out should keep it
+        promise.reset();
+        trim();
+    });
+    return future;
+}
 
+std::shared_ptr<Model> AssetManager::loadModel(const std::string &filepath, std::shared_ptr<CommandBuffer> commandBuffer)
+{
+    return loadModelAsync(filepath).get();
+}
 
-    // Check for errors
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        NE_CORE_ERROR("Assimp error: {}", importer.GetErrorString());
-        return nullptr;
+void AssetManager::pumpCompletions(std::size_t maxCount)
+{
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard lock(completionMutex);
+        std::size_t     count = std::min(maxCount, completions.size());
+        ready.assign(std::make_move_iterator(completions.begin()), std::make_move_iterator(completions.begin() + count));
+        completions.erase(completions.begin(), completions.begin() + count);
     }
+    for (auto &completion : ready) {
+        completion();
+    }
+    // the callbacks above may have dropped the last references to models
+    trim();
+}
 
-    // Process all meshes in the scene
-    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
-        aiMesh *mesh = scene->mMeshes[i];
-        Mesh    newMesh;
-
-        // Get mesh name
-        newMesh.name = mesh->mName.length > 0 ? mesh->mName.C_Str() : "unnamed_mesh";
-
-        // Process vertices
-        for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
-            Vertex vertex;
+void AssetManager::setMemoryBudget(std::size_t bytes)
+{
+    memoryBudget = bytes;
+    trim();
+}
 
-            // Position
-            vertex.position.x = mesh->mVertices[j].x;
-            vertex.position.y = mesh->mVertices[j].y;
-            vertex.position.z = mesh->mVertices[j].z;
+AssetManager::CacheStats AssetManager::getCacheStats() const
+{
+    return CacheStats{
+        .hits      = hits,
+        .misses    = misses,
+        .evictions = evictions,
+        .bytes     = cachedBytes,
+        .budget    = memoryBudget,
+    };
+}
 
-            // Normal
-            if (mesh->HasNormals()) {
-                vertex.normal.x = mesh->mNormals[j].x;
-                vertex.normal.y = mesh->mNormals[j].y;
-                vertex.normal.z = mesh->mNormals[j].z;
+std::size_t AssetManager::trim()
+{
+    if (cachedBytes <= memoryBudget) {
+        return 0;
+    }
+    std::lock_guard trimLock(trimMutex);
+
+    struct Candidate
+    {
+        std::size_t shard;
+        std::string filepath;
+        uint64_t    lastUse;
+    };
+    std::vector<Candidate> candidates;
+    for (std::size_t i = 0; i < CACHE_SHARDS; ++i) {
+        std::lock_guard lock(modelShards[i].mutex);
+        for (const auto &[filepath, entry] : modelShards[i].models) {
+            if (entry.bDone && entry.model.use_count() == 1) {
+                candidates.push_back({.shard = i, .filepath = filepath, .lastUse = entry.lastUse});
             }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) { return a.lastUse < b.lastUse; });
 
-            // Texture coordinates
-            if (mesh->mTextureCoords[0]) {
-                vertex.texCoord.x = mesh->mTextureCoords[0][j].x;
-                vertex.texCoord.y = mesh->mTextureCoords[0][j].y;
-            }
-            else {
-                vertex.texCoord = glm::vec2(0.0f, 0.0f);
+    std::size_t freed = 0;
+    std::size_t count = 0;
+    for (const Candidate &candidate : candidates) {
+        if (cachedBytes <= memoryBudget) {
+            break;
+        }
+        std::shared_ptr<Model> evicted; // destroyed outside the lock, unmapping a file is not free
+        std::size_t            bytes = 0;
+        {
+            ModelShard     &shard = modelShards[candidate.shard];
+            std::lock_guard lock(shard.mutex);
+            auto            it = shard.models.find(candidate.filepath);
+            // requested or referenced again since the scan
+            if (it == shard.models.end() || it->second.lastUse != candidate.lastUse || it->second.model.use_count() != 1) {
+                continue;
             }
+            evicted = std::move(it->second.model);
+            bytes   = it->second.bytes;
+            shard.models.erase(it);
+        }
+        cachedBytes -= bytes;
+        freed += bytes;
+        ++count;
+    }
+    evictions += count;
 
-            // Colors - default white if no colors are available
-            if (mesh->HasVertexColors(0)) {
-                vertex.color.r = mesh->mColors[0][j].r;
-                vertex.color.g = mesh->mColors[0][j].g;
-                vertex.color.b = mesh->mColors[0][j].b;
-                vertex.color.a = mesh->mColors[0][j].a;
-            }
-            else {
-                vertex.color = glm::vec4(1.0f);
-            }
+    if (count > 0) {
+        NE_CORE_INFO("Evicted {} models ({} KB), model cache at {} / {} KB", count, freed >> 10, cachedBytes.load() >> 10, memoryBudget.load() >> 10);
+    }
+    return freed;
+}
 
-            newMesh.vertices.push_back(std::move(vertex));
-        }
+std::shared_ptr<Model> AssetManager::load(const std::string &filepath) const
+{
+    // Get directory path for texture loading
+    size_t      lastSlash = filepath.find_last_of("/\\");
+    std::string directory = (lastSlash != std::string::npos) ? filepath.substr(0, lastSlash + 1) : "";
 
-        // Process indices
-        for (unsigned int j = 0; j < mesh->mNumFaces; j++) {
-            aiFace face = mesh->mFaces[j];
-            for (unsigned int k = 0; k < face.mNumIndices; k++) {
-                newMesh.indices.push_back(face.mIndices[k]);
-            }
+    // Cooked meshes are mapped, the meshes point straight into the file
+    if (std::filesystem::path(filepath).extension() == MeshFile::EXTENSION) {
+        auto model = MeshFile::load(filepath);
+        if (model) {
+            model->setDirectory(directory);
         }
+        return model;
+    }
 
-        // Process materials/textures
-        // if (mesh->mMaterialIndex >= 0 && commandBuffer) {
-        //     aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-
-        //     // Load diffuse texture
-        //     if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-        //         aiString texturePath;
-        //         if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS) {
-        //             std::string fullPath = (std::filesystem::path(directory) / texturePath.C_Str()).string();
-        //             if (FileSystem::get()->isFileExists(fullPath)) {
-        //                 newMesh.diffuseTexture = Texture::CreateFromFile(fullPath, commandBuffer);
-        //             }
-        //         }
-        //     }
-        //     // You can add more texture types here (normal maps, specular maps, etc.)
-        // }
-
-        model->getMeshes().push_back(newMesh);
+#if NE_WITH_ASSET_IMPORTER
+    // Check if file exists using FileSystem
+    if (!FileSystem::get()->isFileExists(filepath)) {
+        NE_CORE_ERROR("Model file does not exist: {}", filepath);
+        return nullptr;
     }
 
-    model->setIsLoaded(true);
-    model->setDirectory(directory);
+    auto model = ModelImporter::import(filepath, ModelImporter::Options{.bPackVertices = bPackVertices});
+    if (model) {
+        model->setDirectory(directory);
+    }
+    return model;
+#else
+    NE_CORE_ERROR("{} is not cooked and this build has no model importer, run neon-cook", filepath);
+    return nullptr;
+#endif
+}
 
-    // Cache the model
-    modelCache[filepath] = model;
+void AssetManager::finish(const std::string &filepath, std::shared_ptr<Model> model)
+{
+    std::vector<ModelCallback> callbacks;
+    {
+        ModelShard     &shard = shardOf(filepath);
+        std::lock_guard lock(shard.mutex);
+        auto            it = shard.models.find(filepath);
+        callbacks          = std::move(it->second.callbacks);
+        if (model) {
+            it->second.model   = model;
+            it->second.bDone   = true;
+            it->second.future  = {};
+            it->second.bytes   = model->getMemoryUsage();
+            it->second.lastUse = ++useClock;
+            cachedBytes += it->second.bytes;
+        }
+        else {
+            // not cached, the next request tries again
+            shard.models.erase(it);
+        }
+    }
+    for (auto &callback : callbacks) {
+        queueCompletion(std::move(callback), model);
+    }
+}
 
-    return model;
+void AssetManager::queueCompletion(ModelCallback callback, std::shared_ptr<Model> model)
+{
+    std::lock_guard lock(completionMutex);
+    completions.push_back([callback = std::move(callback), model = std::move(model)]() { callback(model); });
 }
 
 
 
 bool AssetManager::isModelLoaded(const std::string &filepath) const
 {
-    return modelCache.find(filepath) != modelCache.end();
+    // not a use, does not refresh the entry
+    const ModelShard &shard = shardOf(filepath);
+    std::lock_guard   lock(shard.mutex);
+    auto              it = shard.models.find(filepath);
+    return it != shard.models.end() && it->second.model != nullptr;
 }
 
 std::shared_ptr<Model> AssetManager::getModel(const std::string &filepath) const
 {
-    if (isModelLoaded(filepath)) {
-        return modelCache.at(filepath);
+    const ModelShard &shard = shardOf(filepath);
+    std::lock_guard   lock(shard.mutex);
+    auto              it = shard.models.find(filepath);
+    if (it == shard.models.end()) {
+        return nullptr;
     }
-    return nullptr;
+    it->second.lastUse = ++useClock;
+    return it->second.model;
 }
@@ -1,42 +1,123 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-
-
+#include "Core/ThreadPool.h"
 #include "Render/Model.h"
 #include "Render/Texture.h"
 
+using ModelFuture = std::shared_future<std::shared_ptr<Model>>; // holds nullptr if the load failed
+
+// Loads models on a worker pool. Requests for the same path share one load, finished models stay cached.
+// The cache is split in shards with their own lock, so lookups from many threads rarely contend.
+// The cached models are accounted in bytes (Model::getMemoryUsage). Over the memory budget, the least recently
+// used ones that nothing outside the cache references are dropped, see `trim`.
+// Completion callbacks (e.g. the GPU upload) are queued and run by `pumpCompletions` on the main thread
 class AssetManager
 {
+  public:
+    using ModelCallback = std::function<void(const std::shared_ptr<Model> &)>;
+
+    static constexpr std::size_t CACHE_SHARDS          = 16;
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = std::size_t(512) << 20;
+
+    struct CacheStats
+    {
+        uint64_t    hits      = 0; // loadModelAsync requests served by a cached or in-flight load
+        uint64_t    misses    = 0; // loadModelAsync requests that started a load
+        uint64_t    evictions = 0;
+        std::size_t bytes     = 0; // of the cached models
+        std::size_t budget    = 0;
+    };
+
   private:
     static AssetManager *instance;
 
-    // Cache for loaded models
-    std::unordered_map<std::string, std::shared_ptr<Model>>   modelCache;
-    std::unordered_map<std::string, std::shared_ptr<Texture>> textureCache;
+    struct ModelEntry
+    {
+        ModelFuture                future; // reset once the load finished, so `model` counts the owners
+        std::shared_ptr<Model>     model;  // set once the load finished
+        bool                       bDone = false;
+        std::vector<ModelCallback> callbacks; // waiting for the load
+        std::size_t                bytes   = 0;
+        mutable uint64_t           lastUse = 0; // `useClock` at the last request
+    };
+
+    struct ModelShard
+    {
+        mutable std::mutex                          mutex;
+        std::unordered_map<std::string, ModelEntry> models;
+    };
+
+    std::array<ModelShard, CACHE_SHARDS> modelShards;
+
+    mutable std::atomic<uint64_t> useClock     = 0;
+    std::atomic<std::size_t>      cachedBytes  = 0;
+    std::atomic<std::size_t>      memoryBudget = DEFAULT_MEMORY_BUDGET;
+    std::atomic<uint64_t>         hits         = 0;
+    std::atomic<uint64_t>         misses       = 0;
+    std::atomic<uint64_t>         evictions    = 0;
+    std::mutex                    trimMutex; // one trim at a time
 
-    // Assimp importer
-    Assimp::Importer importer;
+    std::mutex                         completionMutex;
+    std::vector<std::function<void()>> completions; // run on the main thread
+
+    // also produce Mesh::packed at import, SDLRender3D then draws the model with the PACKED_VERTEX pipeline
+    std::atomic<bool> bPackVertices = false;
+
+    // last, so it is joined before the shards and the queue above are destroyed
+    ThreadPool loadPool{"AssetLoad"};
 
   public:
     static void          init();
+    static void          shutdown();
     static AssetManager *get() { return instance; }
 
     AssetManager()  = default;
     ~AssetManager() = default;
 
-    // Model loading
+    // Returns the in-flight/finished load of `filepath`, starts one if there is none.
+    // `onLoaded` runs on the main thread in `pumpCompletions`, also when the model was already loaded, with nullptr on failure.
+    // A cooked .nmesh (see MeshFile) is mapped instead of imported
+    ModelFuture loadModelAsync(const std::string &filepath, ModelCallback onLoaded = {});
+
+    // Blocking load, do not call it from an asset load task
     std::shared_ptr<Model> loadModel(const std::string &filepath, std::shared_ptr<CommandBuffer> commandBuffer);
 
+    // Main thread, once per frame: runs the callbacks of the finished loads, at most `maxCount` of them
+    void pumpCompletions(std::size_t maxCount = SIZE_MAX);
+
     // Check if a model is already loaded
     bool isModelLoaded(const std::string &filepath) const;
 
-    // Get a loaded model
+    // Get a loaded model, nullptr while it is loading
     std::shared_ptr<Model> getModel(const std::string &filepath) const;
-};
\ No newline at end of file
+
+    void setPackVertices(bool bPack) { bPackVertices = bPack; }
+
+    // CPU bytes the cached models may take before `trim` evicts, trims right away if lowered
+    void        setMemoryBudget(std::size_t bytes);
+    std::size_t getMemoryBudget() const { return memoryBudget; }
+    CacheStats  getCacheStats() const;
+
+    // Evicts the least recently used models only the cache still owns until the cached bytes fit the budget,
+    // returns the bytes freed. Models referenced elsewhere stay, the cache may remain over budget.
+    // Runs after each load and in `pumpCompletions`, cheap while under budget
+    std::size_t trim();
+
+  private:
+    ModelShard       &shardOf(const std::string &filepath) { return modelShards[std::hash<std::string>{}(filepath) % CACHE_SHARDS]; }
+    const ModelShard &shardOf(const std::string &filepath) const { return modelShards[std::hash<std::string>{}(filepath) % CACHE_SHARDS]; }
+
+    std::shared_ptr<Model> load(const std::string &filepath) const;
+    void                   finish(const std::string &filepath, std::shared_ptr<Model> model);
+    void                   queueCompletion(ModelCallback callback, std::shared_ptr<Model> model);
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Minimal little-endian-as-host binary writer/reader for our cache/cooked files.
+// Only trivially copyable values and length prefixed strings, no versioning magic here,
+// each file format writes its own header.
+
+struct BinaryWriter
+{
+    std::vector<uint8_t> buffer;
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void write(const T &value)
+    {
+        writeBytes(&value, sizeof(T));
+    }
+
+    void writeBytes(const void *data, std::size_t size)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    void writeString(std::string_view str)
+    {
+        write<uint16_t>(static_cast<uint16_t>(str.size()));
+        writeBytes(str.data(), str.size());
+    }
+
+    std::string_view view() const { return {reinterpret_cast<const char *>(buffer.data()), buffer.size()}; }
+};
+
+struct BinaryReader
+{
+    const uint8_t *data   = nullptr;
+    std::size_t    size   = 0;
+    std::size_t    cursor = 0;
+    bool           bOk    = true; // sticky, any out of range read fails all following reads
+
+    BinaryReader(const void *data, std::size_t size)
+        : data(static_cast<const uint8_t *>(data)), size(size) {}
+    BinaryReader(std::string_view bytes)
+        : BinaryReader(bytes.data(), bytes.size()) {}
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool read(T &value)
+    {
+        return readBytes(&value, sizeof(T));
+    }
+
+    bool readBytes(void *out, std::size_t count)
+    {
+        if (!bOk || cursor + count > size) {
+            bOk = false;
+            return false;
+        }
+        std::memcpy(out, data + cursor, count);
+        cursor += count;
+        return true;
+    }
+
+    bool readString(std::string &out)
+    {
+        uint16_t len = 0;
+        if (!read(len) || cursor + len > size) {
+            bOk = false;
+            return false;
+        }
+        out.assign(reinterpret_cast<const char *>(data + cursor), len);
+        cursor += len;
+        return true;
+    }
+
+    bool eof() const { return cursor >= size; }
+};
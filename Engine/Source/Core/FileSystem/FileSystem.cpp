@@ -1,4 +1,8 @@
 #include "FileSystem.h"
+
+#include <fstream>
+
+#include "Core/FileSystem/MappedFile.h"
 #include "Core/Log.h"
 #include "utility/file_utils.h"
 
@@ -22,6 +26,31 @@ bool FileSystem::readFileToString(std::string_view filepath, std::string &output
         NE_CORE_ERROR("Failed to read file: {}", std::filesystem::absolute(fullPath).string());
         return false;
     }
-    output = *opt;
+    output = std::move(*opt);
     return true;
 }
+
+std::shared_ptr<MappedFile> FileSystem::mapFile(std::string_view filepath) const
+{
+    return MappedFile::open(projectRoot / filepath);
+}
+
+bool FileSystem::writeFile(std::string_view filepath, std::string_view content) const
+{
+    std::filesystem::path fullPath = projectRoot / filepath;
+
+    std::error_code ec;
+    std::filesystem::create_directories(fullPath.parent_path(), ec);
+    if (ec) {
+        NE_CORE_ERROR("Failed to create directory: {} {}", fullPath.parent_path().string(), ec.message());
+        return false;
+    }
+
+    std::ofstream file(fullPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        NE_CORE_ERROR("Failed to open file for writing: {}", std::filesystem::absolute(fullPath).string());
+        return false;
+    }
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return file.good();
+}
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
+class MappedFile;
 
 struct FileSystem
 {
@@ -35,6 +37,10 @@ struct FileSystem
     const std::unordered_map<std::string, stdpath> &getMountRoots() const { return mountRoots; }
 
     bool readFileToString(std::string_view filepath, std::string &output) const;
+    // read-only mapping of the whole file instead of a copy, nullptr on failure
+    std::shared_ptr<MappedFile> mapFile(std::string_view filepath) const;
+    // create the parent directories if needed, overwrite the old one
+    bool writeFile(std::string_view filepath, std::string_view content) const;
     bool isFileExists(const std::string &filepath) const
     {
         return std::filesystem::exists(projectRoot / filepath);
@@ -0,0 +1,109 @@
+#include "MappedFile.h"
+
+#include "Core/Log.h"
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+
+#if _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::filesystem::path &path)
+{
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        NE_CORE_ERROR("Failed to open file for mapping: {}", path.string());
+        return nullptr;
+    }
+
+    auto mapped        = std::make_shared<MappedFile>();
+    mapped->fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        NE_CORE_ERROR("Failed to get the size of {}", path.string());
+        return nullptr;
+    }
+    mapped->size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (mapped->size == 0) {
+        return mapped;
+    }
+
+    mapped->mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapped->mappingHandle) {
+        NE_CORE_ERROR("Failed to create a file mapping of {}", path.string());
+        return nullptr;
+    }
+    mapped->data = static_cast<const uint8_t *>(MapViewOfFile(mapped->mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!mapped->data) {
+        NE_CORE_ERROR("Failed to map {}", path.string());
+        return nullptr;
+    }
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::filesystem::path &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        NE_CORE_ERROR("Failed to open file for mapping: {}", path.string());
+        return nullptr;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        NE_CORE_ERROR("Failed to get the size of {}", path.string());
+        ::close(fd);
+        return nullptr;
+    }
+
+    auto mapped  = std::make_shared<MappedFile>();
+    mapped->size = static_cast<std::size_t>(info.st_size);
+    if (mapped->size > 0) {
+        void *address = mmap(nullptr, mapped->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            NE_CORE_ERROR("Failed to map {}", path.string());
+            ::close(fd);
+            return nullptr;
+        }
+        // the whole file is read front to back by the uploads
+        madvise(address, mapped->size, MADV_SEQUENTIAL);
+        mapped->data = static_cast<const uint8_t *>(address);
+    }
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+    return mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data) {
+        munmap(const_cast<uint8_t *>(data), size);
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, the pages are loaded by the OS on first touch.
+// Cooked assets point straight into the mapping instead of copying, keep the MappedFile alive as long as they are used
+class MappedFile
+{
+    const uint8_t *data = nullptr;
+    std::size_t    size = 0;
+#if _WIN32
+    void *fileHandle    = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+  public:
+    // nullptr if the file does not exist or cannot be mapped, an empty file maps to an empty view
+    static std::shared_ptr<MappedFile> open(const std::filesystem::path &path);
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t   *getData() const { return data; }
+    std::size_t      getSize() const { return size; }
+    std::string_view view() const { return {reinterpret_cast<const char *>(data), size}; }
+};
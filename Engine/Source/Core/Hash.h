@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Hash
+{
+
+inline constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+inline constexpr uint64_t FNV_PRIME        = 0x100000001b3ull;
+
+// FNV-1a, stable across runs and platforms, so it is safe to store in cache files
+inline uint64_t fnv1a64(const void *data, std::size_t size, uint64_t seed = FNV_OFFSET_BASIS)
+{
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    uint64_t    hash  = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a64(std::string_view str, uint64_t seed = FNV_OFFSET_BASIS)
+{
+    return fnv1a64(str.data(), str.size(), seed);
+}
+
+inline uint64_t combine(uint64_t seed, uint64_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+} // namespace Hash
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed size FIFO worker pool. Tasks should not block on futures produced by the same pool,
+// chain the work with continuations instead or the workers may deadlock.
+class ThreadPool
+{
+    std::vector<std::thread>          workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex                        mutex;
+    std::condition_variable           cv;
+    bool                              bStopping = false;
+    std::string                       name;
+
+  public:
+    explicit ThreadPool(std::string_view name, std::size_t numThreads = 0)
+        : name(name)
+    {
+        if (numThreads == 0) {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(numThreads);
+        for (std::size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            bStopping = true;
+        }
+        cv.notify_all();
+        for (auto &worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t        size() const { return workers.size(); }
+    const std::string &getName() const { return name; }
+
+    template <typename F>
+    auto enqueue(F &&func) -> std::future<std::invoke_result_t<F>>
+    {
+        using R   = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+
+        std::future<R> future = task->get_future();
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace([task]() { (*task)(); });
+        }
+        cv.notify_one();
+        return future;
+    }
+
+  private:
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                cv.wait(lock, [this]() { return bStopping || !tasks.empty(); });
+                // drain the queue before exiting, pending futures still get their value
+                if (bStopping && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+};
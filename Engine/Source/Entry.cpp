@@ -5,6 +5,7 @@
 #include "SDL3/SDL_timer.h"
 
 #include <glm/glm.hpp>
+#include <glm/ext/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 
@@ -21,26 +22,32 @@
 
 #include "Core/AssetManager.h"
 #include "Platform/Render/SDL/SDLGPUCommandBuffer.h"
+#include "Render/ClusterCulling.h"
+#include "Render/MeshLodSelection.h"
 #include "Render/Model.h"
+#include "Render/ShaderBuildService.h"
+#include "Render/ShaderLibrary.h"
+#include "Render/UniformLayout.h"
+#include "Render/VertexLayout.h"
 
 
 #include "Platform/Render/SDL/SDLGPURender2D.h"
 #include "Platform/Render/SDL/SDLGPURender3D.h"
+#include "Platform/Render/SDL/SDLShaderHotReload.h"
 
 
 
-#define ENABLE_RENDER_3D 0
+#define ENABLE_RENDER_3D 1
 #define ENABLE_RENDER_2D 1
 #define ENABLE_IMGUI 1
+#define ENABLE_SHADER_HOT_RELOAD NE_WITH_SHADER_COMPILER
 
 
-SDL_GPUTexture *faceTexture  = nullptr;
-SDL_GPUTexture *whiteTexture = nullptr;
+std::shared_ptr<Texture> whiteTexture; // uTexture0 of the 3D draws, the meshes have no GPU textures yet
 
 static bool bVsync = true;
 
 // App              app;
-AssetManager assetManager;
 
 EditorCamera    camera;
 InputManager    inputManager;
@@ -50,25 +57,29 @@ SDL::SDLDevice *device = new SDL::SDLDevice();
 #if ENABLE_RENDER_3D
 SDL::SDLRender3D *render3d = new SDL::SDLRender3D();
 #endif
-SDL::SDLRender3D *render3d = new SDL::SDLRender3D();
 #if ENABLE_RENDER_2D
 SDL::SDLRender2D *render2d = new SDL::SDLRender2D();
 #endif
 #if ENABLE_IMGUI
 Neon::ImguiState imguiState;
 #endif
+#if ENABLE_SHADER_HOT_RELOAD
+SDL::SDLShaderHotReload shaderHotReload;
+#endif
 
 std::queue<std::function<void()>> asyncUpdateTask;
 
 
-// Current loaded model
-std::shared_ptr<Model> currentModel;
-bool                   useModel = false;
+#if ENABLE_RENDER_3D
+// the editable quad below as a one mesh model, and the model loaded from the "Model Controls"
+SDL::SDLRender3D::GPUModel quadModel;
+SDL::SDLRender3D::GPUModel currentModel;
+#endif
+bool useModel = false;
 
 // Dialog window for file operations
 std::unique_ptr<NeonEngine::DialogWindow> dialogWindow;
 
-// TODO: reflect this and auto generate VertexBufferDescription and VertexAttribute
 struct VertexEntry
 {
     glm::vec3 position;
@@ -82,8 +93,7 @@ struct IndexEntry
     uint32_t a, b, c;
 };
 
-// NOTICE: unifrom data member vec3 need to be aligned by vec4 bytes
-
+// uLight in Basic.glsl, std140: the layout below fails to compile if a member is misaligned
 struct FragmentConstUniforms
 {
     glm::vec4 lightDir         = {0.0, 0.0, -1.0, 1.0};
@@ -91,6 +101,12 @@ struct FragmentConstUniforms
     float     ambientIntensity = 1.f;
     float     specularPower    = 1.f;
 };
+constexpr auto FragmentConstUniformsLayout = makeUniformLayout<FragmentConstUniforms>(
+    "uLight",
+    NE_UNIFORM_MEMBER(FragmentConstUniforms, lightDir),
+    NE_UNIFORM_MEMBER(FragmentConstUniforms, lightColor),
+    NE_UNIFORM_MEMBER(FragmentConstUniforms, ambientIntensity),
+    NE_UNIFORM_MEMBER(FragmentConstUniforms, specularPower));
 
 std::vector<VertexEntry> vertices = {
     // lt
@@ -139,49 +155,53 @@ struct SDLAppState
 
 
 #if ENABLE_RENDER_3D
-void initShaderData()
+// `vertices`/`indices` as a Model, uploaded again whenever they are edited
+bool uploadQuad(SDL_GPUCommandBuffer *commandBuffer)
 {
-    auto commandBuffer = render->acquireCommandBuffer();
-
-    for (auto &vertex : vertices) {
-        vertex.position = quadTransform * glm::vec4(vertex.position, 1.0f);
+    auto  model = std::make_shared<Model>();
+    Mesh &mesh  = model->getMeshes().emplace_back();
+    mesh.name   = "Quad";
+    for (const auto &vertex : vertices) {
+        mesh.vertices.push_back(Vertex{
+            .position = vertex.position,
+            .normal   = vertex.normal,
+            .texCoord = vertex.uv,
+            .color    = vertex.color,
+        });
+    }
+    for (const auto &triangle : indices) {
+        mesh.indices.insert(mesh.indices.end(), {triangle.a, triangle.b, triangle.c});
     }
+    mesh.narrowIndices();
+    model->setTransform(quadTransform);
 
-    // setup init vertex buffer
-    // commandBuffer->uploadBuffers(
-    //     vertices.data(),
-    //     static_cast<Uint32>(vertices.size() * sizeof(VertexEntry)),
-    //     indices.data(),
-    //     static_cast<Uint32>(indices.size() * sizeof(IndexEntry)));
+    return render3d->uploadModel(commandBuffer, model, quadModel);
+}
 
-    // Load textures using the new Texture abstraction
-    std::shared_ptr<Texture> faceTextureObj = Texture::Create("Engine/Content/TestTextures/face.png", commandBuffer);
+void initShaderData()
+{
+    auto commandBuffer = device->acquireCommandBuffer();
 
-    faceTexture = faceTextureObj ? faceTextureObj->GetSDLTexture() : nullptr;
+    uploadQuad(commandBuffer->getNativeCommandBufferPtr<SDL_GPUCommandBuffer>());
 
     // Create a 1x1 white texture (all pixels are white)
-    const Uint32             width           = 1;
-    const Uint32             height          = 1;
-    const Uint8              whitePixel[4]   = {255, 255, 255, 255}; // RGBA: White with full opacity
-    std::shared_ptr<Texture> whiteTextureObj = Texture::CreateFromBuffer(
+    const Uint32 width         = 1;
+    const Uint32 height        = 1;
+    const Uint8  whitePixel[4] = {255, 255, 255, 255}; // RGBA: White with full opacity
+    whiteTexture               = Texture::CreateFromBuffer(
         whitePixel,
         width,
         height,
         ETextureFormat::R8G8B8A8_UNORM,
         "White Texture ⬜",
         commandBuffer);
-    whiteTexture = whiteTextureObj ? whiteTextureObj->GetSDLTexture() : nullptr;
 
 
     int windowWidth, windowHeight;
-    SDL_GetWindowSize(render->window, &windowWidth, &windowHeight);
+    SDL_GetWindowSize(device->getNativeWindowPtr<SDL_Window>(), &windowWidth, &windowHeight);
     NE_INFO("Initialized window size: {}x{}", windowWidth, windowHeight);
     camera.setPerspective(45.0f, (float)windowWidth / (float)windowHeight, 0.1f, 100.0f);
     camera.setPosition({0.0f, 0.0f, 5.0f});
-    // Set up the init buffer with the camera data
-    // commandBuffer->setVertexUniforms(0, &cameraData, sizeof(CameraData));
-    // commandBuffer->setFragmentUniforms(0, &cameraData, sizeof(CameraData));
-    // commandBuffer->setFragmentUniforms(1, &fragmentUniforms, sizeof(FragmentConstUniforms));
     commandBuffer->submit();
 }
 #endif
@@ -194,6 +214,25 @@ SDL_AppResult AppInit(void **appstate, int argc, char *argv[])
     FileSystem::init();
     Logger::init();
     AssetManager::init();
+
+#if NE_WITH_SHADER_COMPILER
+    ShaderBuildService::init();
+
+    // kick off every shader we need now, they compile concurrently while the device/window is created.
+    // The pipelines requested below are queued as each of their shaders finishes, in no fixed order
+    ShaderBuildService::get()->requestAll({
+#if ENABLE_RENDER_3D
+        {.shaderName = "Basic.glsl", .defines = {"LIT", "TEXTURED", "DRAW_DATA"}},
+#endif
+#if ENABLE_RENDER_2D
+        {.shaderName = "Sprite2D.glsl"},
+#endif
+    });
+#else
+    // no compiler linked, everything comes from the pack written by neon-shadercook
+    ShaderLibrary::init();
+#endif
+
     device->init(SDL::SDLDevice::InitParams{
         .bVsync = true,
     });
@@ -205,13 +244,17 @@ SDL_AppResult AppInit(void **appstate, int argc, char *argv[])
     EGraphicPipeLinePrimitiveType primitiveType = EGraphicPipeLinePrimitiveType::TriangleList;
 
 #if ENABLE_RENDER_3D
-    bool ok = render3d->init(device->device,
-                             device->window,
+    // the vertex layout is SDLRender3D::MeshVertexLayout
+    bool ok = render3d->init(device->getNativeDevicePtr<SDL_GPUDevice>(),
+                             device->getNativeWindowPtr<SDL_Window>(),
+                             *device->pipelineCache,
                              GraphicsPipelineCreateInfo{
                                  .shaderCreateInfo = {
                                      .shaderName = "Basic.glsl",
+                                     .defines    = {"LIT", "TEXTURED", "DRAW_DATA"},
                                  },
-                                 .primitiveType = primitiveType,
+                                 .primitiveType  = primitiveType,
+                                 .uniformLayouts = {FragmentConstUniformsLayout.info()},
                              });
     if (!ok) {
         NE_CORE_ERROR("Failed to initialize render context");
@@ -222,7 +265,12 @@ SDL_AppResult AppInit(void **appstate, int argc, char *argv[])
 
 
 #if ENABLE_RENDER_2D
-    render2d->init(device->getNativeDevicePtr<SDL_GPUDevice>(), device->getNativeWindowPtr<SDL_Window>());
+    render2d->init(device->getNativeDevicePtr<SDL_GPUDevice>(), *device->pipelineCache);
+#endif
+
+#if ENABLE_SHADER_HOT_RELOAD
+    shaderHotReload.watch(device->pipelineCache.get());
+    shaderHotReload.start();
 #endif
 
 #if ENABLE_IMGUI
@@ -235,48 +283,6 @@ SDL_AppResult AppInit(void **appstate, int argc, char *argv[])
 #pragma endregion
 
 
-// Function to upload model data to GPU
-// bool uploadModelToGPU(std::shared_ptr<Model> model, std::shared_ptr<CommandBuffer> commandBuffer)
-// {
-//     if (!model || model->getMeshes().empty()) {
-//         return false;
-//     }
-
-//     // Convert Vertex to VertexEntry
-//     std::vector<VertexEntry> vertexEntries;
-//     std::vector<uint32_t>    indexEntries;
-//     vertexEntries.reserve(model->getMeshes()[0].vertices.size());
-//     indexEntries.reserve(model->getMeshes()[0].indices.size()); // Assuming each mesh has a triangle list
-
-//     for (auto &mesh : model->getMeshes()) {
-//         NE_CORE_INFO("Mesh name: {}", mesh.name);
-
-
-//         for (const auto &vertex : mesh.vertices) {
-//             VertexEntry entry;
-//             entry.position = glm::vec4(vertex.position, 1.0f);
-//             entry.color    = vertex.color;
-//             entry.uv       = vertex.texCoord;
-//             entry.normal   = vertex.normal; // Assuming normal is part of the Vertex struct
-//             vertexEntries.push_back(entry);
-//         }
-
-//         indexEntries.insert(
-//             indexEntries.end(),
-//             mesh.indices.begin(),
-//             mesh.indices.end());
-//     }
-//     // Upload vertices and indices using the command buffer directly
-//     commandBuffer->uploadBuffers(
-//         vertexEntries.data(),
-//         static_cast<Uint32>(vertexEntries.size() * sizeof(VertexEntry)),
-//         indexEntries.data(),
-//         static_cast<Uint32>(indexEntries.size() * sizeof(uint32_t)));
-
-
-//     return true;
-// }
-
 #pragma region ImGui Controls
 // using cmbf_t = std::shared_ptr<CommandBuffer>;
 using cmbf_t = SDL_GPUCommandBuffer *;
@@ -392,112 +398,116 @@ bool imcEditorCamera(cmbf_t commandBuffer)
 }
 
 
-// void imcModel(cmbf_t commandBuffer)
-// {
-//     if (!ImGui::CollapsingHeader("Model Controls")) {
-//         return;
-//     }
+#if ENABLE_RENDER_3D
+void imcModel()
+{
+    if (!ImGui::CollapsingHeader("Model Controls")) {
+        return;
+    }
 
-//     // TODO: why copilot think this is wrong? must a char[256] with '\0' at the end?
-//     static std::string modelPath(256, '\0');
-//     ImGui::InputText("Model Path", modelPath.data(), modelPath.size());
+    // TODO: why copilot think this is wrong? must a char[256] with '\0' at the end?
+    static std::string modelPath(256, '\0');
+    ImGui::InputText("Model Path", modelPath.data(), modelPath.size());
 
-//     if (ImGui::Button("Browse..."))
-//     {
-//         // Create dialog window if it doesn't exist yet
-//         if (!dialogWindow) {
-//             dialogWindow = NeonEngine::DialogWindow::create();
-//         }
-
-//         if (dialogWindow) {
-//             // Define file filters for 3D models
-//             std::vector<std::pair<std::string, std::string>> filters = {
-//                 {"3D Models", "*.obj;*.fbx;*.gltf;*.glb"},
-//                 {"Wavefront OBJ", "*.obj"},
-//                 {"Autodesk FBX", "*.fbx"},
-//                 {"GLTF", "*.gltf;*.glb"},
-//                 {"All Files", "*.*"}};
-
-//             auto result = dialogWindow->showDialog(
-//                 NeonEngine::DialogType::OpenFile,
-//                 "Select 3D Model",
-//                 filters);
-
-//             if (result.has_value()) {
-//                 // Copy the path to the input field, ensuring it doesn't overflow
-//                 modelPath = result.value();
-//                 modelPath.push_back('\0'); // Null-terminate the string
-//                 NE_CORE_INFO("Selected model file: {}", modelPath);
-//             }
-//         }
-//     }
+    if (ImGui::Button("Browse..."))
+    {
+        // Create dialog window if it doesn't exist yet
+        if (!dialogWindow) {
+            dialogWindow = NeonEngine::DialogWindow::create();
+        }
 
-//     if (ImGui::Button("Load Model")) {
-//         std::shared_ptr<Model> model = assetManager.loadModel(modelPath, commandBuffer);
-
-//         if (model) {
-//             currentModel = model;
-//             useModel     = true;
-
-//             // Upload model data
-//             if (uploadModelToGPU(model, commandBuffer)) {
-//                 NE_CORE_INFO("Model loaded and uploaded successfully");
-//             }
-//             else {
-//                 NE_CORE_ERROR("Failed to upload model data");
-//             }
-//         }
-//     }
+        if (dialogWindow) {
+            // Define file filters for 3D models
+            std::vector<std::pair<std::string, std::string>> filters = {
+                {"3D Models", "*.obj;*.fbx;*.gltf;*.glb"},
+                {"Wavefront OBJ", "*.obj"},
+                {"Autodesk FBX", "*.fbx"},
+                {"GLTF", "*.gltf;*.glb"},
+                {"All Files", "*.*"}};
+
+            auto result = dialogWindow->showDialog(
+                NeonEngine::DialogType::OpenFile,
+                "Select 3D Model",
+                filters);
+
+            if (result.has_value()) {
+                // Copy the path to the input field, ensuring it doesn't overflow
+                modelPath = result.value();
+                modelPath.push_back('\0'); // Null-terminate the string
+                NE_CORE_INFO("Selected model file: {}", modelPath);
+            }
+        }
+    }
 
-//     ImGui::SameLine();
+    // 20 instead of 48 bytes per vertex, drawn with the PACKED_VERTEX variant of Basic.glsl.
+    // Only for the models imported afterwards, the cached ones keep how they were loaded
+    static bool bPackVertices = false;
+    if (ImGui::Checkbox("Pack Vertices", &bPackVertices)) {
+        AssetManager::get()->setPackVertices(bPackVertices);
+    }
 
-//     if (ImGui::Button("Use Quad")) {
-//         useModel = false;
-//         commandBuffer->uploadBuffers(
-//             vertices.data(),
-//             static_cast<Uint32>(vertices.size() * sizeof(VertexEntry)),
-//             indices.data(),
-//             static_cast<Uint32>(indices.size() * sizeof(IndexEntry)));
-//     }
+    if (ImGui::Button("Load Model")) {
+        // loaded on the asset workers, the callback runs on the main thread in AssetManager::pumpCompletions,
+        // before the frame's command buffer is acquired
+        AssetManager::get()->loadModelAsync(modelPath.c_str(), [](const std::shared_ptr<Model> &model) {
+            if (!model) {
+                return;
+            }
+            auto commandBuffer = device->acquireCommandBuffer();
+            bool bUploaded     = render3d->uploadModel(commandBuffer->getNativeCommandBufferPtr<SDL_GPUCommandBuffer>(), model, currentModel);
+            commandBuffer->submit();
+            if (!bUploaded) {
+                NE_CORE_ERROR("Failed to upload model data");
+                return;
+            }
+            useModel = true;
+            NE_CORE_INFO("Model loaded and uploaded successfully, {} meshes", model->getMeshes().size());
+        });
+    }
 
-//     // Model transform controls
-//     if (useModel && currentModel) {
-//         ImGui::Separator();
-//         ImGui::Text("Model Transform");
+    ImGui::SameLine();
 
-//         static glm::vec3 position = {0.0f, 0.0f, 0.0f};
-//         static glm::vec3 rotation = {0.0f, 0.0f, 0.0f};
-//         static glm::vec3 scale    = {1.0f, 1.0f, 1.0f};
+    if (ImGui::Button("Use Quad")) {
+        useModel = false;
+    }
 
-//         bool transformChanged = false;
+    // Model transform controls
+    if (useModel && currentModel.model) {
+        ImGui::Separator();
+        ImGui::Text("Model Transform");
 
-//         if (ImGui::DragFloat3("Position", glm::value_ptr(position), 0.01f)) {
-//             transformChanged = true;
-//         }
+        static glm::vec3 position = {0.0f, 0.0f, 0.0f};
+        static glm::vec3 rotation = {0.0f, 0.0f, 0.0f};
+        static glm::vec3 scale    = {1.0f, 1.0f, 1.0f};
 
-//         if (ImGui::DragFloat3("Rotation", glm::value_ptr(rotation), 1.0f)) {
-//             transformChanged = true;
-//         }
+        bool transformChanged = false;
 
-//         if (ImGui::DragFloat3("Scale", glm::value_ptr(scale), 0.01f, 0.01f, 10.0f)) {
-//             transformChanged = true;
-//         }
+        if (ImGui::DragFloat3("Position", glm::value_ptr(position), 0.01f)) {
+            transformChanged = true;
+        }
 
-//         if (transformChanged) {
-//             glm::mat4 transform = glm::mat4(1.0f);
-//             transform           = glm::translate(transform, position);
-//             transform           = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-//             transform           = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-//             transform           = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-//             transform           = glm::scale(transform, scale);
+        if (ImGui::DragFloat3("Rotation", glm::value_ptr(rotation), 1.0f)) {
+            transformChanged = true;
+        }
 
-//             currentModel->setTransform(transform);
+        if (ImGui::DragFloat3("Scale", glm::value_ptr(scale), 0.01f, 0.01f, 10.0f)) {
+            transformChanged = true;
+        }
 
-//             cameraData.model = transform;
-//             commandBuffer->setVertexUniforms(0, &cameraData, sizeof(CameraData));
-//         }
-//     }
-// }
+        if (transformChanged) {
+            glm::mat4 transform = glm::mat4(1.0f);
+            transform           = glm::translate(transform, position);
+            transform           = glm::rotate(transform, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+            transform           = glm::rotate(transform, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+            transform           = glm::rotate(transform, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+            transform           = glm::scale(transform, scale);
+
+            // read by the DrawData pushed each frame
+            currentModel.model->setTransform(transform);
+        }
+    }
+}
+#endif
 
 
 #pragma endregion
@@ -540,6 +550,15 @@ SDL_AppResult AppIterate(void *appState)
         task();
     }
 
+    // GPU uploads of the models loaded in the background
+    AssetManager::get()->pumpCompletions();
+
+    // make the pipelines built in the background live, then swap in the hot reloaded ones
+    device->pipelineCache->tick();
+#if ENABLE_SHADER_HOT_RELOAD
+    shaderHotReload.tick();
+#endif
+
 #pragma endregion
 
 #pragma region Render
@@ -614,7 +633,9 @@ SDL_AppResult AppIterate(void *appState)
         bCameraChanged      = imcEditorCamera(sdlCommandBuffer);
 
 
-        // imcModel(commandBuffer);
+#if ENABLE_RENDER_3D
+        imcModel();
+#endif
         // imcSwapChain(sdlCommandBuffer);
         imcLight(sdlCommandBuffer);
     }
@@ -654,15 +675,14 @@ SDL_AppResult AppIterate(void *appState)
     if (bVertexInputChanged) {
         // TODO: move to render pipeline
         NE_CORE_INFO("Vertex input changed, update vertex buffer");
-        std::vector<VertexEntry> verticesCopy = vertices;
-        for (auto &vertex : verticesCopy) {
-            vertex.position = quadTransform * glm::vec4(vertex.position, 1.0f);
-        }
-
-        commandBuffer->uploadVertexBuffers(
-            verticesCopy.data(),
-            static_cast<Uint32>(verticesCopy.size() * sizeof(VertexEntry)));
+        uploadQuad(sdlCommandBuffer);
     }
+
+    // one DrawData per mesh, the LOD of each mesh at its projected size, at full detail only its clusters surviving the culling
+    SDL::SDLRender3D::GPUModel &drawnModel = useModel && currentModel.model ? currentModel : quadModel;
+    render3d->beginFrame(camera);
+    render3d->prepareModel(drawnModel, camera, static_cast<float>(windowHeight));
+    render3d->upload(sdlCommandBuffer);
 #endif
 
 
@@ -695,38 +715,18 @@ SDL_AppResult AppIterate(void *appState)
         SDL_SetGPUViewport(renderpass, &viewport);
 
 #if ENABLE_RENDER_3D
-        render->draw();
-        render->draw....SDL_BindGPUGraphicsPipeline(renderpass, render->pipeline);
-
-
-#endif
+        // nothing to draw with until the pipeline is built in the background
+        if (whiteTexture && render3d->bind(renderpass, sdlCommandBuffer)) {
+            SDL_PushGPUFragmentUniformData(sdlCommandBuffer, 1, &fragmentUniforms, sizeof(FragmentConstUniforms));
 
+            SDL_GPUTextureSamplerBinding textureBinding = {
+                .texture = static_cast<SDL_GPUTexture *>(whiteTexture->GetNativeHandle()),
+                .sampler = device->samplers[selectedSampler],
+            };
+            SDL_BindGPUFragmentSamplers(renderpass, 0, &textureBinding, 1);
 
-
-#if ENABLE_RENDER_3D
-
-        // Draw the model or quad
-        if (useModel && currentModel && !currentModel->getMeshes().empty()) {
-            // Draw the model
-            const auto &firstMesh = currentModel->getMeshes()[0];
-            SDL_DrawGPUIndexedPrimitives(renderpass,
-                                         static_cast<uint32_t>(firstMesh.indices.size()),
-                                         1,
-                                         0,
-                                         0,
-                                         0);
+            render3d->drawModel(renderpass, sdlCommandBuffer, drawnModel);
         }
-        else {
-            // Draw the quad
-            SDL_DrawGPUIndexedPrimitives(renderpass,
-                                         2 * 3, // 3 index for each triangle
-                                         1,
-                                         0,
-                                         0,
-                                         0);
-        }
-
-        // after graphics pipeline draw, or make pipeline draw into a RT
 #endif
 #if ENABLE_RENDER_2D
         render2d->draw(renderpass);
@@ -815,13 +815,15 @@ void AppQuit(void *appstate, SDL_AppResult result)
 
     SDL_WaitForGPUIdle(sdlDevice);
 
+#if ENABLE_SHADER_HOT_RELOAD
+    shaderHotReload.stop();
+#endif
 
-    if (faceTexture) {
-        SDL_ReleaseGPUTexture(sdlDevice, faceTexture);
-    }
-    if (whiteTexture) {
-        SDL_ReleaseGPUTexture(sdlDevice, whiteTexture);
-    }
+#if ENABLE_RENDER_3D
+    whiteTexture.reset();
+    quadModel    = {};
+    currentModel = {};
+#endif
 
 #if ENABLE_IMGUI
     imguiState.shutdown();
@@ -837,11 +839,14 @@ void AppQuit(void *appstate, SDL_AppResult result)
 #endif
 
 #if ENABLE_RENDER_3D
-    render->clean(); // now device owning by render
-// delete render;
+    render3d->clean();
+    // delete render3d;
 #endif
 
+    AssetManager::shutdown();
     device->clean();
+    ShaderBuildService::shutdown();
+    ShaderLibrary::shutdown();
 
     auto sdlAppState = static_cast<SDLAppState *>(appstate);
     delete sdlAppState;
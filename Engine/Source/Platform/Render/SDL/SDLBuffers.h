@@ -21,6 +21,8 @@ class SDLGPUBuffer
     {
         VertexBuffer,
         IndexBuffer,
+        StorageBuffer,  // read by the vertex/fragment shaders
+        IndirectBuffer, // draw arguments, see SDLIndirectDrawList
         // Add other usages as needed
     };
 
@@ -105,6 +107,12 @@ class SDLGPUBuffer
         case Usage::IndexBuffer:
             sdlBCI.usage = SDL_GPU_BUFFERUSAGE_INDEX;
             break;
+        case Usage::StorageBuffer:
+            sdlBCI.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+            break;
+        case Usage::IndirectBuffer:
+            sdlBCI.usage = SDL_GPU_BUFFERUSAGE_INDIRECT;
+            break;
         default:
             NE_CORE_ASSERT(false, "Invalid buffer usage");
             return;
@@ -112,8 +120,9 @@ class SDLGPUBuffer
 
         _gpuBuffer = SDL_CreateGPUBuffer(&_device, &sdlBCI);
         NE_CORE_ASSERT(_gpuBuffer, "Failed to create buffer: {}", SDL_GetError());
-        _size = size;
-        _name = name;
+        _size  = size;
+        _name  = name;
+        _usage = usage; // tryExtendSize recreates with it
 
         SDL_SetGPUBufferName(&_device, _gpuBuffer, name.c_str());
     }
@@ -216,8 +225,9 @@ class SDLGPUTransferBuffer
 
         _gpuBuffer = SDL_CreateGPUTransferBuffer(&_device, &createInfo);
         NE_CORE_ASSERT(_gpuBuffer, "Failed to create transfer buffer: {}", SDL_GetError());
-        _size = size;
-        _name = name;
+        _size  = size;
+        _name  = name;
+        _usage = usage;
 
         // Note: No name setting for transfer buffer as it's not supported in the SDK
     }
@@ -1,11 +1,15 @@
 #include "SDLDevice.h"
 
 #include "SDLGPUCommandBuffer.h"
+#include "SDLPipelineCache.h"
 
 
 namespace SDL
 {
 
+SDLDevice::SDLDevice()  = default;
+SDLDevice::~SDLDevice() = default;
+
 // create device and window. TODO: Multiple window manager
 bool SDLDevice::init(const InitParams &params)
 {
@@ -50,9 +54,24 @@ bool SDLDevice::init(const InitParams &params)
                                   window,
                                   SDL_GPU_SWAPCHAINCOMPOSITION_SDR,
                                   params.bVsync ? SDL_GPU_PRESENTMODE_VSYNC : SDL_GPU_PRESENTMODE_IMMEDIATE);
+
+    pipelineCache = std::make_unique<SDLPipelineCache>(device, window);
     return true;
 }
 
+void SDLDevice::clean()
+{
+    auto sdlDevice = getNativeDevicePtr<SDL_GPUDevice>();
+    auto sdlWindow = getNativeWindowPtr<SDL_Window>();
+
+    // the renderers should have dropped their handles by now, only the slots are left
+    pipelineCache.reset();
+
+    SDL_ReleaseWindowFromGPUDevice(sdlDevice, sdlWindow);
+    SDL_DestroyWindow(sdlWindow);
+    SDL_DestroyGPUDevice(sdlDevice);
+}
+
 void SDLDevice::createSamplers()
 {
     auto sdlDevice = getNativeDevicePtr<SDL_GPUDevice>();
@@ -67,8 +86,8 @@ void SDLDevice::createSamplers()
         .address_mode_w    = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
         .mip_lod_bias      = 0.0,
         .compare_op        = SDL_GPU_COMPAREOP_ALWAYS,
-        .min_lod           = 1.0,
-        .max_lod           = 1.0,
+        .min_lod           = 0.0,
+        .max_lod           = 1000.0, // every mip level
         .enable_anisotropy = false,
         .enable_compare    = false,
     };
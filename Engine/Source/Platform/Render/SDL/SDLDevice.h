@@ -17,24 +17,21 @@ namespace SDL
 
 
 class SDLBufferManager;
+class SDLPipelineCache;
 
 struct SDLDevice : LogicalDevice
 {
     std::unordered_map<ESamplerType, SDL_GPUSampler *> samplers;
+    std::unique_ptr<SDLPipelineCache>                  pipelineCache; // created in init()
 
+    SDLDevice();
+    ~SDLDevice();
 
     bool init(const InitParams &params) override;
 
     void createSamplers();
 
-    void clean()
-    {
-        auto sdlDevice = getNativeDevicePtr<SDL_GPUDevice>();
-        auto sdlWindow = getNativeWindowPtr<SDL_Window>();
-        SDL_ReleaseWindowFromGPUDevice(sdlDevice, sdlWindow);
-        SDL_DestroyWindow(sdlWindow);
-        SDL_DestroyGPUDevice(sdlDevice);
-    }
+    void clean();
 
     std::shared_ptr<CommandBuffer> acquireCommandBuffer(std::source_location location = std::source_location::current());
 };
@@ -27,29 +27,42 @@ void SDLRender2D::fillQuadIndicesToGPUBuffer(SDLGPUBufferPtr indexBuffer, std::s
     }
 
     // Map the transfer buffer
-    Uint32 *indicesPtr = (Uint32 *)SDL_MapGPUTransferBuffer(device, indexTransferBufferPtr->getBuffer(), true);
+    void *mapped = SDL_MapGPUTransferBuffer(device, indexTransferBufferPtr->getBuffer(), true);
 
-    if (pipeline.pipelineCreateInfo.frontFaceType == EFrontFaceType::ClockWise) {
-        for (uint32_t i = 0; i < indicesSize / 6; i++) {
-            indicesPtr[i * 6 + 0] = i * 4 + 0; // left top
-            indicesPtr[i * 6 + 1] = i * 4 + 1; // right top
-            indicesPtr[i * 6 + 2] = i * 4 + 3; // right bottom
+    auto fillIndices = [this, indicesSize]<typename T>(T *indicesPtr) {
+        if (frontFaceType == EFrontFaceType::ClockWise) {
+            for (uint32_t i = 0; i < indicesSize / 6; i++) {
+                indicesPtr[i * 6 + 0] = static_cast<T>(i * 4 + 0); // left top
+                indicesPtr[i * 6 + 1] = static_cast<T>(i * 4 + 1); // right top
+                indicesPtr[i * 6 + 2] = static_cast<T>(i * 4 + 3); // right bottom
 
-            indicesPtr[i * 6 + 3] = i * 4 + 0; // left top
-            indicesPtr[i * 6 + 4] = i * 4 + 3; // right bottom
-            indicesPtr[i * 6 + 5] = i * 4 + 2; // left bottom
+                indicesPtr[i * 6 + 3] = static_cast<T>(i * 4 + 0); // left top
+                indicesPtr[i * 6 + 4] = static_cast<T>(i * 4 + 3); // right bottom
+                indicesPtr[i * 6 + 5] = static_cast<T>(i * 4 + 2); // left bottom
+            }
         }
-    }
-    else {
-        for (uint32_t i = 0; i < indicesSize / 6; i++) {
-            indicesPtr[i * 6 + 0] = i * 4 + 0; // left top
-            indicesPtr[i * 6 + 1] = i * 4 + 3; // right bottom
-            indicesPtr[i * 6 + 2] = i * 4 + 1; // right top
+        else {
+            for (uint32_t i = 0; i < indicesSize / 6; i++) {
+                indicesPtr[i * 6 + 0] = static_cast<T>(i * 4 + 0); // left top
+                indicesPtr[i * 6 + 1] = static_cast<T>(i * 4 + 3); // right bottom
+                indicesPtr[i * 6 + 2] = static_cast<T>(i * 4 + 1); // right top
 
-            indicesPtr[i * 6 + 3] = i * 4 + 0; // left top
-            indicesPtr[i * 6 + 4] = i * 4 + 2; // left bottom
-            indicesPtr[i * 6 + 5] = i * 4 + 3; // right bottom
+                indicesPtr[i * 6 + 3] = static_cast<T>(i * 4 + 0); // left top
+                indicesPtr[i * 6 + 4] = static_cast<T>(i * 4 + 2); // left bottom
+                indicesPtr[i * 6 + 5] = static_cast<T>(i * 4 + 3); // right bottom
+            }
         }
+    };
+
+    // 16 bit halves the buffer and the index fetch, only valid while i * 4 + 3 fits
+    if (indicesSize * sizeof(Uint16) == bufferSize) {
+        NE_CORE_ASSERT(quadIndexSize(indicesSize) == sizeof(Uint16), "{0} quad indices do not fit in 16 bits", indicesSize);
+        fillIndices(static_cast<Uint16 *>(mapped));
+        indexElementSize = SDL_GPU_INDEXELEMENTSIZE_16BIT;
+    }
+    else {
+        fillIndices(static_cast<Uint32 *>(mapped));
+        indexElementSize = SDL_GPU_INDEXELEMENTSIZE_32BIT;
     }
 
     SDL_UnmapGPUTransferBuffer(device, indexTransferBufferPtr->getBuffer());
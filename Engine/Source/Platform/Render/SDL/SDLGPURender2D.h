@@ -10,7 +10,9 @@
 
 #include "Core/Camera.h"
 #include "SDLBuffers.h"
-#include "SDLGraphicsPipeline.h"
+#include "Render/UniformLayout.h"
+#include "Render/VertexLayout.h"
+#include "SDLPipelineCache.h"
 #include "glm/ext/matrix_transform.hpp"
 
 
@@ -26,9 +28,13 @@ struct SDLRender2D
         glm::vec3 position;
         glm::vec4 color;
     };
+    static constexpr auto VertexInputLayout = makeVertexLayout<VertexInput>(
+        NE_VERTEX_ATTRIBUTE(VertexInput, position),
+        NE_VERTEX_ATTRIBUTE(VertexInput, color));
 
-    SDL_GPUDevice      *device = nullptr;
-    SDLGraphicsPipeLine pipeline;
+    SDL_GPUDevice    *device = nullptr;
+    SDLPipelineHandle pipeline; // built in the background, the sprites are skipped until it is live
+    EFrontFaceType::T frontFaceType = EFrontFaceType::CounterClockWise; // of the pipeline, the quad indices wind to match
 
     std::vector<VertexInput> vertexInputBuffer;
     std::vector<Uint32>      indexInputBuffer;
@@ -39,6 +45,8 @@ struct SDLRender2D
     SDLGPUBufferPtr         vertexBufferPtr         = nullptr;
     SDLGPUBufferPtr         indexBufferPtr          = nullptr;
     SDLGPUTransferBufferPtr vertexTransferBufferPtr = nullptr;
+    // 16 bit while the quad indices fit, see fillQuadIndicesToGPUBuffer
+    SDL_GPUIndexElementSize indexElementSize        = SDL_GPU_INDEXELEMENTSIZE_16BIT;
 
     std::vector<std::shared_ptr<Texture>> textures;
     std::shared_ptr<Texture>              whiteTexture;
@@ -53,46 +61,28 @@ struct SDLRender2D
 
     struct CameraData
     {
-        glm::mat4 viewProjectionMatrix;
+        glm::mat4 viewProjection;
     } cameraData;
+    static constexpr auto CameraDataLayout = makeUniformLayout<CameraData>("uCamera", NE_UNIFORM_MEMBER(CameraData, viewProjection));
 
 
     SDL_GPUCommandBuffer *currentCommandBuffer = nullptr;
 
-    void init(SDL_GPUDevice *device, SDL_Window *window)
+    void init(SDL_GPUDevice *device, SDLPipelineCache &pipelineCache)
     {
         this->device = device;
 
-        pipeline.create(
-            device,
-            window,
+        pipeline = pipelineCache.requestPipeline(
             GraphicsPipelineCreateInfo{
                 .bDeriveInfoFromShader = false,
                 .shaderCreateInfo      = ShaderCreateInfo{
                          .shaderName = "Sprite2D.glsl",
                 },
-                .vertexBufferDescs = {
-                    VertexBufferDescription{
-                        .slot  = 0,
-                        .pitch = sizeof(VertexInput),
-                    },
-                },
-                .vertexAttributes = {
-                    VertexAttribute{
-                        .location   = 0,
-                        .bufferSlot = 0,
-                        .format     = EVertexAttributeFormat::Float2,
-                        .offset     = offsetof(VertexInput, position),
-                    },
-                    VertexAttribute{
-                        .location   = 1,
-                        .bufferSlot = 0,
-                        .format     = EVertexAttributeFormat::Float4,
-                        .offset     = offsetof(VertexInput, color),
-                    },
-                },
-                .primitiveType = EGraphicPipeLinePrimitiveType::TriangleList,
-                .frontFaceType = EFrontFaceType::CounterClockWise,
+                .vertexBufferDescs = {VertexInputLayout.bufferDescription()},
+                .vertexAttributes  = VertexInputLayout.attributeList(),
+                .primitiveType  = EGraphicPipeLinePrimitiveType::TriangleList,
+                .frontFaceType  = frontFaceType,
+                .uniformLayouts = {CameraDataLayout.info()},
             });
 
 
@@ -100,7 +90,7 @@ struct SDLRender2D
         std::size_t initialIndexCount  = 1024 * 6; // 6 indices per quad
 
         std::size_t initialVertexBufferSize = initialVertexCount * sizeof(VertexInput);
-        std::size_t initialIndexBufferSize  = initialIndexCount * sizeof(uint32_t);
+        std::size_t initialIndexBufferSize  = initialIndexCount * quadIndexSize(initialIndexCount);
 
         // Create initial buffers with default sizes using the new classes
         vertexBufferPtr = SDLGPUBuffer::Create(device, "Render2D VertexBuffer", SDLGPUBuffer::Usage::VertexBuffer, initialVertexBufferSize);
@@ -123,13 +113,13 @@ struct SDLRender2D
         vertexTransferBufferPtr.reset();
 
         textures.clear();
-        pipeline.clean();
+        pipeline = {};
     }
 
     void beginFrame(SDL_GPUCommandBuffer *commandBuffer, const Camera &camera)
     {
         currentCommandBuffer            = commandBuffer;
-        cameraData.viewProjectionMatrix = camera.getViewProjectionMatrix();
+        cameraData.viewProjection       = camera.getViewProjectionMatrix();
 
         vertexInputBuffer.resize(0);
         indexInputBuffer.resize(0);
@@ -148,7 +138,7 @@ struct SDLRender2D
         std::size_t curIndexInputBufferCapacity = indexInputBuffer.capacity();
         if (lastMaxIndexCapacity < curIndexInputBufferCapacity) // this vector has been extended
         {
-            static constexpr std::size_t elemSize = sizeof(indexInputBuffer[0]);
+            std::size_t elemSize = quadIndexSize(curIndexInputBufferCapacity);
             // extend gpu buffer
             indexBufferPtr->tryExtendSize(elemSize * curIndexInputBufferCapacity);
 
@@ -186,8 +176,11 @@ struct SDLRender2D
 
     void draw(SDL_GPURenderPass *renderpass)
     {
-
-        SDL_BindGPUGraphicsPipeline(renderpass, pipeline.pipeline);
+        SDLGraphicsPipeLine *currentPipeline = pipeline.resolve();
+        if (!currentPipeline) {
+            return;
+        }
+        SDL_BindGPUGraphicsPipeline(renderpass, currentPipeline->pipeline);
 
         // set the camera data in current pipeline(shader)
         SDL_PushGPUVertexUniformData(
@@ -206,7 +199,7 @@ struct SDLRender2D
             .buffer = indexBufferPtr->getBuffer(),
             .offset = 0,
         };
-        SDL_BindGPUIndexBuffer(renderpass, &indexBufferBinding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+        SDL_BindGPUIndexBuffer(renderpass, &indexBufferBinding, indexElementSize);
 
         SDL_DrawGPUIndexedPrimitives(
             renderpass,
@@ -239,6 +232,13 @@ struct SDLRender2D
     }
 
 
+    // bytes per index for `indicesSize` quad indices, 2 while the last vertex index fits in 16 bits
+    static std::size_t quadIndexSize(std::size_t indicesSize)
+    {
+        return indicesSize / 6 * 4 <= std::size_t(UINT16_MAX) + 1 ? sizeof(Uint16) : sizeof(Uint32);
+    }
+
+    // the index element size follows bufferSize: indicesSize * 2 or indicesSize * 4 bytes
     void fillQuadIndicesToGPUBuffer(SDLGPUBufferPtr indexBuffer, std::size_t indicesSize, std::size_t bufferSize);
 };
 
@@ -1,11 +1,15 @@
 #include "SDLGPURender3D.h"
 
+#include <cstring>
+
 
 
 #include "SDL3/SDL.h"
 #include "SDL3/SDL_gpu.h"
 
 
+#include "Core/EditorCamera.h"
+#include "Render/MeshLodSelection.h"
 #include "Render/Shader.h"
 
 namespace SDL
@@ -15,7 +19,147 @@ namespace SDL
 
 void SDLRender3D::clean()
 {
-    _pipeline.clean();
+    pipeline       = {};
+    packedPipeline = {};
+    drawDataRing.clean();
+    meshDrawList.clean();
+}
+
+bool SDLRender3D::uploadModel(SDL_GPUCommandBuffer *commandBuffer, const std::shared_ptr<Model> &model, GPUModel &out)
+{
+    out       = {};
+    out.model = model;
+    if (!model) {
+        return false;
+    }
+
+    bool             bOk      = true;
+    SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+    for (const Mesh &mesh : model->getMeshes()) {
+        GPUMesh &gpuMesh = out.meshes.emplace_back();
+
+        // the PACKED_VERTEX stream is a copy of the float one, only one of them goes to the GPU
+        gpuMesh.bPacked = !mesh.getPackedVertices().empty();
+        auto vertices   = gpuMesh.bPacked ? std::as_bytes(mesh.getPackedVertices()) : std::as_bytes(mesh.getVertices());
+        auto indices    = mesh.getIndexBytes();
+        if (gpuMesh.bPacked) {
+            gpuMesh.quantization = mesh.packed.quantization;
+        }
+        if (vertices.empty() || indices.empty()) {
+            continue;
+        }
+
+        // released right away, SDL keeps it until the copy has run
+        auto  transferBuffer = SDLGPUTransferBuffer::Create(device, mesh.name + " Upload", SDLGPUTransferBuffer::Usage::Upload, vertices.size() + indices.size());
+        auto *mapped         = static_cast<std::byte *>(SDL_MapGPUTransferBuffer(device, transferBuffer->getBuffer(), false));
+        if (!mapped) {
+            NE_CORE_ERROR("Render3D: failed to map the upload of mesh {}: {}", mesh.name, SDL_GetError());
+            bOk = false;
+            continue;
+        }
+        std::memcpy(mapped, vertices.data(), vertices.size());
+        std::memcpy(mapped + vertices.size(), indices.data(), indices.size());
+        SDL_UnmapGPUTransferBuffer(device, transferBuffer->getBuffer());
+
+        gpuMesh.vertexBuffer     = SDLGPUBuffer::Create(device, mesh.name + " Vertices", SDLGPUBuffer::Usage::VertexBuffer, vertices.size());
+        gpuMesh.indexBuffer      = SDLGPUBuffer::Create(device, mesh.name + " Indices", SDLGPUBuffer::Usage::IndexBuffer, indices.size());
+        gpuMesh.indexElementSize = mesh.getIndexElementSize();
+        gpuMesh.indexCount       = static_cast<uint32_t>(mesh.getIndexCount());
+        if (!mesh.getMeshlets().empty()) {
+            gpuMesh.clusters.build(mesh.getMeshlets());
+        }
+
+        SDL_GPUTransferBufferLocation source = {
+            .transfer_buffer = transferBuffer->getBuffer(),
+            .offset          = 0,
+        };
+        SDL_GPUBufferRegion destination = {
+            .buffer = gpuMesh.vertexBuffer->getBuffer(),
+            .offset = 0,
+            .size   = static_cast<Uint32>(vertices.size()),
+        };
+        SDL_UploadToGPUBuffer(copyPass, &source, &destination, false);
+
+        source.offset      = static_cast<Uint32>(vertices.size());
+        destination.buffer = gpuMesh.indexBuffer->getBuffer();
+        destination.size   = static_cast<Uint32>(indices.size());
+        SDL_UploadToGPUBuffer(copyPass, &source, &destination, false);
+    }
+    SDL_EndGPUCopyPass(copyPass);
+    return bOk;
+}
+
+void SDLRender3D::prepareModel(GPUModel &gpuModel, const EditorCamera &camera, float viewportHeight)
+{
+    if (!gpuModel.model) {
+        return;
+    }
+    const auto     &meshes    = gpuModel.model->getMeshes();
+    const glm::mat4 transform = gpuModel.model->getTransform();
+
+    // the clusters of every mesh are in the model's object space, one view serves them all
+    const ClusterCulling::View view = ClusterCulling::makeView(camera.getViewProjectionMatrix(), transform, camera.position);
+
+    auto &commands = meshDrawList.getCommands();
+    for (std::size_t i = 0; i < gpuModel.meshes.size(); ++i) {
+        GPUMesh    &gpuMesh = gpuModel.meshes[i];
+        const Mesh &mesh    = meshes[i];
+        if (!gpuMesh.vertexBuffer) {
+            continue;
+        }
+
+        gpuMesh.drawIndex = pushDraw(transform);
+        gpuMesh.lod       = MeshLodSelection::selectLod(mesh, transform, camera, viewportHeight, gpuMesh.lod);
+        gpuMesh.bCulled   = gpuMesh.lod == 0 && gpuMesh.clusters.count > 0;
+        if (gpuMesh.bCulled) {
+            gpuMesh.firstCommand = static_cast<uint32_t>(commands.size());
+            ClusterCulling::cull(gpuMesh.clusters, view, commands);
+            gpuMesh.commandCount = static_cast<uint32_t>(commands.size()) - gpuMesh.firstCommand;
+        }
+    }
+}
+
+void SDLRender3D::drawModel(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer, const GPUModel &gpuModel)
+{
+    if (!gpuModel.model) {
+        return;
+    }
+    const auto &meshes = gpuModel.model->getMeshes();
+
+    for (std::size_t i = 0; i < gpuModel.meshes.size(); ++i) {
+        const GPUMesh &gpuMesh = gpuModel.meshes[i];
+        if (!gpuMesh.vertexBuffer) {
+            continue;
+        }
+
+        SDL_GPUBufferBinding vertexBufferBinding = {
+            .buffer = gpuMesh.vertexBuffer->getBuffer(),
+            .offset = 0,
+        };
+        // a packed mesh is skipped while its pipeline is building, like the whole model is before bind()
+        const bool bBound = gpuMesh.bPacked
+                              ? bindVariant(renderpass, commandBuffer, packedPipeline.resolve(), PACKED_DRAW_INDEX_SLOT)
+                              : bindVariant(renderpass, commandBuffer, pipeline.resolve(), DRAW_INDEX_SLOT);
+        if (!bBound) {
+            continue;
+        }
+        if (gpuMesh.bPacked) {
+            SDL_PushGPUVertexUniformData(commandBuffer, QUANTIZATION_SLOT, &gpuMesh.quantization, sizeof(gpuMesh.quantization));
+        }
+        SDL_BindGPUVertexBuffers(renderpass, 0, &vertexBufferBinding, 1);
+        bindIndexBuffer(renderpass, gpuMesh.indexBuffer->getBuffer(), gpuMesh.indexElementSize);
+
+        if (gpuMesh.bCulled) {
+            // every cluster of the mesh shares its DrawData
+            bindDraw(commandBuffer, gpuMesh.drawIndex);
+            meshDrawList.draw(renderpass, gpuMesh.firstCommand, gpuMesh.commandCount);
+        }
+        else {
+            const Mesh &mesh = meshes[i];
+            MeshLod     lod  = mesh.lods.empty() ? MeshLod{.firstIndex = 0, .indexCount = gpuMesh.indexCount} : mesh.lods[gpuMesh.lod];
+            drawIndexed(renderpass, commandBuffer, gpuMesh.drawIndex, lod.indexCount, lod.firstIndex);
+        }
+    }
 }
 
 
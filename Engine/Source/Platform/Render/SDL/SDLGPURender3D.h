@@ -2,6 +2,7 @@
 #include "Core/Camera.h"
 #include "Render/Render.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 
@@ -14,10 +15,20 @@
 #include <SDL3_image/SDL_image.h>
 
 
+#include "Render/ClusterCulling.h"
 #include "Render/CommandBuffer.h"
+#include "Render/Model.h"
 #include "Render/Shader.h"
+#include "Render/UniformLayout.h"
+#include "Render/VertexCompression.h"
+#include "Render/VertexLayout.h"
 
-#include "SDLGraphicsPipeline.h"
+#include "SDLBuffers.h"
+#include "SDLIndirectDrawList.h"
+#include "SDLPipelineCache.h"
+#include "SDLUniformRing.h"
+
+struct EditorCamera;
 
 namespace SDL
 {
@@ -35,45 +46,198 @@ struct SDLRender3D
         Count
     };
 
-    // Legacy support - points to the current active pipeline
-    SDLGraphicsPipeLine                                                    _pipeline;
+    // built in the background, the draws are skipped until it is live.
+    // `packedPipeline` is the PACKED_VERTEX variant, for the meshes uploaded with their PackedVertex stream
+    SDLPipelineHandle                                                      pipeline;
+    SDLPipelineHandle                                                      packedPipeline;
     std::unordered_map<EShaderStage::T, ShaderReflection::ShaderResources> cachedShaderResources;
 
 
 
+    // uCamera of the DRAW_DATA variants (Include/Camera.glsl), pushed once per frame, the model matrix is per draw
     struct CameraData
     {
-        glm::mat4 model;
         glm::mat4 view;
         glm::mat4 projection;
     };
+    static constexpr auto CameraDataLayout = makeUniformLayout<CameraData>("uCamera",
+                                                                           NE_UNIFORM_MEMBER(CameraData, view),
+                                                                           NE_UNIFORM_MEMBER(CameraData, projection));
 
     CameraData cameraData;
 
+    // Include/DrawData.glsl, std430. Pushed into `drawDataRing` once per draw, the shader then only needs
+    // the 4 byte draw index per draw
+    struct DrawData
+    {
+        glm::mat4 model;
+        glm::vec4 color;
+    };
+    static constexpr auto DrawDataLayout = makeStorageLayout<DrawData>("DrawData",
+                                                                       NE_UNIFORM_MEMBER(DrawData, model),
+                                                                       NE_UNIFORM_MEMBER(DrawData, color));
+    SDLUniformRing drawDataRing;
+
+    // Include/VertexCompression.glsl, pushed per packed mesh
+    static constexpr auto QuantizationLayout = makeUniformLayout<VertexCompression::QuantizationUniform>("uQuantization",
+                                                                                                         NE_UNIFORM_MEMBER(VertexCompression::QuantizationUniform, offset),
+                                                                                                         NE_UNIFORM_MEMBER(VertexCompression::QuantizationUniform, scale));
+
+    // vertex uniform slots of Basic.glsl: uCamera, then uDrawIndex.
+    // PACKED_VERTEX puts uQuantization before uDrawIndex (DRAW_INDEX_BINDING 2)
+    static constexpr uint32_t CAMERA_SLOT            = 0;
+    static constexpr uint32_t DRAW_INDEX_SLOT        = 1;
+    static constexpr uint32_t QUANTIZATION_SLOT      = 1;
+    static constexpr uint32_t PACKED_DRAW_INDEX_SLOT = 2;
+
+    // the variant bound last in the pass and where its uDrawIndex is
+    SDLGraphicsPipeLine *boundPipeline = nullptr;
+    uint32_t             drawIndexSlot = DRAW_INDEX_SLOT;
+
+    // the mesh clusters surviving ClusterCulling this frame, all meshes in one list
+    SDLIndirectDrawList meshDrawList;
+
+    // `Vertex` as the importer stores it, the locations follow Basic.glsl
+    static constexpr auto MeshVertexLayout = makeVertexLayout<Vertex>(
+        NE_VERTEX_ATTRIBUTE(Vertex, position),
+        NE_VERTEX_ATTRIBUTE(Vertex, color),
+        NE_VERTEX_ATTRIBUTE(Vertex, texCoord),
+        NE_VERTEX_ATTRIBUTE(Vertex, normal));
+
+    // GPU copy of one Mesh and the per frame state of the instance drawn with it
+    struct GPUMesh
+    {
+        SDLGPUBufferPtr                        vertexBuffer;    // null for a mesh without triangles
+        bool                                   bPacked = false; // `vertexBuffer` holds PackedVertex, drawn with `packedPipeline`
+        VertexCompression::QuantizationUniform quantization;
+        SDLGPUBufferPtr            indexBuffer;
+        uint32_t                   indexElementSize = sizeof(uint32_t);
+        uint32_t                   indexCount       = 0;
+        uint32_t                   lod              = 0; // kept across frames for the LOD hysteresis
+        ClusterCulling::ClusterSoA clusters;             // of LOD 0, empty without meshlets
+
+        // set by prepareModel
+        uint32_t drawIndex    = 0;
+        bool     bCulled      = false; // drawn from `meshDrawList` instead of the LOD range
+        uint32_t firstCommand = 0;
+        uint32_t commandCount = 0;
+    };
 
-    bool init(SDL_GPUDevice *device, SDL_Window *window, const GraphicsPipelineCreateInfo &pipelineCI)
+    // one entry per mesh of `model`, in the same order
+    struct GPUModel
     {
-        this->device = device;
-        this->window = window;
+        std::shared_ptr<Model> model;
+        std::vector<GPUMesh>   meshes;
+    };
 
 
-        bool ok = _pipeline.create(device, window, pipelineCI);
-        NE_CORE_ASSERT(ok, "Failed to create graphics pipeline: {}", SDL_GetError());
+    bool init(SDL_GPUDevice *device, SDL_Window *window, SDLPipelineCache &pipelineCache, const GraphicsPipelineCreateInfo &pipelineCI)
+    {
+        this->device = device;
+        this->window = window;
 
-        return _pipeline.pipeline;
+        drawDataRing.init(device, "Render3D DrawData");
+        meshDrawList.init(device, "Render3D MeshDrawList");
+
+        // the per-object data comes from `drawDataRing`, only the DRAW_DATA variant reads it.
+        // The vertices are always `MeshVertexLayout`
+        GraphicsPipelineCreateInfo createInfo = pipelineCI;
+        createInfo.bDeriveInfoFromShader      = false;
+        createInfo.vertexBufferDescs          = {MeshVertexLayout.bufferDescription()};
+        createInfo.vertexAttributes           = MeshVertexLayout.attributeList();
+        auto                      &defines    = createInfo.shaderCreateInfo.defines;
+        if (std::find(defines.begin(), defines.end(), "DRAW_DATA") == defines.end()) {
+            defines.push_back("DRAW_DATA");
+        }
+        createInfo.uniformLayouts.push_back(CameraDataLayout.info());
+
+        pipeline = pipelineCache.requestPipeline(createInfo);
+
+        // the meshes imported with AssetManager::setPackVertices(true)
+        GraphicsPipelineCreateInfo packedCreateInfo = createInfo;
+        packedCreateInfo.shaderCreateInfo.defines.push_back("PACKED_VERTEX");
+        packedCreateInfo.vertexBufferDescs = {VertexCompression::PackedVertexLayout.bufferDescription()};
+        packedCreateInfo.vertexAttributes  = VertexCompression::PackedVertexLayout.attributeList();
+        packedCreateInfo.uniformLayouts.push_back(QuantizationLayout.info());
+        packedPipeline = pipelineCache.requestPipeline(packedCreateInfo);
+
+        return pipeline.isValid() && packedPipeline.isValid();
     }
 
     void clean();
 
-    void beginFrame(SDL_GPURenderPass *renderpass, Camera &camera)
+    // Frame start, before any pushDraw
+    void beginFrame(const Camera &camera)
     {
-        SDL_BindGPUGraphicsPipeline(renderpass, _pipeline.pipeline);
-
-        // Unifrom buffer should be update continuously, or we can use a ring buffer to store the data
+        drawDataRing.reset();
+        meshDrawList.reset();
         cameraData.view       = camera.getViewMatrix();
         cameraData.projection = camera.getProjectionMatrix();
     }
 
+    // One entry per draw this frame, returns the draw index to pass to drawIndexed/bindDraw
+    uint32_t pushDraw(const glm::mat4 &model, const glm::vec4 &color = glm::vec4(1.0f))
+    {
+        return drawDataRing.push(DrawData{.model = model, .color = color}).index;
+    }
+
+    // After the last pushDraw/prepareModel, outside the render pass
+    void upload(SDL_GPUCommandBuffer *commandBuffer)
+    {
+        drawDataRing.upload(commandBuffer);
+        meshDrawList.upload(commandBuffer);
+    }
+
+    // Copies the vertices and indices of every mesh to new GPU buffers, outside a render pass. Replaces `out`.
+    // The packed vertices are uploaded instead of the float ones when the mesh has them
+    bool uploadModel(SDL_GPUCommandBuffer *commandBuffer, const std::shared_ptr<Model> &model, GPUModel &out);
+
+    // Between beginFrame and upload: one DrawData per mesh, the LOD at the mesh's projected size and,
+    // at full detail, the clusters surviving the culling
+    void prepareModel(GPUModel &gpuModel, const EditorCamera &camera, float viewportHeight);
+
+    // After bind, every mesh of a model prepared this frame
+    void drawModel(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer, const GPUModel &gpuModel);
+
+    // In the render pass: the pipeline, the draw data and the camera, once per frame.
+    // false while the pipeline is still building (or failed), skip the draws then
+    bool bind(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer)
+    {
+        boundPipeline = nullptr;
+        return bindVariant(renderpass, commandBuffer, pipeline.resolve(), DRAW_INDEX_SLOT);
+    }
+
+    // drawModel switches between `pipeline` and `packedPipeline` with this, it redoes what bind() did for the new one
+    bool bindVariant(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer, SDLGraphicsPipeLine *variant, uint32_t variantDrawIndexSlot)
+    {
+        if (!variant) {
+            return false;
+        }
+        if (variant == boundPipeline) {
+            return true;
+        }
+        SDL_BindGPUGraphicsPipeline(renderpass, variant->pipeline);
+        drawDataRing.bindVertex(renderpass);
+        SDL_PushGPUVertexUniformData(commandBuffer, CAMERA_SLOT, &cameraData, sizeof(CameraData));
+        SDL_PushGPUFragmentUniformData(commandBuffer, CAMERA_SLOT, &cameraData, sizeof(CameraData));
+        boundPipeline = variant;
+        drawIndexSlot = variantDrawIndexSlot;
+        return true;
+    }
+
+    // the draws recorded after this read the DrawData at `drawIndex`, e.g. the indirect draws of a culled mesh
+    void bindDraw(SDL_GPUCommandBuffer *commandBuffer, uint32_t drawIndex)
+    {
+        SDLUniformRing::pushDrawIndex(commandBuffer, drawIndexSlot, drawIndex);
+    }
+
+    void drawIndexed(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer, uint32_t drawIndex,
+                     uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0)
+    {
+        bindDraw(commandBuffer, drawIndex);
+        SDL_DrawGPUIndexedPrimitives(renderpass, indexCount, 1, firstIndex, vertexOffset, 0);
+    }
+
 
     struct Material
     {
@@ -87,7 +251,7 @@ struct SDLRender3D
     // change the global unifrom (global light, camera, etc.)
     void prepareGlobal()
     {
-        // SDL_BindGPUGraphicsPipeline(renderpass, _pipeline.pipeline);
+        // SDL_BindGPUGraphicsPipeline(renderpass, pipeline.resolve()->pipeline);
 
         // // dose all unifroms need to be update each frame?
         // SDL_PushGPUVertexUniformData(commandBuffer, 0, &cameraData, sizeof(CameraData));
@@ -97,6 +261,21 @@ struct SDLRender3D
 
 
 
+    // Mesh::getIndexElementSize() bytes to the SDL enum, meshes under 65536 vertices are narrowed to 16 bit
+    static SDL_GPUIndexElementSize toIndexElementSize(uint32_t indexElementSize)
+    {
+        return indexElementSize == sizeof(uint16_t) ? SDL_GPU_INDEXELEMENTSIZE_16BIT : SDL_GPU_INDEXELEMENTSIZE_32BIT;
+    }
+
+    static void bindIndexBuffer(SDL_GPURenderPass *renderpass, SDL_GPUBuffer *indexBuffer, uint32_t indexElementSize, uint32_t offset = 0)
+    {
+        SDL_GPUBufferBinding indexBufferBinding = {
+            .buffer = indexBuffer,
+            .offset = offset,
+        };
+        SDL_BindGPUIndexBuffer(renderpass, &indexBufferBinding, toIndexElementSize(indexElementSize));
+    }
+
     void draw(SDL_GPURenderPass *renderpass, SDL_GPUCommandBuffer *commandBuffer, const Camera &camera)
     {
         // // change uniforms by each elem's material for drawcall
@@ -109,12 +288,7 @@ struct SDLRender3D
         // };
         // SDL_BindGPUVertexBuffers(renderpass, 0, &vertexBufferBinding, 1);
 
-        // // TODO: use uint16  to optimize index buffer
-        // SDL_GPUBufferBinding indexBufferBinding = {
-        //     .buffer = indexBuffer,
-        //     .offset = 0,
-        // };
-        // SDL_BindGPUIndexBuffer(renderpass, &indexBufferBinding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+        // bindIndexBuffer(renderpass, indexBuffer, mesh.getIndexElementSize());
     }
 };
 
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "Render/GraphicsPipeline.h"
+#include "Render/UniformLayout.h"
+#include "Render/VertexLayout.h"
 
 #include "SDL3/SDL_gpu.h"
 
 #include "SDLShader.h"
+#include "SDLTexture.h"
 
 namespace SDL
 {
@@ -12,48 +15,68 @@ namespace SDL
 struct SDLGraphicsPipeLine : public GraphicsPipeline
 {
     SDL_GPUDevice                              *device          = nullptr; // owning device?
+    SDL_Window                                 *window          = nullptr;
     SDL_GPUGraphicsPipeline                    *pipeline        = nullptr;
     std::size_t                                 vertexInputSize = 0;
     std::vector<SDL_GPUVertexBufferDescription> vertexBufferDescs;
     std::vector<SDL_GPUVertexAttribute>         vertexAttributes;
     GraphicsPipelineCreateInfo                  pipelineCreateInfo;
 
-    bool create(SDL_GPUDevice *device, SDL_Window *window, const GraphicsPipelineCreateInfo &pipelineCI)
+    // `compiled` lets the caller hand over an already built shader (build service, hot reload),
+    // otherwise the shader named in `pipelineCI` is processed here
+    bool create(SDL_GPUDevice *device, SDL_Window *window, const GraphicsPipelineCreateInfo &pipelineCI, const CompiledShader *compiled = nullptr)
     {
-        this->device              = device;
-        pipelineCreateInfo        = pipelineCI;
-        SDLShaderProcessor shader = SDLShaderProcessor(*device)
-                                        .preprocess(pipelineCI.shaderCreateInfo) // prepare spir code and reflection info
-                                        .create();                               // sdl api create
+        this->device       = device;
+        this->window       = window;
+        pipelineCreateInfo = pipelineCI;
+        vertexBufferDescs.clear();
+        vertexAttributes.clear();
+
+        SDLShaderProcessor shader(*device);
+        // prepare spir code and reflection info
+        if (!(compiled ? shader.preprocess(*compiled) : shader.preprocess(pipelineCI.shaderCreateInfo))) {
+            NE_CORE_ERROR("Failed to build shader {}, no pipeline created", pipelineCI.shaderCreateInfo.shaderName);
+            return false;
+        }
+        shader.create(); // sdl api create
 
         auto vertexShader   = shader.vertexShader;
         auto fragmentShader = shader.fragmentShader;
-        NE_CORE_ASSERT(vertexShader && fragmentShader, "Failed to create shader: {}", SDL_GetError());
+        if (!vertexShader || !fragmentShader) {
+            NE_CORE_ERROR("Failed to create shader {}: {}", pipelineCI.shaderCreateInfo.shaderName, SDL_GetError());
+            return false;
+        }
         auto &shaderResources = shader.shaderResources;
 
+        // a hand written layout that disagrees with the shader would not fail in SDL, only render garbage
+        if (!pipelineCI.bDeriveInfoFromShader && shaderResources.contains(EShaderStage::Vertex) &&
+            !validateVertexLayout(pipelineCI, shaderResources.at(EShaderStage::Vertex)))
+        {
+            NE_CORE_ERROR("Vertex layout of {} does not match the shader inputs", pipelineCI.shaderCreateInfo.shaderName);
+            SDL_ReleaseGPUShader(device, vertexShader);
+            SDL_ReleaseGPUShader(device, fragmentShader);
+            return false;
+        }
+        // a padding mistake in a uniform mirror shifts every following member, e.g. the light data
+        if (!validateUniformLayouts(pipelineCI.uniformLayouts, shaderResources)) {
+            NE_CORE_ERROR("Uniform layouts of {} do not match the shader", pipelineCI.shaderCreateInfo.shaderName);
+            SDL_ReleaseGPUShader(device, vertexShader);
+            SDL_ReleaseGPUShader(device, fragmentShader);
+            return false;
+        }
+
         this->prepareVertexInfo(pipelineCI, shaderResources);
 
-        // this format is the final screen surface's format
-        // if you want other format, create texture yourself
-        SDL_GPUTextureFormat format = SDL_GetGPUSwapchainTextureFormat(device, window);
-        NE_CORE_ASSERT(format != SDL_GPU_TEXTUREFORMAT_INVALID, "Failed to get swapchain texture format: {}", SDL_GetError());
+        // default to the final screen surface's format
+        // if you want other format, create texture yourself and set `targetFormats.colorFormat`
+        SDL_GPUTextureFormat format = pipelineCI.targetFormats.colorFormat
+                                        ? SDLTexture::ConvertToSDLFormat(*pipelineCI.targetFormats.colorFormat)
+                                        : SDL_GetGPUSwapchainTextureFormat(device, window);
+        NE_CORE_ASSERT(format != SDL_GPU_TEXTUREFORMAT_INVALID, "Failed to get color target format: {}", SDL_GetError());
 
         SDL_GPUColorTargetDescription colorTargetDesc{
-            .format = format,
-            // final_color = (src_color × src_color_blendfactor) color_blend_op (dst_color × dst_color_blendfactor)
-            // final_alpha = (src_alpha × src_alpha_blendfactor) alpha_blend_op (dst_alpha × dst_alpha_blendfactor)
-            .blend_state = SDL_GPUColorTargetBlendState{
-                .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
-                .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
-                .color_blend_op        = SDL_GPU_BLENDOP_ADD,
-                .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
-                .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
-                .alpha_blend_op        = SDL_GPU_BLENDOP_ADD,
-                .color_write_mask      = SDL_GPU_COLORCOMPONENT_A | SDL_GPU_COLORCOMPONENT_B |
-                                    SDL_GPU_COLORCOMPONENT_G | SDL_GPU_COLORCOMPONENT_R,
-                .enable_blend            = true,
-                .enable_color_write_mask = false,
-            },
+            .format      = format,
+            .blend_state = toSDLBlendState(pipelineCI.blendMode),
         };
         SDL_GPUGraphicsPipelineCreateInfo sdlGPUCreateInfo = {
             .vertex_shader      = vertexShader,
@@ -78,7 +101,7 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
                 .enable_mask  = false,
             },
             .depth_stencil_state = SDL_GPUDepthStencilState{
-                .compare_op = SDL_GPU_COMPAREOP_GREATER, // -z forward
+                .compare_op = toSDLCompareOp(pipelineCI.depthStencil.compareOp),
                 // .back_stencil_state = SDL_GPUStencilOpState{
                 //     .fail_op       = SDL_GPU_STENCILOP_ZERO,
                 //     .pass_op       = SDL_GPU_STENCILOP_KEEP,
@@ -93,15 +116,15 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
                 // },
                 // .compare_mask        = 0xFF,
                 // .write_mask          = 0xFF,
-                .enable_depth_test   = true,
-                .enable_depth_write  = true,
+                .enable_depth_test   = pipelineCI.depthStencil.bDepthTest,
+                .enable_depth_write  = pipelineCI.depthStencil.bDepthWrite,
                 .enable_stencil_test = false,
             },
             .target_info = SDL_GPUGraphicsPipelineTargetInfo{
                 .color_target_descriptions = &colorTargetDesc,
                 .num_color_targets         = 1,
-                .depth_stencil_format      = SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT,
-                .has_depth_stencil_target  = false,
+                .depth_stencil_format      = toSDLDepthFormat(pipelineCI.targetFormats.depthFormat),
+                .has_depth_stencil_target  = pipelineCI.targetFormats.depthFormat != EDepthFormat::None,
             },
         };
         switch (pipelineCI.primitiveType) {
@@ -116,7 +139,9 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
         }
 
         pipeline = SDL_CreateGPUGraphicsPipeline(device, &sdlGPUCreateInfo);
-        NE_CORE_ASSERT(pipeline, "Failed to create graphics pipeline: {}", SDL_GetError());
+        if (!pipeline) {
+            NE_CORE_ERROR("Failed to create graphics pipeline {}: {}", pipelineCI.shaderCreateInfo.shaderName, SDL_GetError());
+        }
 
         SDL_ReleaseGPUShader(device, vertexShader);
         SDL_ReleaseGPUShader(device, fragmentShader);
@@ -133,9 +158,96 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
         }
     }
 
+    // Take over the pipeline and vertex info of `fresh`, returns the old native pipeline,
+    // the caller is responsible to release it once no frame in flight uses it
+    SDL_GPUGraphicsPipeline *swap(SDLGraphicsPipeLine &&fresh)
+    {
+        SDL_GPUGraphicsPipeline *old = pipeline;
+
+        pipeline          = fresh.pipeline;
+        vertexInputSize   = fresh.vertexInputSize;
+        vertexBufferDescs = std::move(fresh.vertexBufferDescs);
+        vertexAttributes  = std::move(fresh.vertexAttributes);
+        fresh.pipeline    = nullptr;
+
+        return old;
+    }
+
 
   private:
 
+    static SDL_GPUColorTargetBlendState toSDLBlendState(EBlendMode::T mode)
+    {
+        // final_color = (src_color × src_color_blendfactor) color_blend_op (dst_color × dst_color_blendfactor)
+        // final_alpha = (src_alpha × src_alpha_blendfactor) alpha_blend_op (dst_alpha × dst_alpha_blendfactor)
+        SDL_GPUColorTargetBlendState state{
+            .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+            .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+            .color_blend_op        = SDL_GPU_BLENDOP_ADD,
+            .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+            .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+            .alpha_blend_op        = SDL_GPU_BLENDOP_ADD,
+            .color_write_mask      = SDL_GPU_COLORCOMPONENT_A | SDL_GPU_COLORCOMPONENT_B |
+                                SDL_GPU_COLORCOMPONENT_G | SDL_GPU_COLORCOMPONENT_R,
+            .enable_blend            = true,
+            .enable_color_write_mask = false,
+        };
+
+        switch (mode) {
+        case EBlendMode::Opaque:
+            state.enable_blend = false;
+            break;
+        case EBlendMode::AlphaBlend:
+            break;
+        case EBlendMode::Additive:
+            state.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+            state.dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+            break;
+        default:
+            NE_CORE_ASSERT(false, "Invalid blend mode {}", int(mode));
+            break;
+        }
+        return state;
+    }
+
+    static SDL_GPUCompareOp toSDLCompareOp(ECompareOp::T op)
+    {
+        switch (op) {
+        case ECompareOp::Never:
+            return SDL_GPU_COMPAREOP_NEVER;
+        case ECompareOp::Less:
+            return SDL_GPU_COMPAREOP_LESS;
+        case ECompareOp::Equal:
+            return SDL_GPU_COMPAREOP_EQUAL;
+        case ECompareOp::LessOrEqual:
+            return SDL_GPU_COMPAREOP_LESS_OR_EQUAL;
+        case ECompareOp::Greater:
+            return SDL_GPU_COMPAREOP_GREATER;
+        case ECompareOp::NotEqual:
+            return SDL_GPU_COMPAREOP_NOT_EQUAL;
+        case ECompareOp::GreaterOrEqual:
+            return SDL_GPU_COMPAREOP_GREATER_OR_EQUAL;
+        case ECompareOp::Always:
+            return SDL_GPU_COMPAREOP_ALWAYS;
+        default:
+            NE_CORE_ASSERT(false, "Invalid compare op {}", int(op));
+            return SDL_GPU_COMPAREOP_INVALID;
+        }
+    }
+
+    static SDL_GPUTextureFormat toSDLDepthFormat(EDepthFormat::T format)
+    {
+        switch (format) {
+        case EDepthFormat::D24_UNORM_S8_UINT:
+            return SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT;
+        case EDepthFormat::D32_FLOAT:
+            return SDL_GPU_TEXTUREFORMAT_D32_FLOAT;
+        default:
+            // keep the old default, it is ignored without a depth target
+            return SDL_GPU_TEXTUREFORMAT_D24_UNORM_S8_UINT;
+        }
+    }
+
     void prepareVertexInfo(const GraphicsPipelineCreateInfo &pipelineCI, const std::unordered_map<EShaderStage::T, ShaderReflection::ShaderResources> &shaderResources)
     {
         // prepare vertex buffer description and vertex attributes
@@ -167,9 +279,8 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
 
             // Calculate the total size of all vertex attributes
             uint32_t totalSize = 0;
-            if (!vertexResources.inputs.empty()) {
-                const auto &lastInput = vertexResources.inputs.back();
-                totalSize             = lastInput.offset + lastInput.size;
+            for (const auto &input : vertexResources.inputs) {
+                totalSize = std::max(totalSize, input.offset + input.size);
             }
 
             this->vertexInputSize = totalSize;
@@ -211,6 +322,18 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
                 case EVertexAttributeFormat::Float4:
                     sdlVertAttr.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4;
                     break;
+                case EVertexAttributeFormat::Half2:
+                    sdlVertAttr.format = SDL_GPU_VERTEXELEMENTFORMAT_HALF2;
+                    break;
+                case EVertexAttributeFormat::UByte4Norm:
+                    sdlVertAttr.format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
+                    break;
+                case EVertexAttributeFormat::Short2Norm:
+                    sdlVertAttr.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT2_NORM;
+                    break;
+                case EVertexAttributeFormat::Short4Norm:
+                    sdlVertAttr.format = SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM;
+                    break;
                 default:
                     NE_CORE_ASSERT(false, "Invalid vertex attribute format {}", int(pipelineCI.vertexAttributes[i].format));
                     break;
@@ -218,8 +341,11 @@ struct SDLGraphicsPipeLine : public GraphicsPipeline
                 vertexAttributes.emplace_back(std::move(sdlVertAttr));
             }
 
-            const auto &last = pipelineCI.vertexAttributes.end() - 1;
-            vertexInputSize  = last->offset + EVertexAttributeFormat::T2Size(last->format);
+            // the attributes need not be sorted by offset
+            vertexInputSize = 0;
+            for (const auto &attribute : pipelineCI.vertexAttributes) {
+                vertexInputSize = std::max(vertexInputSize, attribute.offset + EVertexAttributeFormat::T2Size(attribute.format));
+            }
         }
     }
 
@@ -3,6 +3,7 @@
 #include "Render/CommandBuffer.h"
 #include "Render/Device.h"
 #include "SDL3/SDL_gpu.h"
+#include "Render/TextureFile.h"
 #include "SDLBuffers.h"
 
 
@@ -10,34 +11,39 @@
 struct SDLHelper
 {
 
-    static void uploadTexture(SDL_GPUDevice *sdlDevice, SDL_GPUCommandBuffer *sdlCommandBUffer, SDL_GPUTexture *sdlTexture, void *data, uint32_t w, uint32_t h)
+    // `data` holds `levelCount` mip levels one after the other (see TextureFile::layout), all uploaded in one copy pass.
+    // The block compressed levels are whole blocks, the regions keep the texel size of the level
+    static void uploadTexture(SDL_GPUDevice *sdlDevice, SDL_GPUCommandBuffer *sdlCommandBUffer, SDL_GPUTexture *sdlTexture, const void *data, uint32_t w, uint32_t h,
+                              ETextureFormat format = ETextureFormat::R8G8B8A8_UNORM, uint32_t levelCount = 1)
     {
-        auto textureTransferBuffer = SDLGPUTransferBuffer::Create(sdlDevice,
-                                                                  "Temp transferBuffer for texture upload",
-                                                                  SDLGPUTransferBuffer::Usage::Upload,
-                                                                  w * h * 4);
+        auto     levels                = TextureFile::layout(format, w, h, levelCount);
+        uint64_t uploadSize            = levels.back().offset + levels.back().size;
+        auto     textureTransferBuffer = SDLGPUTransferBuffer::Create(sdlDevice,
+                                                                      "Temp transferBuffer for texture upload",
+                                                                      SDLGPUTransferBuffer::Usage::Upload,
+                                                                      uploadSize);
 
         // mmap
         void *mmapPtr = SDL_MapGPUTransferBuffer(sdlDevice, textureTransferBuffer->getBuffer(), false);
-        std::memcpy(mmapPtr, data, textureTransferBuffer->getSize());
+        std::memcpy(mmapPtr, data, uploadSize);
         SDL_UnmapGPUTransferBuffer(sdlDevice, textureTransferBuffer->getBuffer());
 
         SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(sdlCommandBUffer);
-        // transfer texture
-        {
+        // transfer texture, a region per level
+        for (uint32_t level = 0; level < levels.size(); ++level) {
             SDL_GPUTextureTransferInfo srcTransferInfo = {
                 .transfer_buffer = textureTransferBuffer->getBuffer(),
-                .offset          = 0,
+                .offset          = static_cast<Uint32>(levels[level].offset),
             };
             SDL_GPUTextureRegion destGPUTextureRegion = {
                 .texture   = sdlTexture,
-                .mip_level = 0,
+                .mip_level = level,
                 .layer     = 0,
                 .x         = 0,
                 .y         = 0,
                 .z         = 0,
-                .w         = w,
-                .h         = h,
+                .w         = levels[level].width,
+                .h         = levels[level].height,
                 .d         = 1,
             };
 
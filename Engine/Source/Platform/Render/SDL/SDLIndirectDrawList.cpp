@@ -0,0 +1,84 @@
+#include "SDLIndirectDrawList.h"
+
+#include <cstring>
+
+namespace SDL
+{
+
+static constexpr std::size_t COMMAND_SIZE = sizeof(SDL_GPUIndexedIndirectDrawCommand);
+
+void SDLIndirectDrawList::init(SDL_GPUDevice *device, const std::string &name, std::size_t initialCount)
+{
+    this->device = device;
+    this->name   = name;
+
+    indirectBuffer = SDLGPUBuffer::Create(device, name, SDLGPUBuffer::Usage::IndirectBuffer, initialCount * COMMAND_SIZE);
+    transferBuffer = SDLGPUTransferBuffer::Create(device, name + " TransferBuffer", SDLGPUTransferBuffer::Usage::Upload, initialCount * COMMAND_SIZE);
+    commands.reserve(initialCount);
+}
+
+void SDLIndirectDrawList::clean()
+{
+    indirectBuffer.reset();
+    transferBuffer.reset();
+    commands.clear();
+    commands.shrink_to_fit();
+    uploadedCount = 0;
+}
+
+void SDLIndirectDrawList::upload(SDL_GPUCommandBuffer *commandBuffer)
+{
+    uploadedCount = 0;
+    if (commands.empty()) {
+        return;
+    }
+    std::size_t size = commands.size() * COMMAND_SIZE;
+
+    indirectBuffer->tryExtendSize(size);
+    transferBuffer->tryExtendSize(size);
+
+    void *mapped = SDL_MapGPUTransferBuffer(device, transferBuffer->getBuffer(), true);
+    if (!mapped) {
+        NE_CORE_ERROR("{}: failed to map the transfer buffer: {}", name, SDL_GetError());
+        return;
+    }
+    std::memcpy(mapped, commands.data(), size);
+    SDL_UnmapGPUTransferBuffer(device, transferBuffer->getBuffer());
+
+    SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+
+    SDL_GPUTransferBufferLocation source = {
+        .transfer_buffer = transferBuffer->getBuffer(),
+        .offset          = 0,
+    };
+    SDL_GPUBufferRegion destination = {
+        .buffer = indirectBuffer->getBuffer(),
+        .offset = 0,
+        .size   = static_cast<Uint32>(size),
+    };
+    SDL_UploadToGPUBuffer(copyPass, &source, &destination, true);
+    SDL_EndGPUCopyPass(copyPass);
+
+    uploadedCount = static_cast<uint32_t>(commands.size());
+}
+
+void SDLIndirectDrawList::draw(SDL_GPURenderPass *renderPass) const
+{
+    if (uploadedCount == 0) {
+        return;
+    }
+    SDL_DrawGPUIndexedPrimitivesIndirect(renderPass, indirectBuffer->getBuffer(), 0, uploadedCount);
+}
+
+void SDLIndirectDrawList::draw(SDL_GPURenderPass *renderPass, uint32_t firstCommand, uint32_t count) const
+{
+    if (count == 0 || firstCommand + count > uploadedCount) {
+        return;
+    }
+    SDL_DrawGPUIndexedPrimitivesIndirect(renderPass,
+                                         indirectBuffer->getBuffer(),
+                                         firstCommand * sizeof(SDL_GPUIndexedIndirectDrawCommand),
+                                         count);
+}
+
+} // namespace SDL
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SDL3/SDL_gpu.h"
+
+#include "SDLBuffers.h"
+
+namespace SDL
+{
+
+// Indexed draws recorded on the CPU (e.g. the clusters surviving ClusterCulling) and issued with one
+// SDL_DrawGPUIndexedPrimitivesIndirect, the draws share the bound pipeline, vertex and index buffers:
+//
+//   list.reset();                                        // frame start
+//   ClusterCulling::cull(clusters, view, list.getCommands());
+//   list.upload(commandBuffer);                          // before the render pass
+//   list.draw(renderPass);                               // after binding the mesh buffers
+//
+// Like SDLUniformRing the buffers are cycled on upload, so the frames in flight keep their commands.
+class SDLIndirectDrawList
+{
+  private:
+    SDL_GPUDevice                                 *device = nullptr;
+    std::string                                    name;
+    SDLGPUBufferPtr                                indirectBuffer;
+    SDLGPUTransferBufferPtr                        transferBuffer;
+    std::vector<SDL_GPUIndexedIndirectDrawCommand> commands;
+    uint32_t                                       uploadedCount = 0;
+
+  public:
+    void init(SDL_GPUDevice *device, const std::string &name, std::size_t initialCount = 1024);
+    void clean();
+
+    void reset()
+    {
+        commands.clear();
+        uploadedCount = 0;
+    }
+
+    std::vector<SDL_GPUIndexedIndirectDrawCommand>       &getCommands() { return commands; }
+    const std::vector<SDL_GPUIndexedIndirectDrawCommand> &getCommands() const { return commands; }
+
+    // Copy the commands to the GPU, must be recorded outside a render pass
+    void upload(SDL_GPUCommandBuffer *commandBuffer);
+
+    // issues the uploaded commands, nothing if there were none
+    void draw(SDL_GPURenderPass *renderPass) const;
+    // only `count` of them from `firstCommand`, e.g. the clusters of one mesh when several share the list
+    void draw(SDL_GPURenderPass *renderPass, uint32_t firstCommand, uint32_t count) const;
+
+    uint32_t getUploadedCount() const { return uploadedCount; }
+};
+
+} // namespace SDL
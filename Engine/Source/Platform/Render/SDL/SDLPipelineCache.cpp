@@ -0,0 +1,205 @@
+#include "SDLPipelineCache.h"
+
+#include <vector>
+
+#include "Core/Log.h"
+
+namespace SDL
+{
+
+GraphicsPipelineCreateInfo SDLPipelineCache::resolveTargets(const GraphicsPipelineCreateInfo &pipelineCI) const
+{
+    if (pipelineCI.targetFormats.colorFormat) {
+        return pipelineCI;
+    }
+    // "the swapchain format" is only known here, the window may change it
+    GraphicsPipelineCreateInfo resolved = pipelineCI;
+    SDL_GPUTextureFormat       format   = SDL_GetGPUSwapchainTextureFormat(device, window);
+    resolved.targetFormats.colorFormat  = SDLTexture::ConvertFromSDLFormat(format);
+    if (SDLTexture::ConvertToSDLFormat(*resolved.targetFormats.colorFormat) != format) {
+        NE_CORE_ERROR("Pipeline cache: swapchain format {} has no ETextureFormat, {} will not match the swapchain",
+                      int(format),
+                      pipelineCI.shaderCreateInfo.shaderName);
+    }
+    return resolved;
+}
+
+SDLPipelineCache::Slot *SDLPipelineCache::findSlot(uint64_t key, const GraphicsPipelineCreateInfo &resolvedCI)
+{
+    auto [begin, end] = slots.equal_range(key);
+    for (auto it = begin; it != end; ++it) {
+        if (it->second.createInfo.samePipeline(resolvedCI)) {
+            return &it->second;
+        }
+    }
+    return nullptr;
+}
+
+SDLGraphicsPipelinePtr SDLPipelineCache::acquire(const GraphicsPipelineCreateInfo &pipelineCI, const CompiledShader *compiled)
+{
+    // a no-op on the build pool, requestPipeline resolved it already
+    const GraphicsPipelineCreateInfo resolvedCI = resolveTargets(pipelineCI);
+    const uint64_t                   key        = resolvedCI.hash();
+
+    std::shared_ptr<std::promise<SDLGraphicsPipelinePtr>> promise;
+    std::shared_future<SDLGraphicsPipelinePtr>            pending;
+    {
+        std::lock_guard lock(mutex);
+        Slot           *found = findSlot(key, resolvedCI);
+        Slot           &slot  = found ? *found : slots.emplace(key, Slot{.createInfo = resolvedCI})->second;
+        if (auto alive = slot.pipeline.lock()) {
+            ++hits;
+            return alive;
+        }
+        if (slot.pending.valid()) {
+            pending = slot.pending;
+        }
+        else {
+            promise      = std::make_shared<std::promise<SDLGraphicsPipelinePtr>>();
+            slot.pending = promise->get_future().share();
+        }
+    }
+
+    // another thread is creating the same pipeline
+    if (!promise) {
+        return pending.get();
+    }
+
+    SDLGraphicsPipelinePtr pipeline(new SDLGraphicsPipeLine(), [](SDLGraphicsPipeLine *p) {
+        p->clean();
+        delete p;
+    });
+    if (!pipeline->create(device, window, resolvedCI, compiled)) {
+        pipeline.reset();
+    }
+
+    {
+        // the slot is only erased by purge() once `pending` is reset, it is still there
+        std::lock_guard lock(mutex);
+        Slot           *slot = findSlot(key, resolvedCI);
+        slot->pending        = {};
+        slot->pipeline       = pipeline;
+        ++creations;
+    }
+    NE_CORE_TRACE("Pipeline cache: created {} ({:016x})", resolvedCI.shaderCreateInfo.shaderName, key);
+
+    promise->set_value(pipeline);
+    return pipeline;
+}
+
+SDLPipelineCache::~SDLPipelineCache()
+{
+    // the queued builds are skipped, the running ones finish while the pool joins.
+    // The ones still waiting on their shader would queue into a destroyed pool, wait for them to give up first
+    bStopping = true;
+    std::unique_lock lock(shaderWaitMutex);
+    shaderWaitDone.wait(lock, [this] { return shaderWaits == 0; });
+}
+
+SDLPipelineHandle SDLPipelineCache::requestPipeline(const GraphicsPipelineCreateInfo &pipelineCI, SDLGraphicsPipelinePtr fallback)
+{
+    SDLPipelineHandle handle;
+    handle.state           = std::make_shared<SDLPipelineHandle::State>();
+    handle.state->fallback = std::move(fallback);
+
+    GraphicsPipelineCreateInfo resolvedCI = resolveTargets(pipelineCI);
+    {
+        std::lock_guard lock(mutex);
+        if (Slot *slot = findSlot(resolvedCI.hash(), resolvedCI)) {
+            if (auto alive = slot->pipeline.lock()) {
+                ++hits;
+                handle.state->live = std::move(alive);
+                return handle;
+            }
+        }
+    }
+
+    auto service = ShaderBuildService::get();
+    if (!service || ShaderLibrary::get()) {
+        enqueueBuild(handle.state, std::move(resolvedCI), nullptr);
+        return handle;
+    }
+
+    {
+        std::lock_guard lock(shaderWaitMutex);
+        ++shaderWaits;
+    }
+    ShaderCreateInfo shaderCI = resolvedCI.shaderCreateInfo;
+    service->whenReady(shaderCI, [this, state = handle.state, resolvedCI = std::move(resolvedCI)](const CompiledShaderPtr &compiled) {
+        if (!compiled) {
+            std::lock_guard lock(readyMutex);
+            readyBuilds.push_back(ReadyBuild{.state = state, .pipeline = nullptr});
+        }
+        else if (!bStopping) {
+            enqueueBuild(state, resolvedCI, compiled);
+        }
+
+        std::lock_guard lock(shaderWaitMutex);
+        --shaderWaits;
+        shaderWaitDone.notify_all();
+    });
+    return handle;
+}
+
+void SDLPipelineCache::enqueueBuild(std::shared_ptr<SDLPipelineHandle::State> state, GraphicsPipelineCreateInfo resolvedCI, CompiledShaderPtr compiled)
+{
+    // acquire() still dedups against other requests of the same pipeline
+    buildPool.enqueue([this, state = std::move(state), resolvedCI = std::move(resolvedCI), compiled = std::move(compiled)]() {
+        if (bStopping) {
+            return;
+        }
+        SDLGraphicsPipelinePtr pipeline = acquire(resolvedCI, compiled.get());
+
+        std::lock_guard lock(readyMutex);
+        readyBuilds.push_back(ReadyBuild{
+            .state    = state,
+            .pipeline = std::move(pipeline),
+        });
+    });
+}
+
+void SDLPipelineCache::tick()
+{
+    std::vector<ReadyBuild> ready;
+    {
+        std::lock_guard lock(readyMutex);
+        ready.swap(readyBuilds);
+    }
+
+    for (auto &build : ready) {
+        if (build.pipeline) {
+            build.state->live = std::move(build.pipeline);
+        }
+        else {
+            build.state->bFailed = true;
+            NE_CORE_ERROR("Pipeline cache: background build failed, {}", build.state->fallback ? "keeping the fallback" : "its draws are skipped");
+        }
+    }
+}
+
+void SDLPipelineCache::forEachAlive(const std::function<void(const SDLGraphicsPipelinePtr &)> &func)
+{
+    // collect first, `func` may take a while (hot reload) and must not block acquire()
+    std::vector<SDLGraphicsPipelinePtr> alive;
+    {
+        std::lock_guard lock(mutex);
+        for (auto &[_, slot] : slots) {
+            if (auto pipeline = slot.pipeline.lock()) {
+                alive.push_back(std::move(pipeline));
+            }
+        }
+    }
+    for (const auto &pipeline : alive) {
+        func(pipeline);
+    }
+}
+
+void SDLPipelineCache::purge()
+{
+    std::lock_guard lock(mutex);
+    std::erase_if(slots, [](const auto &item) {
+        return item.second.pipeline.expired() && !item.second.pending.valid();
+    });
+}
+
+} // namespace SDL
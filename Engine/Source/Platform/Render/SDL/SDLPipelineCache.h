@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "Core/ThreadPool.h"
+#include "Render/ShaderBuildService.h"
+#include "SDLGraphicsPipeline.h"
+
+namespace SDL
+{
+
+using SDLGraphicsPipelinePtr = std::shared_ptr<SDLGraphicsPipeLine>;
+
+// A pipeline requested with SDLPipelineCache::requestPipeline, copies share the same pipeline.
+// Only used on the render thread, the background build is handed over in SDLPipelineCache::tick()
+class SDLPipelineHandle
+{
+    friend class SDLPipelineCache;
+
+    struct State
+    {
+        SDLGraphicsPipelinePtr live;
+        SDLGraphicsPipelinePtr fallback;
+        bool                   bFailed = false;
+    };
+    std::shared_ptr<State> state;
+
+  public:
+    bool isValid() const { return state != nullptr; }
+    bool isReady() const { return state && state->live; }
+    bool isFailed() const { return state && state->bFailed; }
+
+    const SDLGraphicsPipelinePtr &get() const { return state->live; }
+
+    // What to draw with this frame: the pipeline once it is live, the fallback until then (or if the build failed),
+    // nullptr if there is neither and the draw should be skipped
+    SDLGraphicsPipeLine *resolve() const
+    {
+        if (!state) {
+            return nullptr;
+        }
+        return state->live ? state->live.get() : state->fallback.get();
+    }
+};
+
+// Device level cache of graphics pipelines keyed by GraphicsPipelineCreateInfo::hash(), the create info is kept
+// and compared so a hash collision cannot hand out the wrong pipeline. An empty color format is resolved to the
+// swapchain format on the calling thread, the background builds never touch the window.
+// Renderers/materials asking for the same state share one pipeline, which is created once even when the
+// requests race. The cache only keeps weak references, a pipeline is released with its last handle.
+class SDLPipelineCache
+{
+    struct Slot
+    {
+        GraphicsPipelineCreateInfo                 createInfo; // resolved, see resolveTargets
+        std::weak_ptr<SDLGraphicsPipeLine>         pipeline;
+        std::shared_future<SDLGraphicsPipelinePtr> pending; // valid while someone is creating it
+    };
+
+    SDL_GPUDevice *device = nullptr;
+    SDL_Window    *window = nullptr;
+
+    std::mutex                              mutex;
+    std::unordered_multimap<uint64_t, Slot> slots; // several on a hash collision
+
+    uint64_t hits      = 0;
+    uint64_t creations = 0;
+
+    struct ReadyBuild
+    {
+        std::shared_ptr<SDLPipelineHandle::State> state;
+        SDLGraphicsPipelinePtr                    pipeline; // nullptr if the build failed
+    };
+    std::mutex              readyMutex;
+    std::vector<ReadyBuild> readyBuilds;
+
+    // requestPipeline() builds waiting on their shader, the destructor waits for them to be queued or dropped
+    std::mutex              shaderWaitMutex;
+    std::condition_variable shaderWaitDone;
+    int                     shaderWaits = 0;
+
+    std::atomic<bool> bStopping = false;
+    ThreadPool        buildPool{"PipelineBuild", 2}; // last, joined before the members the builds use are destroyed
+
+  public:
+    SDLPipelineCache(SDL_GPUDevice *device, SDL_Window *window) : device(device), window(window) {}
+    ~SDLPipelineCache();
+
+    // nullptr if the pipeline could not be created. `compiled` hands over an already built shader, otherwise it is
+    // built (or waited for) here
+    SDLGraphicsPipelinePtr acquire(const GraphicsPipelineCreateInfo &pipelineCI, const CompiledShader *compiled = nullptr);
+
+    // Returns at once, the shader compile and the pipeline creation run in the background.
+    // Already alive pipelines are live in the handle right away, the others go live in the first tick() after the build.
+    // With the ShaderBuildService the pipeline is only queued once its shader is built, so the pipelines start in the
+    // order their shaders finish and no build worker sits blocked on a compile
+    SDLPipelineHandle requestPipeline(const GraphicsPipelineCreateInfo &pipelineCI, SDLGraphicsPipelinePtr fallback = nullptr);
+
+    // Frame start on the render thread: makes the finished background builds live
+    void tick();
+
+    // the pipelines still referenced by someone, e.g. for hot reload
+    void forEachAlive(const std::function<void(const SDLGraphicsPipelinePtr &)> &func);
+
+    // drop the expired slots
+    void purge();
+
+    uint64_t getHitCount() const { return hits; }
+    uint64_t getCreationCount() const { return creations; }
+
+  private:
+    void enqueueBuild(std::shared_ptr<SDLPipelineHandle::State> state, GraphicsPipelineCreateInfo resolvedCI, CompiledShaderPtr compiled);
+
+    // the create info with the swapchain format filled in, on the render thread: it reads the window state
+    GraphicsPipelineCreateInfo resolveTargets(const GraphicsPipelineCreateInfo &pipelineCI) const;
+
+    // under `mutex`, nullptr if there is none
+    Slot *findSlot(uint64_t key, const GraphicsPipelineCreateInfo &resolvedCI);
+};
+
+} // namespace SDL
@@ -2,6 +2,8 @@
 
 #include "Render/Render.h"
 #include "Render/Shader.h"
+#include "Render/ShaderBuildService.h"
+#include "Render/ShaderLibrary.h"
 
 namespace SDL
 {
@@ -21,33 +23,56 @@ struct SDLShaderProcessor
 
     SDLShaderProcessor(SDL_GPUDevice &device) : device(device) {}
 
-    SDLShaderProcessor &preprocess(const ShaderCreateInfo &shaderCI)
+    // false if the shader could not be built, e.g. a compile error. Nothing is created then
+    bool preprocess(const ShaderCreateInfo &shaderCI)
     {
+        // the cooked library is all we have in the builds without the shader compiler
+        if (auto library = ShaderLibrary::get()) {
+            if (CompiledShaderPtr compiled = library->find(shaderCI)) {
+                return preprocess(*compiled);
+            }
+            NE_CORE_WARN("{} [{}] is not in the shader library", shaderCI.shaderName, ShaderPermutation(shaderCI.defines).key());
+        }
 
-        ShaderScriptProcessorFactory factory;
-        factory.withProcessorType(ShaderScriptProcessorFactory::EProcessorType::GLSL)
-            .withShaderStoragePath("Engine/Shader/GLSL")
-            .withCachedStoragePath("Engine/Intermediate/Shader/GLSL");
+        // prefer the build service, the shader may already be compiled in the background
+        if (auto service = ShaderBuildService::get()) {
+            CompiledShaderPtr compiled = service->request(shaderCI).get();
+            if (!compiled) {
+                NE_CORE_ERROR("Failed to process shader: {}", shaderCI.shaderName);
+                return false;
+            }
+            return preprocess(*compiled);
+        }
 
-        std::shared_ptr<ShaderScriptProcessor> processor = factory.FactoryNew();
+        std::shared_ptr<ShaderScriptProcessor> processor = ShaderScriptProcessorFactory::defaultGLSL().FactoryNew();
 
-        auto ret = processor->process(shaderCI.shaderName);
+        ShaderPermutation permutation(shaderCI.defines);
+        auto              ret = processor->process(shaderCI.shaderName, permutation);
         if (!ret) {
             NE_CORE_ERROR("Failed to process shader: {}", processor->tempProcessingPath);
-            NE_CORE_ASSERT(false, "Failed to process shader: {}", processor->tempProcessingPath);
+            return false;
         }
         // store the temp codes
         shaderCodes = std::move(ret.value());
 
-        // Process each shader stage and store both SPIRV-Cross resources and our custom reflection data
-        for (const auto &[stage, code] : shaderCodes) {
-            // Get shader resources from SPIR-V reflection using our new custom reflection
-            ShaderReflection::ShaderResources reflectedResources = processor->reflect(stage, code);
+        // Reflection data is loaded from the binary sidecar when the SPIR-V is unchanged,
+        // SPIRV-Cross only runs for the stages that were recompiled
+        shaderResources = processor->reflectWithCache(permutation.variantName(shaderCI.shaderName), shaderCodes);
 
-            // Also store the original SPIRV-Cross resources for backward compatibility
-            shaderResources[stage] = reflectedResources;
-        }
+        prepareCreateInfos();
+        return true;
+    }
 
+    bool preprocess(const CompiledShader &compiled)
+    {
+        shaderCodes     = compiled.spirv;
+        shaderResources = compiled.resources;
+        prepareCreateInfos();
+        return true;
+    }
+
+    SDLShaderProcessor &prepareCreateInfos()
+    {
         // Create shader create info for vertex shader
         vertexCreateInfo = {
             .code_size            = shaderCodes[EShaderStage::Vertex].size() * sizeof(uint32_t) / sizeof(uint8_t),
@@ -57,7 +82,7 @@ struct SDLShaderProcessor
             .stage                = SDL_GPU_SHADERSTAGE_VERTEX,
             .num_samplers         = (Uint32)shaderResources[EShaderStage::Vertex].sampledImages.size(),
             .num_storage_textures = 0, // We're not using storage images currently
-            .num_storage_buffers  = 0, // We're not using storage buffers currently
+            .num_storage_buffers  = (Uint32)shaderResources[EShaderStage::Vertex].storageBuffers.size(),
             .num_uniform_buffers  = (Uint32)shaderResources[EShaderStage::Vertex].uniformBuffers.size(),
             .props                = 0,
 
@@ -72,7 +97,7 @@ struct SDLShaderProcessor
             .stage                = SDL_GPU_SHADERSTAGE_FRAGMENT,
             .num_samplers         = (Uint32)shaderResources[EShaderStage::Fragment].sampledImages.size(),
             .num_storage_textures = 0, // We're not using storage images currently
-            .num_storage_buffers  = 0, // We're not using storage buffers currently
+            .num_storage_buffers  = (Uint32)shaderResources[EShaderStage::Fragment].storageBuffers.size(),
             .num_uniform_buffers  = [&]() -> Uint32 {
                 const auto fragmentUniformCount = shaderResources[EShaderStage::Fragment].uniformBuffers.size();
                 const auto samplerCount         = shaderResources[EShaderStage::Fragment].sampledImages.size();
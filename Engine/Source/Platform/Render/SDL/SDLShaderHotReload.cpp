@@ -0,0 +1,286 @@
+#include "SDLShaderHotReload.h"
+
+#include <algorithm>
+
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/Log.h"
+#include "Render/ShaderBuildService.h"
+
+namespace SDL
+{
+
+void SDLShaderHotReload::start(std::string_view shaderDir)
+{
+    watchDir = FileSystem::get()->getProjectRoot() / shaderDir;
+    scanChanges(); // record the initial timestamps
+
+    bStopping = false;
+    watcher   = std::thread([this]() { watchLoop(); });
+    NE_CORE_INFO("Shader hot reload watching {}", watchDir.string());
+}
+
+void SDLShaderHotReload::stop()
+{
+    {
+        std::lock_guard lock(stopMutex);
+        bStopping = true;
+    }
+    stopCv.notify_all();
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+
+    // the swaps never happened, drop the fresh pipelines
+    {
+        std::lock_guard lock(mutex);
+        for (auto &swap : pendingSwaps) {
+            swap.fresh.clean();
+        }
+        pendingSwaps.clear();
+        entries.clear();
+        pipelineCache = nullptr;
+    }
+    releaseRetired(true);
+}
+
+void SDLShaderHotReload::watch(SDLGraphicsPipeLine *pipeline)
+{
+    WatchEntry entry{
+        .target     = pipeline,
+        .createInfo = pipeline->pipelineCreateInfo,
+        .device     = pipeline->device,
+        .window     = pipeline->window,
+    };
+    // the pipeline was just created from this build, so it is already finished
+    if (auto service = ShaderBuildService::get()) {
+        if (auto compiled = service->request(entry.createInfo.shaderCreateInfo).get()) {
+            entry.dependencies = compiled->dependencies;
+        }
+    }
+
+    std::lock_guard lock(mutex);
+    entries.push_back(std::move(entry));
+}
+
+void SDLShaderHotReload::watch(SDLPipelineCache *cache)
+{
+    std::lock_guard lock(mutex);
+    pipelineCache = cache;
+}
+
+void SDLShaderHotReload::unwatch(SDLGraphicsPipeLine *pipeline)
+{
+    std::lock_guard lock(mutex);
+    std::erase_if(entries, [pipeline](const WatchEntry &entry) { return entry.target == pipeline; });
+    std::erase_if(pendingSwaps, [pipeline](PendingSwap &swap) {
+        if (swap.target == pipeline) {
+            swap.fresh.clean();
+            return true;
+        }
+        return false;
+    });
+}
+
+void SDLShaderHotReload::tick()
+{
+    ++frameIndex;
+
+    std::vector<PendingSwap> swaps;
+    {
+        std::lock_guard lock(mutex);
+        swaps = std::move(pendingSwaps);
+        pendingSwaps.clear();
+    }
+
+    for (auto &swap : swaps) {
+        SDL_GPUGraphicsPipeline *old = swap.target->swap(std::move(swap.fresh));
+        if (old) {
+            retiredPipelines.push_back({swap.target->device, old, frameIndex});
+        }
+        NE_CORE_INFO("Hot reloaded pipeline of {}", swap.target->pipelineCreateInfo.shaderCreateInfo.shaderName);
+    }
+
+    releaseRetired(false);
+}
+
+void SDLShaderHotReload::watchLoop()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(stopMutex);
+            if (stopCv.wait_for(lock, POLL_INTERVAL, [this]() { return bStopping; })) {
+                return;
+            }
+        }
+
+        for (const auto &shaderName : scanChanges()) {
+            rebuild(shaderName);
+        }
+    }
+}
+
+std::vector<std::string> SDLShaderHotReload::scanChanges()
+{
+    std::vector<std::string> changed;
+
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(watchDir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator();
+         it.increment(ec))
+    {
+        if (!it->is_regular_file() || it->path().extension() != ".glsl") {
+            continue;
+        }
+
+        auto writeTime = it->last_write_time(ec);
+        if (ec) {
+            continue;
+        }
+
+        // the name relative to the shader dir, same as ShaderCreateInfo::shaderName
+        std::string name = std::filesystem::relative(it->path(), watchDir).generic_string();
+
+        auto [entry, bInserted] = lastWriteTimes.try_emplace(name, writeTime);
+        if (!bInserted && entry->second != writeTime) {
+            entry->second = writeTime;
+            changed.push_back(name);
+        }
+    }
+    return changed;
+}
+
+std::vector<SDLShaderHotReload::WatchEntry> SDLShaderHotReload::collectTargets(const std::string &changedFile)
+{
+    auto bAffected = [&changedFile](const std::string &shaderName, const std::vector<std::string> &dependencies) {
+        return shaderName == changedFile ||
+               std::find(dependencies.begin(), dependencies.end(), changedFile) != dependencies.end();
+    };
+
+    std::vector<WatchEntry> targets;
+    SDLPipelineCache       *cache = nullptr;
+    {
+        std::lock_guard lock(mutex);
+        for (const auto &entry : entries) {
+            if (bAffected(entry.createInfo.shaderCreateInfo.shaderName, entry.dependencies)) {
+                targets.push_back(entry);
+            }
+        }
+        cache = pipelineCache;
+    }
+
+    if (cache)
+    {
+        auto service = ShaderBuildService::get();
+        cache->forEachAlive([&](const SDLGraphicsPipelinePtr &pipeline) {
+            const auto &shaderCI = pipeline->pipelineCreateInfo.shaderCreateInfo;
+
+            // the last build knows the included files
+            std::vector<std::string> dependencies;
+            if (service) {
+                if (auto compiled = service->request(shaderCI).get()) {
+                    dependencies = compiled->dependencies;
+                }
+            }
+            if (bAffected(shaderCI.shaderName, dependencies)) {
+                targets.push_back(WatchEntry{
+                    .target       = pipeline.get(),
+                    .owner        = pipeline,
+                    .createInfo   = pipeline->pipelineCreateInfo,
+                    .device       = pipeline->device,
+                    .window       = pipeline->window,
+                    .dependencies = std::move(dependencies),
+                });
+            }
+        });
+    }
+    return targets;
+}
+
+void SDLShaderHotReload::rebuild(const std::string &changedFile)
+{
+    std::vector<WatchEntry> targets = collectTargets(changedFile);
+    if (targets.empty()) {
+        return;
+    }
+
+    NE_CORE_INFO("Shader changed: {}, recompiling", changedFile);
+
+    // pipelines sharing a variant share one compile
+    std::unordered_map<std::string, CompiledShaderPtr> variants;
+
+    auto compile = [&variants](const ShaderCreateInfo &shaderCI) -> CompiledShaderPtr {
+        ShaderPermutation permutation(shaderCI.defines);
+        std::string       variantKey = permutation.variantName(shaderCI.shaderName);
+        if (auto it = variants.find(variantKey); it != variants.end()) {
+            return it->second;
+        }
+
+        CompiledShaderPtr compiled;
+        if (auto service = ShaderBuildService::get()) {
+            compiled = service->request(shaderCI.shaderName, permutation, true).get();
+        }
+        else {
+            auto processor = ShaderScriptProcessorFactory::defaultGLSL().FactoryNew();
+            if (auto spirv = processor->process(shaderCI.shaderName, permutation)) {
+                auto shader         = std::make_shared<CompiledShader>();
+                shader->name        = shaderCI.shaderName;
+                shader->permutation = permutation;
+                shader->resources   = processor->reflectWithCache(variantKey, *spirv);
+                shader->spirv       = std::move(*spirv);
+                compiled            = std::move(shader);
+            }
+        }
+        variants[variantKey] = compiled;
+        return compiled;
+    };
+
+    // build the pipelines here on the watcher thread, only the swap happens on the main thread
+    for (auto &entry : targets)
+    {
+        const auto &shaderCI = entry.createInfo.shaderCreateInfo;
+
+        CompiledShaderPtr compiled = compile(shaderCI);
+        if (!compiled) {
+            NE_CORE_ERROR("Hot reload of {} failed, keep the old pipeline", shaderCI.shaderName);
+            continue;
+        }
+
+        SDLGraphicsPipeLine fresh;
+        if (!fresh.create(entry.device, entry.window, entry.createInfo, compiled.get()) || !fresh.pipeline) {
+            NE_CORE_ERROR("Failed to rebuild pipeline of {}, keep the old pipeline", shaderCI.shaderName);
+            fresh.clean();
+            continue;
+        }
+
+        std::lock_guard lock(mutex);
+        if (!entry.owner)
+        {
+            // the target may be unwatched while we were building
+            auto it = std::find_if(entries.begin(), entries.end(), [&](const WatchEntry &e) { return e.target == entry.target; });
+            if (it == entries.end()) {
+                fresh.clean();
+                continue;
+            }
+            it->dependencies = compiled->dependencies;
+        }
+        pendingSwaps.push_back(PendingSwap{
+            .target = entry.target,
+            .owner  = entry.owner,
+            .fresh  = std::move(fresh),
+        });
+    }
+}
+
+void SDLShaderHotReload::releaseRetired(bool bAll)
+{
+    std::erase_if(retiredPipelines, [this, bAll](const RetiredPipeline &retired) {
+        if (bAll || frameIndex - retired.retiredFrame >= FRAMES_IN_FLIGHT) {
+            SDL_ReleaseGPUGraphicsPipeline(retired.device, retired.pipeline);
+            return true;
+        }
+        return false;
+    });
+}
+
+} // namespace SDL
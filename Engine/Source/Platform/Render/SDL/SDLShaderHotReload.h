@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "SDLPipelineCache.h"
+
+namespace SDL
+{
+
+// Watches Engine/Shader/GLSL and rebuilds the pipelines of changed shaders (or of shaders including a changed file) in the background.
+// The fresh pipelines are swapped in by `tick()` at the frame boundary, the old ones are released
+// after the frames in flight are done with them. A failed compile keeps the old pipeline.
+struct SDLShaderHotReload
+{
+    static constexpr uint32_t FRAMES_IN_FLIGHT = 3; // SDL allows 2 by default, keep one more for safety
+    static constexpr auto     POLL_INTERVAL    = std::chrono::milliseconds(500);
+
+  private:
+    struct WatchEntry
+    {
+        SDLGraphicsPipeLine       *target;
+        SDLGraphicsPipelinePtr     owner; // set for the pipelines of the cache, keeps them alive until the swap
+        GraphicsPipelineCreateInfo createInfo;
+        SDL_GPUDevice             *device;
+        SDL_Window                *window;
+        std::vector<std::string>   dependencies; // files included by the shader, from the last build
+    };
+
+    struct PendingSwap
+    {
+        SDLGraphicsPipeLine   *target;
+        SDLGraphicsPipelinePtr owner;
+        SDLGraphicsPipeLine    fresh;
+    };
+
+    struct RetiredPipeline
+    {
+        SDL_GPUDevice           *device;
+        SDL_GPUGraphicsPipeline *pipeline;
+        uint64_t                 retiredFrame;
+    };
+
+    std::filesystem::path                                            watchDir;
+    std::unordered_map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+
+    std::mutex               mutex; // guards entries, pendingSwaps and pipelineCache
+    std::vector<WatchEntry>  entries;
+    SDLPipelineCache        *pipelineCache = nullptr;
+    std::vector<PendingSwap> pendingSwaps;
+
+    // main thread only
+    std::vector<RetiredPipeline> retiredPipelines;
+    uint64_t                     frameIndex = 0;
+
+    std::thread             watcher;
+    std::mutex              stopMutex;
+    std::condition_variable stopCv;
+    bool                    bStopping = false;
+
+  public:
+    void start(std::string_view shaderDir = "Engine/Shader/GLSL");
+    void stop();
+
+    void watch(SDLGraphicsPipeLine *pipeline);
+    void unwatch(SDLGraphicsPipeLine *pipeline);
+    // every pipeline alive in the cache at the time of a change is rebuilt
+    void watch(SDLPipelineCache *cache);
+
+    // call once per frame on the main thread, before any pipeline is bound
+    void tick();
+
+  private:
+    void                     watchLoop();
+    std::vector<std::string> scanChanges();
+    std::vector<WatchEntry>  collectTargets(const std::string &changedFile);
+    void                     rebuild(const std::string &changedFile);
+    void                     releaseRetired(bool bAll);
+};
+
+} // namespace SDL
@@ -7,6 +7,8 @@
 #include "Core/FileSystem/FileSystem.h"
 #include "Core/Log.h"
 #include "Render/CommandBuffer.h"
+#include "Render/TextureFile.h"
+#include "Render/TextureMips.h"
 #include "SDLGPUCommandBuffer.h"
 #include "SDLGPURender3D.h"
 #include "SDLHelper.h"
@@ -40,6 +42,21 @@ bool SDLTexture::createFromFile(const std::string &filepath, std::shared_ptr<Com
         return false;
     }
 
+    // cooked by neon-cook, the pixels are uploaded straight from the mapping
+    if (std::filesystem::path(filepath).extension() == TextureFile::EXTENSION) {
+        auto cooked = TextureFile::load(filepath);
+        if (!cooked) {
+            return false;
+        }
+        return createFromBuffer(cooked->pixels.data(),
+                                cooked->width,
+                                cooked->height,
+                                cooked->format,
+                                std::filesystem::path(filepath).stem().string(),
+                                commandBuffer,
+                                cooked->mipCount);
+    }
+
     auto         path    = FileSystem::get()->getProjectRoot() / filepath;
     SDL_Surface *surface = IMG_Load(path.string().c_str());
     if (!surface) {
@@ -47,15 +64,18 @@ bool SDLTexture::createFromFile(const std::string &filepath, std::shared_ptr<Com
         return false;
     }
 
-    SDL_GPUTexture          *texture = nullptr;
+    // not cooked, the GPU generates the mips from level 0 (a linear blit, the cooker's are gamma correct),
+    // which needs the texture to be a color target as well
+    uint32_t                 levelCount = TextureMips::levelCount(static_cast<uint32_t>(surface->w), static_cast<uint32_t>(surface->h));
+    SDL_GPUTexture          *texture    = nullptr;
     SDL_GPUTextureCreateInfo info{
         .type                 = SDL_GPU_TEXTURETYPE_2D,
         .format               = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
-        .usage                = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+        .usage                = levelCount > 1 ? SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COLOR_TARGET : SDL_GPU_TEXTUREUSAGE_SAMPLER,
         .width                = static_cast<Uint32>(surface->w),
         .height               = static_cast<Uint32>(surface->h),
         .layer_count_or_depth = 1,
-        .num_levels           = 1,
+        .num_levels           = levelCount,
     };
 
     texture = SDL_CreateGPUTexture(device.getNativeDevicePtr<SDL_GPUDevice>(), &info);
@@ -75,6 +95,16 @@ bool SDLTexture::createFromFile(const std::string &filepath, std::shared_ptr<Com
                              surface->pixels,
                              surface->w,
                              surface->h);
+    if (levelCount > 1) {
+        SDL_GenerateMipmapsForGPUTexture(sdlCommandBuffer, texture);
+    }
+
+    textureHandle = texture;
+    width         = static_cast<uint32_t>(surface->w);
+    height        = static_cast<uint32_t>(surface->h);
+    mipCount      = levelCount;
+    this->format  = ETextureFormat::R8G8B8A8_UNORM;
+    this->name    = filename;
 
     SDL_DestroySurface(surface);
     return true;
@@ -82,7 +112,7 @@ bool SDLTexture::createFromFile(const std::string &filepath, std::shared_ptr<Com
 
 bool SDLTexture::createFromBuffer(const void *data, uint32_t width, uint32_t height,
                                   ETextureFormat format, const std::string &name,
-                                  std::shared_ptr<CommandBuffer> commandBuffer)
+                                  std::shared_ptr<CommandBuffer> commandBuffer, uint32_t mipCount)
 {
     auto *sdlDevice        = device.getNativeDevicePtr<SDL_GPUDevice>();
     auto *sdlCommandBuffer = commandBuffer->getNativeCommandBufferPtr<SDL_GPUCommandBuffer>();
@@ -92,6 +122,12 @@ bool SDLTexture::createFromBuffer(const void *data, uint32_t width, uint32_t hei
         return false;
     }
 
+    // the BC formats are desktop only, cook uncompressed for the others
+    if (!SDL_GPUTextureSupportsFormat(sdlDevice, ConvertToSDLFormat(format), SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+        NE_CORE_ERROR("Texture {}: format {} is not supported by the device", name, static_cast<int>(format));
+        return false;
+    }
+
     SDL_GPUTexture          *texture = nullptr;
     SDL_GPUTextureCreateInfo info{
         .type                 = SDL_GPU_TEXTURETYPE_2D,
@@ -100,7 +136,7 @@ bool SDLTexture::createFromBuffer(const void *data, uint32_t width, uint32_t hei
         .width                = width,
         .height               = height,
         .layer_count_or_depth = 1,
-        .num_levels           = 1,
+        .num_levels           = mipCount,
     };
 
     texture = SDL_CreateGPUTexture(sdlDevice, &info);
@@ -114,10 +150,18 @@ bool SDLTexture::createFromBuffer(const void *data, uint32_t width, uint32_t hei
     SDLHelper::uploadTexture(sdlDevice,
                              sdlCommandBuffer,
                              texture,
-                             (void *)data,
+                             data,
                              width,
-                             height);
-
+                             height,
+                             format,
+                             mipCount);
+
+    textureHandle  = texture;
+    this->width    = width;
+    this->height   = height;
+    this->mipCount = mipCount;
+    this->format   = format;
+    this->name     = name;
     return true;
 }
 
@@ -179,6 +223,24 @@ SDL_GPUTextureFormat SDLTexture::ConvertToSDLFormat(ETextureFormat format)
         return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM; // Note: SDL might not have direct R8G8B8 format
     case ETextureFormat::RGBA32_FLOAT:
         return SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT;
+    case ETextureFormat::B8G8R8A8_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM;
+    case ETextureFormat::B8G8R8A8_UNORM_SRGB:
+        return SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB;
+    case ETextureFormat::R8G8B8A8_UNORM_SRGB:
+        return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB;
+    case ETextureFormat::R10G10B10A2_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_R10G10B10A2_UNORM;
+    case ETextureFormat::RGBA16_FLOAT:
+        return SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT;
+    case ETextureFormat::BC1_RGBA_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM;
+    case ETextureFormat::BC3_RGBA_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM;
+    case ETextureFormat::BC5_RG_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM;
+    case ETextureFormat::BC7_RGBA_UNORM:
+        return SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM;
     default:
         return SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
     }
@@ -191,6 +253,24 @@ ETextureFormat SDLTexture::ConvertFromSDLFormat(SDL_GPUTextureFormat format)
         return ETextureFormat::R8G8B8A8_UNORM;
     case SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT:
         return ETextureFormat::RGBA32_FLOAT;
+    case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+        return ETextureFormat::B8G8R8A8_UNORM;
+    case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+        return ETextureFormat::B8G8R8A8_UNORM_SRGB;
+    case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+        return ETextureFormat::R8G8B8A8_UNORM_SRGB;
+    case SDL_GPU_TEXTUREFORMAT_R10G10B10A2_UNORM:
+        return ETextureFormat::R10G10B10A2_UNORM;
+    case SDL_GPU_TEXTUREFORMAT_R16G16B16A16_FLOAT:
+        return ETextureFormat::RGBA16_FLOAT;
+    case SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM:
+        return ETextureFormat::BC1_RGBA_UNORM;
+    case SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM:
+        return ETextureFormat::BC3_RGBA_UNORM;
+    case SDL_GPU_TEXTUREFORMAT_BC5_RG_UNORM:
+        return ETextureFormat::BC5_RG_UNORM;
+    case SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM:
+        return ETextureFormat::BC7_RGBA_UNORM;
     default:
         return ETextureFormat::R8G8B8A8_UNORM;
     }
@@ -16,6 +16,7 @@ class SDLTexture : public Texture
     SDL_GPUTexture *textureHandle = nullptr;
     uint32_t        width         = 0;
     uint32_t        height        = 0;
+    uint32_t        mipCount      = 1;
     ETextureFormat  format        = ETextureFormat::R8G8B8A8_UNORM;
     ETextureType    type          = ETextureType::Texture2D;
     std::string     name;
@@ -41,6 +42,7 @@ class SDLTexture : public Texture
 
     // SDL specific methods
     SDL_GPUTexture *GetSDLTexture() const { return textureHandle; }
+    uint32_t        GetMipCount() const { return mipCount; }
 
     // Helper functions
     static SDL_GPUTextureFormat ConvertToSDLFormat(ETextureFormat format);
@@ -50,9 +52,10 @@ class SDLTexture : public Texture
 
     bool createFromFile(const std::string &filepath, std::shared_ptr<CommandBuffer> commandBuffer);
 
+    // `data` holds `mipCount` levels, see TextureMips::layout
     bool createFromBuffer(const void *data, uint32_t width, uint32_t height,
                           ETextureFormat format, const std::string &name,
-                          std::shared_ptr<CommandBuffer> commandBuffer);
+                          std::shared_ptr<CommandBuffer> commandBuffer, uint32_t mipCount = 1);
 
     bool createEmpty(uint32_t width, uint32_t height,
                      ETextureFormat format, ETextureUsage usage,
@@ -0,0 +1,76 @@
+#include "SDLUniformRing.h"
+
+#include <algorithm>
+
+namespace SDL
+{
+
+void SDLUniformRing::init(SDL_GPUDevice *device, const std::string &name, std::size_t initialSize)
+{
+    this->device = device;
+    this->name   = name;
+
+    storageBuffer  = SDLGPUBuffer::Create(device, name, SDLGPUBuffer::Usage::StorageBuffer, initialSize);
+    transferBuffer = SDLGPUTransferBuffer::Create(device, name + " TransferBuffer", SDLGPUTransferBuffer::Usage::Upload, initialSize);
+    staging.reserve(initialSize);
+}
+
+void SDLUniformRing::clean()
+{
+    storageBuffer.reset();
+    transferBuffer.reset();
+    staging.clear();
+    staging.shrink_to_fit();
+}
+
+void SDLUniformRing::upload(SDL_GPUCommandBuffer *commandBuffer)
+{
+    if (staging.empty()) {
+        return;
+    }
+    peakSize = std::max(peakSize, staging.size());
+
+    // growing recreates the buffers, which is fine: the old ones are released by SDL once the frames using them finish
+    if (staging.size() > storageBuffer->getSize()) {
+        NE_CORE_INFO("{}: growing to hold {} bytes", name, staging.size());
+    }
+    storageBuffer->tryExtendSize(staging.size());
+    transferBuffer->tryExtendSize(staging.size());
+
+    // cycle, the previous frame may still read the last contents
+    void *mapped = SDL_MapGPUTransferBuffer(device, transferBuffer->getBuffer(), true);
+    if (!mapped) {
+        NE_CORE_ERROR("{}: failed to map the transfer buffer: {}", name, SDL_GetError());
+        return;
+    }
+    std::memcpy(mapped, staging.data(), staging.size());
+    SDL_UnmapGPUTransferBuffer(device, transferBuffer->getBuffer());
+
+    SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+
+    SDL_GPUTransferBufferLocation source = {
+        .transfer_buffer = transferBuffer->getBuffer(),
+        .offset          = 0,
+    };
+    SDL_GPUBufferRegion destination = {
+        .buffer = storageBuffer->getBuffer(),
+        .offset = 0,
+        .size   = static_cast<Uint32>(staging.size()),
+    };
+    SDL_UploadToGPUBuffer(copyPass, &source, &destination, true);
+    SDL_EndGPUCopyPass(copyPass);
+}
+
+void SDLUniformRing::bindVertex(SDL_GPURenderPass *renderPass, uint32_t slot) const
+{
+    SDL_GPUBuffer *buffer = storageBuffer->getBuffer();
+    SDL_BindGPUVertexStorageBuffers(renderPass, slot, &buffer, 1);
+}
+
+void SDLUniformRing::bindFragment(SDL_GPURenderPass *renderPass, uint32_t slot) const
+{
+    SDL_GPUBuffer *buffer = storageBuffer->getBuffer();
+    SDL_BindGPUFragmentStorageBuffers(renderPass, slot, &buffer, 1);
+}
+
+} // namespace SDL
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "SDL3/SDL_gpu.h"
+
+#include "SDLBuffers.h"
+
+namespace SDL
+{
+
+// Per-frame linear allocator for per-draw constant data (transforms, materials, ...).
+// Everything pushed during a frame is uploaded into one readonly storage buffer with a single copy pass,
+// the shaders index it with the draw index, which is the only uniform pushed per draw, see Include/DrawData.glsl:
+//
+//   ring.reset();                                       // frame start
+//   auto a = ring.push(DrawData{...});                  // per draw, before the render pass
+//   ring.upload(commandBuffer);                         // before the render pass
+//   ring.bindVertex(renderPass);
+//   SDLUniformRing::pushDrawIndex(commandBuffer, 1, a.index); SDL_DrawGPU...(...)
+//
+// The transfer and storage buffers are cycled by SDL on upload, so the frames in flight keep their data.
+class SDLUniformRing
+{
+  public:
+    // std430 array stride of anything holding a vec4
+    static constexpr uint32_t ALIGNMENT = 16;
+
+    struct Allocation
+    {
+        uint32_t offset; // in bytes
+        uint32_t index;  // element index in the shader array of the pushed type
+    };
+
+  private:
+    SDL_GPUDevice          *device = nullptr;
+    std::string             name;
+    SDLGPUBufferPtr         storageBuffer;
+    SDLGPUTransferBufferPtr transferBuffer;
+    std::vector<uint8_t>    staging; // this frame's data, grows as needed, the GPU buffers follow on upload
+    std::size_t             peakSize = 0;
+
+  public:
+    void init(SDL_GPUDevice *device, const std::string &name, std::size_t initialSize = 64 * 1024);
+    void clean();
+
+    // frame start, the previous allocations become invalid
+    void reset() { staging.clear(); }
+
+    // `T` is the std430 mirror of the shader element, the returned index addresses `data` in an array of `T`
+    template <typename T>
+    Allocation push(const T &data)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "uniform ring data is copied as bytes");
+        static_assert(sizeof(T) % ALIGNMENT == 0, "pad the element to the std430 array stride");
+
+        // aligned to the element size, so the offset is a whole index for this type
+        std::size_t offset = (staging.size() + sizeof(T) - 1) / sizeof(T) * sizeof(T);
+        staging.resize(offset + sizeof(T));
+        std::memcpy(staging.data() + offset, &data, sizeof(T));
+        return Allocation{
+            .offset = static_cast<uint32_t>(offset),
+            .index  = static_cast<uint32_t>(offset / sizeof(T)),
+        };
+    }
+
+    // Copy this frame's data to the GPU, must be recorded outside a render pass
+    void upload(SDL_GPUCommandBuffer *commandBuffer);
+
+    // SDL: set 0 of the stage, after its sampled and storage textures
+    void bindVertex(SDL_GPURenderPass *renderPass, uint32_t slot = 0) const;
+    void bindFragment(SDL_GPURenderPass *renderPass, uint32_t slot = 0) const;
+
+    // the 4 byte draw index uniform, `slot` is the binding of the DrawIndex block in the uniform set
+    static void pushDrawIndex(SDL_GPUCommandBuffer *commandBuffer, uint32_t slot, uint32_t index)
+    {
+        SDL_PushGPUVertexUniformData(commandBuffer, slot, &index, sizeof(index));
+    }
+
+    std::size_t getUsedSize() const { return staging.size(); }
+    std::size_t getPeakSize() const { return peakSize; }
+    std::size_t getCapacity() const { return storageBuffer ? storageBuffer->getSize() : 0; }
+};
+
+} // namespace SDL
@@ -0,0 +1,83 @@
+#include "AssimpIOSystem.h"
+
+#if NE_WITH_ASSET_IMPORTER
+
+    #include <algorithm>
+    #include <cstring>
+    #include <filesystem>
+
+    #include "Core/FileSystem/FileSystem.h"
+    #include "Core/FileSystem/MappedFile.h"
+
+size_t MappedIOStream::Read(void *buffer, size_t size, size_t count)
+{
+    if (size == 0) {
+        return 0;
+    }
+    // whole elements only, like fread
+    size_t available = (file->getSize() - cursor) / size;
+    count            = std::min(count, available);
+    if (count > 0) {
+        std::memcpy(buffer, file->getData() + cursor, size * count);
+        cursor += size * count;
+    }
+    return count;
+}
+
+aiReturn MappedIOStream::Seek(size_t offset, aiOrigin origin)
+{
+    size_t target = 0;
+    switch (origin) {
+    case aiOrigin_SET:
+        target = offset;
+        break;
+    case aiOrigin_CUR:
+        target = cursor + offset;
+        break;
+    case aiOrigin_END:
+        if (offset > file->getSize()) {
+            return aiReturn_FAILURE;
+        }
+        target = file->getSize() - offset;
+        break;
+    default:
+        return aiReturn_FAILURE;
+    }
+    if (target > file->getSize()) {
+        return aiReturn_FAILURE;
+    }
+    cursor = target;
+    return aiReturn_SUCCESS;
+}
+
+size_t MappedIOStream::FileSize() const
+{
+    return file->getSize();
+}
+
+bool FileSystemIOSystem::Exists(const char *file) const
+{
+    return FileSystem::get()->isFileExists(file);
+}
+
+Assimp::IOStream *FileSystemIOSystem::Open(const char *file, const char *mode)
+{
+    if (std::strchr(mode, 'w') || std::strchr(mode, 'a') || std::strchr(mode, '+')) {
+        return nullptr;
+    }
+    // Assimp probes for optional sidecars, a missing one is not an error
+    if (!FileSystem::get()->isFileExists(file)) {
+        return nullptr;
+    }
+
+    auto mapped = FileSystem::get()->mapFile(file);
+    if (!mapped) {
+        return nullptr;
+    }
+    if (openedFiles) {
+        openedFiles->push_back(std::filesystem::path(file).lexically_normal().generic_string());
+    }
+    return new MappedIOStream(std::move(mapped));
+}
+
+#endif
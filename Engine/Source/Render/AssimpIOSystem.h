@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Render/ModelImporter.h"
+
+#if NE_WITH_ASSET_IMPORTER
+
+    #include <memory>
+    #include <string>
+    #include <vector>
+
+    #include <assimp/IOStream.hpp>
+    #include <assimp/IOSystem.hpp>
+
+class MappedFile;
+
+// Read-only Assimp stream over a mapped file, Assimp reads straight from the mapping instead of a copy
+class MappedIOStream : public Assimp::IOStream
+{
+    std::shared_ptr<const MappedFile> file;
+    std::size_t                       cursor = 0;
+
+  public:
+    explicit MappedIOStream(std::shared_ptr<const MappedFile> file) : file(std::move(file)) {}
+
+    size_t   Read(void *buffer, size_t size, size_t count) override;
+    size_t   Write(const void *buffer, size_t size, size_t count) override { return 0; }
+    aiReturn Seek(size_t offset, aiOrigin origin) override;
+    size_t   Tell() const override { return cursor; }
+    size_t   FileSize() const override;
+    void     Flush() override {}
+};
+
+// Serves the files Assimp opens through FileSystem: paths are relative to the project root like every other asset path,
+// so the sidecar files a model references (.mtl, .bin, textures, ...) resolve next to the model.
+// Write access is refused, importing never writes
+class FileSystemIOSystem : public Assimp::IOSystem
+{
+    std::vector<std::string> *openedFiles = nullptr;
+
+  public:
+    bool              Exists(const char *file) const override;
+    char              getOsSeparator() const override { return '/'; }
+    Assimp::IOStream *Open(const char *file, const char *mode = "rb") override;
+    void              Close(Assimp::IOStream *file) override { delete file; }
+
+    // every file opened from now on is appended to `files`, nullptr to stop
+    void recordOpenedFiles(std::vector<std::string> *files) { openedFiles = files; }
+};
+
+#endif
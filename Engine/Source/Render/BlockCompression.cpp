@@ -0,0 +1,449 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+
+#include "Core/ThreadPool.h"
+#include "Render/TextureFile.h"
+
+namespace BlockCompression
+{
+
+namespace
+{
+
+// RGBA as floats in 0..255
+struct Block
+{
+    float texels[16][4];
+};
+
+Block toBlock(const uint8_t *texels)
+{
+    Block block;
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            block.texels[i][c] = texels[i * 4 + c];
+        }
+    }
+    return block;
+}
+
+float distance(const float *a, const float *b, int channels)
+{
+    float sum = 0.0f;
+    for (int c = 0; c < channels; ++c) {
+        sum += (a[c] - b[c]) * (a[c] - b[c]);
+    }
+    return sum;
+}
+
+// the extremes of the texels projected on their principal axis (power iteration on the covariance)
+void fitEndpoints(const Block &block, int channels, float (&lo)[4], float (&hi)[4])
+{
+    float mean[4] = {};
+    for (const auto &texel : block.texels) {
+        for (int c = 0; c < channels; ++c) {
+            mean[c] += texel[c] / 16.0f;
+        }
+    }
+    float covariance[4][4] = {};
+    for (const auto &texel : block.texels) {
+        for (int i = 0; i < channels; ++i) {
+            for (int j = 0; j < channels; ++j) {
+                covariance[i][j] += (texel[i] - mean[i]) * (texel[j] - mean[j]);
+            }
+        }
+    }
+
+    float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {};
+        float length  = 0.0f;
+        for (int i = 0; i < channels; ++i) {
+            for (int j = 0; j < channels; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            length += next[i] * next[i];
+        }
+        if (length <= 1e-12f) {
+            break; // flat block, any axis works
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < channels; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float minT = 0.0f, maxT = 0.0f;
+    for (const auto &texel : block.texels) {
+        float t = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            t += (texel[c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    for (int c = 0; c < channels; ++c) {
+        lo[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+        hi[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+    }
+}
+
+// endpoints a (weight 0) and b (weight 1) minimizing the squared error of the texels at `weights`, false if singular
+bool refineEndpoints(const Block &block, int channels, const float (&weights)[16], float (&a)[4], float (&b)[4])
+{
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float w = weights[i];
+        aa += (1.0f - w) * (1.0f - w);
+        bb += w * w;
+        ab += w * (1.0f - w);
+        for (int c = 0; c < channels; ++c) {
+            ax[c] += (1.0f - w) * block.texels[i][c];
+            bx[c] += w * block.texels[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < channels; ++c) {
+        a[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        b[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+struct BitWriter
+{
+    uint8_t *out;
+    uint32_t bit = 0;
+
+    void write(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i, ++bit) {
+            out[bit >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (bit & 7));
+        }
+    }
+};
+
+// BC1 color
+
+uint16_t to565(const float (&color)[4])
+{
+    auto quantize = [](float value, int max) { return static_cast<uint16_t>(std::lround(value * max / 255.0f)); };
+    return static_cast<uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+}
+
+void from565(uint16_t packed, float (&color)[4])
+{
+    uint32_t r = packed >> 11 & 31, g = packed >> 5 & 63, b = packed & 31;
+    color[0]   = float(r << 3 | r >> 2);
+    color[1]   = float(g << 2 | g >> 4);
+    color[2]   = float(b << 3 | b >> 2);
+    color[3]   = 255.0f;
+}
+
+// writes the color block, returns its squared error
+float encodeColor(const Block &block, const float (&a)[4], const float (&b)[4], uint8_t *out)
+{
+    uint16_t c0 = to565(a), c1 = to565(b);
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    float palette[4][4];
+    from565(c0, palette[0]);
+    from565(c1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    uint32_t indices = 0;
+    float    error   = 0.0f;
+    // equal endpoints decode in the 3 color mode, where index 0 is still c0
+    for (int i = 0; i < 16 && c0 != c1; ++i) {
+        int   best     = 0;
+        float bestDist = distance(block.texels[i], palette[0], 3);
+        for (int p = 1; p < 4; ++p) {
+            float d = distance(block.texels[i], palette[p], 3);
+            if (d < bestDist) {
+                bestDist = d;
+                best     = p;
+            }
+        }
+        indices |= uint32_t(best) << (2 * i);
+        error += bestDist;
+    }
+    if (c0 == c1) {
+        for (int i = 0; i < 16; ++i) {
+            error += distance(block.texels[i], palette[0], 3);
+        }
+    }
+
+    std::memcpy(out, &c0, 2);
+    std::memcpy(out + 2, &c1, 2);
+    std::memcpy(out + 4, &indices, 4);
+    return error;
+}
+
+void encodeColorBlock(const Block &block, uint8_t *out)
+{
+    float lo[4], hi[4];
+    fitEndpoints(block, 3, lo, hi);
+    // inset by 1/16 of the range, the extremes are rarely worth an endpoint of their own
+    for (int c = 0; c < 3; ++c) {
+        float inset = (hi[c] - lo[c]) / 16.0f;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+
+    float error = encodeColor(block, hi, lo, out);
+
+    // refit on the chosen indices, kept if it is better
+    static constexpr float INDEX_WEIGHTS[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    uint32_t               indices;
+    std::memcpy(&indices, out + 4, 4);
+    float weights[16];
+    for (int i = 0; i < 16; ++i) {
+        weights[i] = INDEX_WEIGHTS[indices >> (2 * i) & 3];
+    }
+    float a[4], b[4];
+    from565(uint16_t(out[0] | out[1] << 8), a);
+    from565(uint16_t(out[2] | out[3] << 8), b);
+    if (refineEndpoints(block, 3, weights, a, b)) {
+        uint8_t refined[8] = {};
+        if (encodeColor(block, a, b, refined) < error) {
+            std::memcpy(out, refined, 8);
+        }
+    }
+}
+
+// BC4 single channel
+
+void encodeChannel(const Block &block, int channel, uint8_t *out)
+{
+    float minValue = 255.0f, maxValue = 0.0f;
+    for (const auto &texel : block.texels) {
+        minValue = std::min(minValue, texel[channel]);
+        maxValue = std::max(maxValue, texel[channel]);
+    }
+    uint8_t a0 = static_cast<uint8_t>(maxValue), a1 = static_cast<uint8_t>(minValue);
+
+    // a0 > a1: the 8 value mode, 6 values between the endpoints
+    float palette[8] = {float(a0), float(a1)};
+    for (int i = 2; i < 8; ++i) {
+        palette[i] = float(((8 - i) * a0 + (i - 1) * a1) / 7);
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 16 && a0 != a1; ++i) {
+        int   best     = 0;
+        float bestDist = std::abs(block.texels[i][channel] - palette[0]);
+        for (int p = 1; p < 8; ++p) {
+            float d = std::abs(block.texels[i][channel] - palette[p]);
+            if (d < bestDist) {
+                bestDist = d;
+                best     = p;
+            }
+        }
+        indices |= uint64_t(best) << (3 * i);
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+}
+
+// BC7 mode 6
+
+constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// 7 bits per channel plus a p-bit shared by the channels, the one closer to `endpoint`
+void quantizeEndpoint(const float (&endpoint)[4], uint32_t (&quantized)[4], uint32_t &pbit)
+{
+    float bestError = -1.0f;
+    for (uint32_t p = 0; p < 2; ++p) {
+        uint32_t candidate[4];
+        float    error = 0.0f;
+        for (int c = 0; c < 4; ++c) {
+            candidate[c] = static_cast<uint32_t>(std::clamp(std::lround((endpoint[c] - p) / 2.0f), 0l, 127l));
+            float value  = float(candidate[c] << 1 | p);
+            error += (value - endpoint[c]) * (value - endpoint[c]);
+        }
+        if (bestError < 0.0f || error < bestError) {
+            bestError = error;
+            pbit      = p;
+            std::copy(candidate, candidate + 4, quantized);
+        }
+    }
+}
+
+float encodeMode6(const Block &block, const float (&a)[4], const float (&b)[4], uint8_t *out, float (&weights)[16])
+{
+    uint32_t q[2][4], p[2];
+    quantizeEndpoint(a, q[0], p[0]);
+    quantizeEndpoint(b, q[1], p[1]);
+
+    float endpoints[2][4];
+    for (int e = 0; e < 2; ++e) {
+        for (int c = 0; c < 4; ++c) {
+            endpoints[e][c] = float(q[e][c] << 1 | p[e]);
+        }
+    }
+    float palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            int e0 = int(endpoints[0][c]), e1 = int(endpoints[1][c]);
+            palette[i][c] = float(((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6);
+        }
+    }
+
+    uint32_t indices[16];
+    float    error = 0.0f;
+    for (int i = 0; i < 16; ++i) {
+        uint32_t best     = 0;
+        float    bestDist = distance(block.texels[i], palette[0], 4);
+        for (uint32_t k = 1; k < 16; ++k) {
+            float d = distance(block.texels[i], palette[k], 4);
+            if (d < bestDist) {
+                bestDist = d;
+                best     = k;
+            }
+        }
+        indices[i] = best;
+        weights[i] = BC7_WEIGHTS[best] / 64.0f;
+        error += bestDist;
+    }
+
+    // the anchor (texel 0) index is stored without its top bit, swap the endpoints if it is set
+    if (indices[0] >= 8) {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for (uint32_t &index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer{out};
+    writer.write(1u << 6, 7); // mode 6
+    for (int c = 0; c < 4; ++c) {
+        writer.write(q[0][c], 7);
+        writer.write(q[1][c], 7);
+    }
+    writer.write(p[0], 1);
+    writer.write(p[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; ++i) {
+        writer.write(indices[i], 4);
+    }
+    return error;
+}
+
+} // namespace
+
+void encodeBC1(const uint8_t *texels, uint8_t *out)
+{
+    encodeColorBlock(toBlock(texels), out);
+}
+
+void encodeBC3(const uint8_t *texels, uint8_t *out)
+{
+    Block block = toBlock(texels);
+    encodeChannel(block, 3, out);
+    encodeColorBlock(block, out + 8);
+}
+
+void encodeBC5(const uint8_t *texels, uint8_t *out)
+{
+    Block block = toBlock(texels);
+    encodeChannel(block, 0, out);
+    encodeChannel(block, 1, out + 8);
+}
+
+void encodeBC7(const uint8_t *texels, uint8_t *out)
+{
+    Block block = toBlock(texels);
+    float lo[4], hi[4];
+    fitEndpoints(block, 4, lo, hi);
+
+    float weights[16];
+    float error = encodeMode6(block, lo, hi, out, weights);
+
+    float a[4] = {}, b[4] = {};
+    if (refineEndpoints(block, 4, weights, a, b)) {
+        uint8_t refined[16];
+        if (encodeMode6(block, a, b, refined, weights) < error) {
+            std::memcpy(out, refined, 16);
+        }
+    }
+}
+
+std::vector<uint8_t> encode(ETextureFormat format, const uint8_t *rgba, uint32_t width, uint32_t height, ThreadPool *pool)
+{
+    void (*encodeBlock)(const uint8_t *, uint8_t *) = nullptr;
+    switch (format) {
+    case ETextureFormat::BC1_RGBA_UNORM:
+        encodeBlock = encodeBC1;
+        break;
+    case ETextureFormat::BC3_RGBA_UNORM:
+        encodeBlock = encodeBC3;
+        break;
+    case ETextureFormat::BC5_RG_UNORM:
+        encodeBlock = encodeBC5;
+        break;
+    case ETextureFormat::BC7_RGBA_UNORM:
+        encodeBlock = encodeBC7;
+        break;
+    default:
+        return {};
+    }
+
+    const uint32_t       blockSize = TextureFile::blockSize(format);
+    const uint32_t       blocksX   = (width + 3) / 4;
+    const uint32_t       blocksY   = (height + 3) / 4;
+    std::vector<uint8_t> out(std::size_t(blocksX) * blocksY * blockSize);
+
+    auto encodeRows = [&](uint32_t firstRow, uint32_t lastRow) {
+        uint8_t texels[16 * 4];
+        for (uint32_t by = firstRow; by < lastRow; ++by) {
+            for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                for (uint32_t y = 0; y < 4; ++y) {
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        uint32_t sx = std::min(bx * 4 + x, width - 1);
+                        uint32_t sy = std::min(by * 4 + y, height - 1);
+                        std::memcpy(&texels[(y * 4 + x) * 4], &rgba[(std::size_t(sy) * width + sx) * 4], 4);
+                    }
+                }
+                encodeBlock(texels, &out[(std::size_t(by) * blocksX + bx) * blockSize]);
+            }
+        }
+    };
+
+    if (!pool || blocksY < 2) {
+        encodeRows(0, blocksY);
+        return out;
+    }
+
+    // a few chunks per worker, so uneven rows still balance
+    uint32_t                       chunks    = std::min<uint32_t>(blocksY, static_cast<uint32_t>(pool->size()) * 4);
+    uint32_t                       chunkRows = (blocksY + chunks - 1) / chunks;
+    std::vector<std::future<void>> futures;
+    for (uint32_t row = 0; row < blocksY; row += chunkRows) {
+        futures.push_back(pool->enqueue([&encodeRows, row, last = std::min(row + chunkRows, blocksY)]() { encodeRows(row, last); }));
+    }
+    for (auto &future : futures) {
+        future.get();
+    }
+    return out;
+}
+
+} // namespace BlockCompression
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Render/Texture.h"
+
+class ThreadPool;
+
+// CPU encoders of the BCn formats neon-cook writes, each 4x4 block of RGBA8 texels to 8 or 16 bytes:
+//   BC1  RGB, 4 bits per texel, opaque (always the 4 color mode)
+//   BC3  RGBA, 8 bits per texel, BC1 color + BC4 alpha
+//   BC5  RG, 8 bits per texel, two BC4 channels, for normal maps (z = sqrt(1 - x^2 - y^2) in the shader)
+//   BC7  RGBA, 8 bits per texel, mode 6 only: one subset, 7777 endpoints with a p-bit, 4 bit indices
+// The endpoints come from the principal axis of the block, refined once by least squares on the chosen indices.
+// This is a fast encoder, not an exhaustive one: BC7 never tries the partitioned modes
+namespace BlockCompression
+{
+
+// `texels` are the 16 RGBA8 texels of a block, row major. `out` receives TextureFile::blockSize(format) bytes
+void encodeBC1(const uint8_t *texels, uint8_t *out);
+void encodeBC3(const uint8_t *texels, uint8_t *out);
+void encodeBC5(const uint8_t *texels, uint8_t *out);
+void encodeBC7(const uint8_t *texels, uint8_t *out);
+
+// One level of `width` x `height` tightly packed RGBA8 texels, the partial blocks at the right and bottom edges
+// repeat the last texel. The block rows are spread over `pool` when given, which must not be the pool of the caller.
+// Empty if `format` is not one of the above
+std::vector<uint8_t> encode(ETextureFormat format, const uint8_t *rgba, uint32_t width, uint32_t height, ThreadPool *pool = nullptr);
+
+} // namespace BlockCompression
@@ -0,0 +1,170 @@
+#include "ClusterCulling.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define NE_CLUSTER_CULLING_SSE 1
+#else
+    #define NE_CLUSTER_CULLING_SSE 0
+#endif
+
+#include "Render/Model.h"
+
+namespace ClusterCulling
+{
+
+void ClusterSoA::build(std::span<const Meshlet> meshlets)
+{
+    count             = meshlets.size();
+    std::size_t lanes = (count + LANES - 1) / LANES * LANES;
+
+    // padding: a sphere with a huge negative radius is outside of every plane
+    centerX.assign(lanes, 0.0f);
+    centerY.assign(lanes, 0.0f);
+    centerZ.assign(lanes, 0.0f);
+    radius.assign(lanes, -std::numeric_limits<float>::max());
+    axisX.assign(lanes, 0.0f);
+    axisY.assign(lanes, 0.0f);
+    axisZ.assign(lanes, 0.0f);
+    cutoff.assign(lanes, 1.0f);
+    firstIndex.assign(lanes, 0);
+    indexCount.assign(lanes, 0);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const Meshlet &meshlet = meshlets[i];
+        centerX[i]             = meshlet.center.x;
+        centerY[i]             = meshlet.center.y;
+        centerZ[i]             = meshlet.center.z;
+        radius[i]              = meshlet.radius;
+        axisX[i]               = meshlet.coneAxis.x;
+        axisY[i]               = meshlet.coneAxis.y;
+        axisZ[i]               = meshlet.coneAxis.z;
+        cutoff[i]              = meshlet.coneCutoff;
+        firstIndex[i]          = meshlet.firstIndex;
+        indexCount[i]          = meshlet.indexCount;
+    }
+}
+
+View makeView(const glm::mat4 &viewProjection, const glm::mat4 &transform, const glm::vec3 &eye)
+{
+    // Gribb & Hartmann: the planes are sums of the rows of the object to clip matrix.
+    // The near plane is the -w <= z one, looser than the 0 <= z of SDL's clip space but never wrong
+    glm::mat4 m    = glm::transpose(viewProjection * transform);
+    View      view = {};
+    view.planes[0] = m[3] + m[0]; // left
+    view.planes[1] = m[3] - m[0]; // right
+    view.planes[2] = m[3] + m[1]; // bottom
+    view.planes[3] = m[3] - m[1]; // top
+    view.planes[4] = m[3] + m[2]; // near
+    view.planes[5] = m[3] - m[2]; // far
+    for (glm::vec4 &plane : view.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+    view.eye = glm::vec3(glm::inverse(transform) * glm::vec4(eye, 1.0f));
+    return view;
+}
+
+static void emit(std::vector<SDL_GPUIndexedIndirectDrawCommand> &out, std::size_t firstCommand, uint32_t firstIndex, uint32_t indexCount,
+                 int32_t vertexOffset)
+{
+    if (indexCount == 0) {
+        return;
+    }
+    // the meshlets are consecutive ranges, a visible run becomes one draw
+    if (out.size() > firstCommand) {
+        SDL_GPUIndexedIndirectDrawCommand &last = out.back();
+        if (last.first_index + last.num_indices == firstIndex) {
+            last.num_indices += indexCount;
+            return;
+        }
+    }
+    out.push_back(SDL_GPUIndexedIndirectDrawCommand{
+        .num_indices    = indexCount,
+        .num_instances  = 1,
+        .first_index    = firstIndex,
+        .vertex_offset  = vertexOffset,
+        .first_instance = 0,
+    });
+}
+
+Stats cull(const ClusterSoA &clusters, const View &view, std::vector<SDL_GPUIndexedIndirectDrawCommand> &out, int32_t vertexOffset)
+{
+    Stats       stats{.clusters = static_cast<uint32_t>(clusters.count)};
+    std::size_t firstCommand = out.size();
+
+#if NE_CLUSTER_CULLING_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 eyeX = _mm_set1_ps(view.eye.x);
+    const __m128 eyeY = _mm_set1_ps(view.eye.y);
+    const __m128 eyeZ = _mm_set1_ps(view.eye.z);
+
+    for (std::size_t i = 0; i < clusters.count; i += LANES) {
+        __m128 cx = _mm_loadu_ps(&clusters.centerX[i]);
+        __m128 cy = _mm_loadu_ps(&clusters.centerY[i]);
+        __m128 cz = _mm_loadu_ps(&clusters.centerZ[i]);
+        __m128 r  = _mm_loadu_ps(&clusters.radius[i]);
+
+        // inside or touching every plane
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4 &plane : view.planes) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y))),
+                                         _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            inside          = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, r), zero));
+        }
+
+        // every triangle faces away: dot(center - eye, axis) >= cutoff * |center - eye| + radius
+        __m128 dx      = _mm_sub_ps(cx, eyeX);
+        __m128 dy      = _mm_sub_ps(cy, eyeY);
+        __m128 dz      = _mm_sub_ps(cz, eyeZ);
+        __m128 along   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&clusters.axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&clusters.axisY[i]))),
+                                    _mm_mul_ps(dz, _mm_loadu_ps(&clusters.axisZ[i])));
+        __m128 length  = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 backing = _mm_cmpge_ps(along, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&clusters.cutoff[i]), length), r));
+
+        // padding lanes are outside, drop them from the counts
+        uint32_t lanes       = (1u << std::min<std::size_t>(LANES, clusters.count - i)) - 1;
+        uint32_t insideMask  = static_cast<uint32_t>(_mm_movemask_ps(inside)) & lanes;
+        uint32_t visibleMask = static_cast<uint32_t>(_mm_movemask_ps(_mm_andnot_ps(backing, inside))) & lanes;
+        stats.frustumCulled += std::popcount(lanes) - std::popcount(insideMask);
+        stats.backfaceCulled += std::popcount(insideMask) - std::popcount(visibleMask);
+
+        for (; visibleMask; visibleMask &= visibleMask - 1) {
+            std::size_t lane = i + std::countr_zero(visibleMask);
+            emit(out, firstCommand, clusters.firstIndex[lane], clusters.indexCount[lane], vertexOffset);
+        }
+    }
+#else
+    for (std::size_t i = 0; i < clusters.count; ++i) {
+        glm::vec3 center(clusters.centerX[i], clusters.centerY[i], clusters.centerZ[i]);
+        float     r = clusters.radius[i];
+
+        bool bInside = true;
+        for (const glm::vec4 &plane : view.planes) {
+            bInside = bInside && glm::dot(glm::vec3(plane), center) + plane.w + r >= 0.0f;
+        }
+        if (!bInside) {
+            ++stats.frustumCulled;
+            continue;
+        }
+
+        glm::vec3 toCenter = center - view.eye;
+        glm::vec3 axis(clusters.axisX[i], clusters.axisY[i], clusters.axisZ[i]);
+        if (glm::dot(toCenter, axis) >= clusters.cutoff[i] * glm::length(toCenter) + r) {
+            ++stats.backfaceCulled;
+            continue;
+        }
+        emit(out, firstCommand, clusters.firstIndex[i], clusters.indexCount[i], vertexOffset);
+    }
+#endif
+
+    stats.commands = static_cast<uint32_t>(out.size() - firstCommand);
+    return stats;
+}
+
+} // namespace ClusterCulling
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <SDL3/SDL_gpu.h>
+#include <glm/glm.hpp>
+
+struct Meshlet;
+
+// Per view CPU culling of meshlets (see MeshletBuilder) by frustum and normal cone, 4 clusters per SSE iteration.
+// The test runs in object space: the frustum planes come from viewProjection * transform and the eye is moved by
+// the inverse transform, so the cluster data is built once per mesh and never transformed.
+// The surviving ranges are emitted as indirect draws, adjacent ones merged:
+//
+//   ClusterCulling::ClusterSoA clusters(mesh.getMeshlets());                  // once per mesh
+//   auto view = ClusterCulling::makeView(camera.getViewProjectionMatrix(), model, camera.position);
+//   ClusterCulling::cull(clusters, view, drawList.getCommands());            // then drawList.upload/draw
+namespace ClusterCulling
+{
+
+inline constexpr std::size_t LANES = 4;
+
+// the Meshlet fields split per component, padded to a multiple of LANES with clusters that are always culled
+struct ClusterSoA
+{
+    std::vector<float>    centerX, centerY, centerZ, radius;
+    std::vector<float>    axisX, axisY, axisZ, cutoff;
+    std::vector<uint32_t> firstIndex, indexCount;
+    std::size_t           count = 0;
+
+    ClusterSoA() = default;
+    explicit ClusterSoA(std::span<const Meshlet> meshlets) { build(meshlets); }
+
+    void build(std::span<const Meshlet> meshlets);
+};
+
+struct View
+{
+    glm::vec4 planes[6]; // object space, normalized, inside where dot(plane.xyz, p) + plane.w >= 0
+    glm::vec3 eye;       // object space
+};
+
+View makeView(const glm::mat4 &viewProjection, const glm::mat4 &transform, const glm::vec3 &eye);
+
+struct Stats
+{
+    uint32_t clusters       = 0;
+    uint32_t frustumCulled  = 0;
+    uint32_t backfaceCulled = 0;
+    uint32_t commands       = 0; // appended
+};
+
+// Appends a draw of one instance per run of visible clusters to `out`
+Stats cull(const ClusterSoA &clusters, const View &view, std::vector<SDL_GPUIndexedIndirectDrawCommand> &out, int32_t vertexOffset = 0);
+
+} // namespace ClusterCulling
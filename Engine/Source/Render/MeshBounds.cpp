@@ -0,0 +1,144 @@
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define NE_MESH_BOUNDS_SSE 1
+#else
+    #define NE_MESH_BOUNDS_SSE 0
+#endif
+
+#include "Render/Model.h"
+
+namespace MeshBounds
+{
+
+#if NE_MESH_BOUNDS_SSE
+// the position and the first float after it (normal.x), the 4th lane is ignored
+static_assert(offsetof(Vertex, position) + 4 * sizeof(float) <= sizeof(Vertex));
+
+static __m128 loadPosition(const Vertex &vertex)
+{
+    return _mm_loadu_ps(&vertex.position.x);
+}
+#endif
+
+Bounds compute(std::span<const Vertex> vertices)
+{
+    Bounds bounds;
+    if (vertices.empty()) {
+        return bounds;
+    }
+
+#if NE_MESH_BOUNDS_SSE
+    __m128 min = loadPosition(vertices[0]);
+    __m128 max = min;
+    for (const Vertex &vertex : vertices.subspan(1)) {
+        __m128 position = loadPosition(vertex);
+        min             = _mm_min_ps(min, position);
+        max             = _mm_max_ps(max, position);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, min);
+    bounds.min = glm::vec3(lanes[0], lanes[1], lanes[2]);
+    _mm_store_ps(lanes, max);
+    bounds.max = glm::vec3(lanes[0], lanes[1], lanes[2]);
+
+    glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+    __m128    c      = _mm_setr_ps(center.x, center.y, center.z, 0.0f);
+    __m128    xyz    = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    __m128    radius = _mm_setzero_ps();
+    for (const Vertex &vertex : vertices) {
+        // squared distance, the horizontal sum ends up in every lane
+        __m128 d       = _mm_and_ps(_mm_sub_ps(loadPosition(vertex), c), xyz);
+        __m128 squared = _mm_mul_ps(d, d);
+        squared        = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+        squared        = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(1, 0, 3, 2)));
+        radius         = _mm_max_ss(radius, squared);
+    }
+    bounds.sphereCenter = center;
+    bounds.sphereRadius = std::sqrt(_mm_cvtss_f32(radius));
+#else
+    bounds.min = bounds.max = vertices[0].position;
+    for (const Vertex &vertex : vertices.subspan(1)) {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+
+    glm::vec3 center  = (bounds.min + bounds.max) * 0.5f;
+    float     squared = 0.0f;
+    for (const Vertex &vertex : vertices) {
+        glm::vec3 d = vertex.position - center;
+        squared     = std::max(squared, glm::dot(d, d));
+    }
+    bounds.sphereCenter = center;
+    bounds.sphereRadius = std::sqrt(squared);
+#endif
+    return bounds;
+}
+
+Bounds merge(const Bounds &a, const Bounds &b)
+{
+    Bounds bounds{.min = glm::min(a.min, b.min), .max = glm::max(a.max, b.max)};
+
+    // the sphere around both spheres, or one of them if it contains the other
+    glm::vec3 offset   = b.sphereCenter - a.sphereCenter;
+    float     distance = glm::length(offset);
+    if (distance + b.sphereRadius <= a.sphereRadius) {
+        bounds.sphereCenter = a.sphereCenter;
+        bounds.sphereRadius = a.sphereRadius;
+    }
+    else if (distance + a.sphereRadius <= b.sphereRadius) {
+        bounds.sphereCenter = b.sphereCenter;
+        bounds.sphereRadius = b.sphereRadius;
+    }
+    else {
+        bounds.sphereRadius = (distance + a.sphereRadius + b.sphereRadius) * 0.5f;
+        bounds.sphereCenter = a.sphereCenter + offset * ((bounds.sphereRadius - a.sphereRadius) / distance);
+    }
+
+    // far apart parts (a character and its weapon) are bounded tighter by the box
+    float boxRadius = glm::length(bounds.max - bounds.min) * 0.5f;
+    if (boxRadius < bounds.sphereRadius) {
+        bounds.sphereCenter = (bounds.min + bounds.max) * 0.5f;
+        bounds.sphereRadius = boxRadius;
+    }
+    return bounds;
+}
+
+Bounds merge(std::span<const Mesh> meshes)
+{
+    Bounds bounds;
+    bool   bFirst = true;
+    for (const Mesh &mesh : meshes) {
+        if (mesh.getVertices().empty()) {
+            continue;
+        }
+        bounds = bFirst ? mesh.bounds : merge(bounds, mesh.bounds);
+        bFirst = false;
+    }
+    return bounds;
+}
+
+Bounds transform(const Bounds &bounds, const glm::mat4 &matrix)
+{
+    Bounds result;
+    result.min = result.max = glm::vec3(matrix[3]);
+    for (int column = 0; column < 3; ++column) {
+        glm::vec3 axis = glm::vec3(matrix[column]);
+        glm::vec3 a    = axis * bounds.min[column];
+        glm::vec3 b    = axis * bounds.max[column];
+        result.min += glm::min(a, b);
+        result.max += glm::max(a, b);
+    }
+
+    float scale         = std::max({glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))});
+    result.sphereCenter = glm::vec3(matrix * glm::vec4(bounds.sphereCenter, 1.0f));
+    result.sphereRadius = bounds.sphereRadius * scale;
+    return result;
+}
+
+} // namespace MeshBounds
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <span>
+
+#include <glm/glm.hpp>
+
+struct Vertex;
+struct Mesh;
+struct Bounds;
+
+// Object space bounds computed once at import and cooked with the mesh (see Bounds), so culling, picking and
+// LOD selection never scan the vertices:
+//
+//   Bounds world = MeshBounds::transform(model->getBounds(), model->getTransform());
+namespace MeshBounds
+{
+
+// box and sphere of the positions, the box reduced 4 floats at a time. The sphere is centered on the box,
+// its radius the farthest vertex from there. All zero for no vertices
+Bounds compute(std::span<const Vertex> vertices);
+
+// Bounds of both. The sphere is the smaller of the one enclosing the two spheres and the one around the merged box
+Bounds merge(const Bounds &a, const Bounds &b);
+
+// the merged bounds of the meshes with vertices, the model bounds
+Bounds merge(std::span<const Mesh> meshes);
+
+// Box by Arvo's method (each output axis sums the min/max of the scaled input axes, no corner transforms),
+// sphere by its center and the largest axis scale. Exact for the box of a box, conservative for the rest
+Bounds transform(const Bounds &bounds, const glm::mat4 &matrix);
+
+} // namespace MeshBounds
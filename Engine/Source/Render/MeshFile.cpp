@@ -0,0 +1,311 @@
+#include "MeshFile.h"
+
+#include <cstring>
+#include <string>
+
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "Core/Log.h"
+#include "Render/Model.h"
+
+// the streams are the in-memory arrays, their layout is part of the format
+static_assert(sizeof(Vertex) == 48, "Vertex layout changed, bump MeshFile::VERSION");
+static_assert(sizeof(VertexCompression::PackedVertex) == 20, "PackedVertex layout changed, bump MeshFile::VERSION");
+static_assert(sizeof(MeshFile::Header) % 8 == 0 && sizeof(MeshFile::MeshRecord) % 8 == 0);
+
+namespace
+{
+
+uint64_t alignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void toFloats(const glm::vec3 &v, float (&out)[3])
+{
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+}
+
+glm::vec3 fromFloats(const float (&v)[3])
+{
+    return glm::vec3(v[0], v[1], v[2]);
+}
+
+// the Header (model) and MeshRecord bounds fields
+template <typename Record>
+void writeBounds(const Bounds &bounds, Record &record)
+{
+    toFloats(bounds.min, record.boundsMin);
+    toFloats(bounds.max, record.boundsMax);
+    record.boundsSphere[0] = bounds.sphereCenter.x;
+    record.boundsSphere[1] = bounds.sphereCenter.y;
+    record.boundsSphere[2] = bounds.sphereCenter.z;
+    record.boundsSphere[3] = bounds.sphereRadius;
+}
+
+template <typename Record>
+Bounds readBounds(const Record &record)
+{
+    return Bounds{
+        .min          = fromFloats(record.boundsMin),
+        .max          = fromFloats(record.boundsMax),
+        .sphereCenter = glm::vec3(record.boundsSphere[0], record.boundsSphere[1], record.boundsSphere[2]),
+        .sphereRadius = record.boundsSphere[3],
+    };
+}
+
+} // namespace
+
+void MeshFile::write(const Model &model, std::vector<uint8_t> &out)
+{
+    std::string stringTable;
+    auto        addString = [&stringTable](std::string_view str) {
+        StringRef ref{
+            .offset = static_cast<uint32_t>(stringTable.size()),
+            .size   = static_cast<uint32_t>(str.size()),
+        };
+        stringTable += str;
+        return ref;
+    };
+
+    const auto &meshes    = model.getMeshes();
+    const auto &materials = model.getMaterials();
+
+    std::vector<MeshRecord>     meshRecords(meshes.size());
+    std::vector<LodRecord>      lodRecords;
+    std::vector<MaterialRecord> materialRecords;
+
+    for (const auto &material : materials) {
+        materialRecords.push_back(MaterialRecord{
+            .name           = addString(material.name),
+            .diffuseTexture = addString(material.diffuseTexture),
+        });
+    }
+
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh &mesh   = meshes[i];
+        MeshRecord &record = meshRecords[i];
+
+        record               = {};
+        record.name          = addString(mesh.name);
+        record.materialIndex = mesh.materialIndex;
+        record.vertexCount   = static_cast<uint32_t>(mesh.getVertices().size());
+        record.indexCount    = static_cast<uint32_t>(mesh.getIndexCount());
+        record.indexSize     = mesh.getIndexElementSize();
+        record.meshletCount  = static_cast<uint32_t>(mesh.getMeshlets().size());
+        record.firstLod      = static_cast<uint32_t>(lodRecords.size());
+        writeBounds(mesh.bounds, record);
+        toFloats(mesh.packed.quantization.offset, record.quantizationOffset);
+        toFloats(mesh.packed.quantization.scale, record.quantizationScale);
+
+        if (mesh.lods.empty()) {
+            lodRecords.push_back(LodRecord{.firstIndex = 0, .indexCount = record.indexCount, .error = 0.0f});
+        }
+        for (const auto &lod : mesh.lods) {
+            lodRecords.push_back(LodRecord{.firstIndex = lod.firstIndex, .indexCount = lod.indexCount, .error = lod.error});
+        }
+        record.lodCount = static_cast<uint32_t>(lodRecords.size()) - record.firstLod;
+    }
+
+    // tables, then the strings, then the streams
+    Header header{
+        .magic         = MAGIC,
+        .version       = VERSION,
+        .meshCount     = static_cast<uint32_t>(meshRecords.size()),
+        .lodCount      = static_cast<uint32_t>(lodRecords.size()),
+        .materialCount = static_cast<uint32_t>(materialRecords.size()),
+    };
+    writeBounds(model.getBounds(), header);
+    uint64_t cursor       = sizeof(Header);
+    header.meshOffset     = static_cast<uint32_t>(cursor);
+    cursor                = alignUp(cursor + meshRecords.size() * sizeof(MeshRecord), 8);
+    header.lodOffset      = static_cast<uint32_t>(cursor);
+    cursor                = alignUp(cursor + lodRecords.size() * sizeof(LodRecord), 8);
+    header.materialOffset = static_cast<uint32_t>(cursor);
+    cursor                = alignUp(cursor + materialRecords.size() * sizeof(MaterialRecord), 8);
+    header.stringOffset   = static_cast<uint32_t>(cursor);
+    header.stringSize     = static_cast<uint32_t>(stringTable.size());
+    cursor += stringTable.size();
+
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh &mesh   = meshes[i];
+        MeshRecord &record = meshRecords[i];
+
+        cursor              = alignUp(cursor, STREAM_ALIGNMENT);
+        record.vertexOffset = cursor;
+        cursor += uint64_t(record.vertexCount) * sizeof(Vertex);
+
+        cursor             = alignUp(cursor, STREAM_ALIGNMENT);
+        record.indexOffset = cursor;
+        cursor += uint64_t(record.indexCount) * record.indexSize;
+
+        if (record.vertexCount > 0 && mesh.getPackedVertices().size() == record.vertexCount) {
+            cursor              = alignUp(cursor, STREAM_ALIGNMENT);
+            record.packedOffset = cursor;
+            cursor += uint64_t(record.vertexCount) * sizeof(VertexCompression::PackedVertex);
+        }
+
+        if (record.meshletCount > 0) {
+            cursor               = alignUp(cursor, STREAM_ALIGNMENT);
+            record.meshletOffset = cursor;
+            cursor += uint64_t(record.meshletCount) * sizeof(Meshlet);
+        }
+    }
+    header.fileSize = cursor;
+
+    out.assign(cursor, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    // an empty vector may have no storage at all, memcpy wants a valid pointer even for 0 bytes
+    auto copyTable = [&out](uint64_t offset, const auto &table) {
+        if (!table.empty()) {
+            std::memcpy(out.data() + offset, table.data(), table.size() * sizeof(table[0]));
+        }
+    };
+    copyTable(header.meshOffset, meshRecords);
+    copyTable(header.lodOffset, lodRecords);
+    copyTable(header.materialOffset, materialRecords);
+    std::memcpy(out.data() + header.stringOffset, stringTable.data(), stringTable.size());
+
+    for (std::size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh       &mesh   = meshes[i];
+        const MeshRecord &record = meshRecords[i];
+        if (record.vertexCount > 0) {
+            std::memcpy(out.data() + record.vertexOffset, mesh.getVertices().data(), record.vertexCount * sizeof(Vertex));
+        }
+        if (record.indexCount > 0) {
+            std::memcpy(out.data() + record.indexOffset, mesh.getIndexBytes().data(), mesh.getIndexBytes().size());
+        }
+        if (record.packedOffset != 0) {
+            std::memcpy(out.data() + record.packedOffset, mesh.getPackedVertices().data(), record.vertexCount * sizeof(VertexCompression::PackedVertex));
+        }
+        if (record.meshletOffset != 0) {
+            std::memcpy(out.data() + record.meshletOffset, mesh.getMeshlets().data(), record.meshletCount * sizeof(Meshlet));
+        }
+    }
+}
+
+std::shared_ptr<Model> MeshFile::load(std::string_view path)
+{
+    auto file = FileSystem::get()->mapFile(path);
+    if (!file) {
+        return nullptr;
+    }
+    return load(std::move(file), path);
+}
+
+std::shared_ptr<Model> MeshFile::load(std::shared_ptr<const MappedFile> file, std::string_view debugName)
+{
+    const uint8_t *data     = file->getData();
+    const uint64_t fileSize = file->getSize();
+
+    Header header;
+    if (fileSize < sizeof(Header)) {
+        NE_CORE_ERROR("Invalid mesh file {}: too small", debugName);
+        return nullptr;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION || header.fileSize != fileSize) {
+        NE_CORE_ERROR("Invalid mesh file {}: magic {:#x}, version {}, size {} of {}", debugName, header.magic, header.version, header.fileSize, fileSize);
+        return nullptr;
+    }
+
+    // Only the tables are checked, the streams are not touched until they are uploaded
+    auto inRange = [fileSize](uint64_t offset, uint64_t size, uint64_t alignment) {
+        return offset % alignment == 0 && offset <= fileSize && size <= fileSize - offset;
+    };
+    if (!inRange(header.meshOffset, uint64_t(header.meshCount) * sizeof(MeshRecord), alignof(MeshRecord)) ||
+        !inRange(header.lodOffset, uint64_t(header.lodCount) * sizeof(LodRecord), alignof(LodRecord)) ||
+        !inRange(header.materialOffset, uint64_t(header.materialCount) * sizeof(MaterialRecord), alignof(MaterialRecord)) ||
+        !inRange(header.stringOffset, header.stringSize, 1))
+    {
+        NE_CORE_ERROR("Corrupted mesh file {}: tables out of range", debugName);
+        return nullptr;
+    }
+
+    const auto *meshRecords     = reinterpret_cast<const MeshRecord *>(data + header.meshOffset);
+    const auto *lodRecords      = reinterpret_cast<const LodRecord *>(data + header.lodOffset);
+    const auto *materialRecords = reinterpret_cast<const MaterialRecord *>(data + header.materialOffset);
+    const char *strings         = reinterpret_cast<const char *>(data + header.stringOffset);
+
+    bool bOk       = true;
+    auto getString = [&](const StringRef &ref) -> std::string {
+        if (uint64_t(ref.offset) + ref.size > header.stringSize) {
+            bOk = false;
+            return {};
+        }
+        return std::string(strings + ref.offset, ref.size);
+    };
+
+    auto model = std::make_shared<Model>();
+    for (uint32_t i = 0; i < header.materialCount; ++i) {
+        model->getMaterials().push_back(Material{
+            .name           = getString(materialRecords[i].name),
+            .diffuseTexture = getString(materialRecords[i].diffuseTexture),
+        });
+    }
+
+    auto &meshes = model->getMeshes();
+    meshes.resize(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount && bOk; ++i) {
+        const MeshRecord &record = meshRecords[i];
+        Mesh             &mesh   = meshes[i];
+
+        bOk = inRange(record.vertexOffset, uint64_t(record.vertexCount) * sizeof(Vertex), STREAM_ALIGNMENT) &&
+              (record.indexSize == sizeof(uint16_t) || record.indexSize == sizeof(uint32_t)) &&
+              inRange(record.indexOffset, uint64_t(record.indexCount) * record.indexSize, STREAM_ALIGNMENT) &&
+              (record.packedOffset == 0 ||
+               inRange(record.packedOffset, uint64_t(record.vertexCount) * sizeof(VertexCompression::PackedVertex), STREAM_ALIGNMENT)) &&
+              (record.meshletOffset == 0 || inRange(record.meshletOffset, uint64_t(record.meshletCount) * sizeof(Meshlet), STREAM_ALIGNMENT)) &&
+              uint64_t(record.firstLod) + record.lodCount <= header.lodCount &&
+              (header.materialCount == 0 || record.materialIndex < header.materialCount);
+        if (!bOk) {
+            break;
+        }
+
+        mesh.name           = getString(record.name);
+        mesh.materialIndex  = record.materialIndex;
+        mesh.bounds         = readBounds(record);
+        mesh.mappedVertices = {reinterpret_cast<const Vertex *>(data + record.vertexOffset), record.vertexCount};
+        if (record.indexSize == sizeof(uint16_t)) {
+            mesh.mappedIndices16 = {reinterpret_cast<const uint16_t *>(data + record.indexOffset), record.indexCount};
+        }
+        else {
+            mesh.mappedIndices = {reinterpret_cast<const uint32_t *>(data + record.indexOffset), record.indexCount};
+        }
+        if (record.packedOffset != 0) {
+            mesh.mappedPackedVertices       = {reinterpret_cast<const VertexCompression::PackedVertex *>(data + record.packedOffset), record.vertexCount};
+            mesh.packed.quantization.offset = fromFloats(record.quantizationOffset);
+            mesh.packed.quantization.scale  = fromFloats(record.quantizationScale);
+        }
+        if (record.meshletOffset != 0) {
+            mesh.mappedMeshlets = {reinterpret_cast<const Meshlet *>(data + record.meshletOffset), record.meshletCount};
+            for (const Meshlet &meshlet : mesh.mappedMeshlets) {
+                if (uint64_t(meshlet.firstIndex) + meshlet.indexCount > record.indexCount) {
+                    bOk = false;
+                    break;
+                }
+            }
+        }
+
+        for (uint32_t l = 0; l < record.lodCount; ++l) {
+            const LodRecord &lod = lodRecords[record.firstLod + l];
+            if (uint64_t(lod.firstIndex) + lod.indexCount > record.indexCount) {
+                bOk = false;
+                break;
+            }
+            mesh.lods.push_back(MeshLod{.firstIndex = lod.firstIndex, .indexCount = lod.indexCount, .error = lod.error});
+        }
+    }
+
+    if (!bOk) {
+        NE_CORE_ERROR("Corrupted mesh file {}: mesh records out of range", debugName);
+        return nullptr;
+    }
+
+    model->setBounds(readBounds(header));
+    model->setMappedFile(std::move(file));
+    model->setIsLoaded(true);
+    return model;
+}
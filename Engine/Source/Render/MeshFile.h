@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+class Model;
+class MappedFile;
+
+// The cooked mesh format (.nmesh): the vertex and index streams exactly as they are uploaded, loading is mapping
+// the file and validating the tables, the meshes of the returned Model point into the mapping (see Mesh::getVertices).
+//
+// Layout (all offsets from the start of the file):
+//   Header                            magic "NMSH", version, model bounds, counts and offsets of the tables below
+//   MeshRecord[meshCount]             name, material, counts, bounds, quantization, LOD range, stream offsets
+//   LodRecord[lodCount]               index ranges of every mesh, LOD 0 first
+//   MaterialRecord[materialCount]     name, diffuse texture path
+//   strings                           referenced by offset/size from the records, not null terminated
+//   streams                           per mesh: Vertex[], uint16_t or uint32_t indices[], PackedVertex[] if packed, Meshlet[],
+//                                     each 16 byte aligned so it can be handed to the upload as is
+class MeshFile
+{
+  public:
+    static constexpr uint32_t         MAGIC     = 0x48534D4E; // "NMSH"
+    static constexpr uint32_t         VERSION   = 4;
+    static constexpr std::string_view EXTENSION = ".nmesh";
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t meshCount;
+        uint32_t lodCount;
+        uint32_t materialCount;
+        uint32_t meshOffset;
+        uint32_t lodOffset;
+        uint32_t materialOffset;
+        uint32_t stringOffset;
+        uint32_t stringSize;
+        float    boundsMin[3];
+        float    boundsMax[3];
+        float    boundsSphere[4]; // center, radius
+        uint64_t fileSize;
+    };
+
+    struct StringRef
+    {
+        uint32_t offset; // from the start of the string table
+        uint32_t size;
+    };
+
+    struct MeshRecord
+    {
+        StringRef name;
+        uint32_t  materialIndex;
+        uint32_t  vertexCount;
+        uint32_t  indexCount;
+        uint32_t  firstLod;
+        uint32_t  lodCount;
+        uint32_t  meshletCount;
+        uint32_t  indexSize; // 2 or 4 bytes
+        uint32_t  padding;
+        float     boundsMin[3];
+        float     boundsMax[3];
+        float     boundsSphere[4]; // center, radius
+        float     quantizationOffset[3];
+        float     quantizationScale[3];
+        uint64_t  vertexOffset;
+        uint64_t  indexOffset;
+        uint64_t  packedOffset;  // 0 if the mesh has no packed vertices
+        uint64_t  meshletOffset; // 0 if the mesh has no meshlets
+    };
+
+    struct LodRecord
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        float    error;
+    };
+
+    struct MaterialRecord
+    {
+        StringRef name;
+        StringRef diffuseTexture;
+    };
+
+    static constexpr uint32_t STREAM_ALIGNMENT = 16;
+
+    static void write(const Model &model, std::vector<uint8_t> &out);
+
+    // `path` is relative to the project root, nullptr if it is missing or invalid
+    static std::shared_ptr<Model> load(std::string_view path);
+    static std::shared_ptr<Model> load(std::shared_ptr<const MappedFile> file, std::string_view debugName);
+};
@@ -0,0 +1,51 @@
+#include "MeshLodSelection.h"
+
+#include <algorithm>
+
+#include "Core/EditorCamera.h"
+#include "Render/MeshBounds.h"
+#include "Render/Model.h"
+
+namespace MeshLodSelection
+{
+
+float pixelsPerUnit(const EditorCamera &camera, const glm::vec3 &center, float radius, float viewportHeight)
+{
+    // projection[1][1] is 1 / tan(fov / 2) for a perspective projection and 2 / height for an orthographic one
+    float projectedScale = camera.projectionMatrix[1][1] * 0.5f * viewportHeight;
+    if (camera.projectionType == EditorCamera::Orthographic) {
+        return projectedScale;
+    }
+
+    float distance = glm::length(center - camera.position) - radius;
+    return projectedScale / std::max(distance, camera.nearClip);
+}
+
+uint32_t selectLod(const Mesh &mesh, const glm::mat4 &transform, const EditorCamera &camera, float viewportHeight, uint32_t currentLod,
+                   const Settings &settings)
+{
+    if (mesh.lods.size() <= 1) {
+        return 0;
+    }
+
+    // the errors and bounds are in object space, the largest axis scale bounds how much the transform grows them
+    float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))});
+
+    Bounds bounds = MeshBounds::transform(mesh.bounds, transform);
+    float  pixels = pixelsPerUnit(camera, bounds.sphereCenter, bounds.sphereRadius, viewportHeight) * scale;
+
+    auto lodPixels = [&](uint32_t lod) { return mesh.lods[lod].error * pixels; };
+
+    uint32_t lod = std::min(currentLod, static_cast<uint32_t>(mesh.lods.size()) - 1);
+    // finer while the current LOD is visibly off
+    while (lod > 0 && lodPixels(lod) > settings.pixelError) {
+        --lod;
+    }
+    // coarser only with some margin under the threshold
+    while (lod + 1 < mesh.lods.size() && lodPixels(lod + 1) <= settings.pixelError * (1.0f - settings.hysteresis)) {
+        ++lod;
+    }
+    return lod;
+}
+
+} // namespace MeshLodSelection
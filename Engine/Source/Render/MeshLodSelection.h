@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+struct EditorCamera;
+struct Mesh;
+
+// Per instance LOD choice from the projected size of the simplification error (see MeshSimplifier::generateLods):
+// the coarsest LOD whose error covers at most `pixelError` pixels. Keep the returned LOD per instance and pass it
+// back next frame, a coarser LOD is only taken once its error is `hysteresis` below the threshold, so an instance
+// sitting at a switch distance does not flicker between two LODs
+namespace MeshLodSelection
+{
+
+struct Settings
+{
+    float pixelError = 1.0f;
+    float hysteresis = 0.25f; // fraction of `pixelError`
+};
+
+// screen pixels covered by one world unit at the nearest point of the sphere, for the camera's projection
+float pixelsPerUnit(const EditorCamera &camera, const glm::vec3 &center, float radius, float viewportHeight);
+
+uint32_t selectLod(const Mesh &mesh, const glm::mat4 &transform, const EditorCamera &camera, float viewportHeight, uint32_t currentLod,
+                   const Settings &settings = {});
+
+} // namespace MeshLodSelection
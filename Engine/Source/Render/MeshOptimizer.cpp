@@ -0,0 +1,301 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Core/Log.h"
+#include "Render/Model.h"
+
+namespace MeshOptimizer
+{
+
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// FIFO cache simulation with timestamps: a vertex is cached while fewer than `cacheSize` misses happened since its own,
+// bumping the clock by `cacheSize + 1` flushes the whole cache
+struct CacheSimulation
+{
+    std::vector<uint32_t> stamps;
+    uint32_t              cacheSize;
+    uint32_t              time;
+
+    CacheSimulation(std::size_t vertexCount, uint32_t cacheSize)
+        : stamps(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1) {}
+
+    bool isCached(uint32_t vertex) const { return time - stamps[vertex] <= cacheSize; }
+
+    // true on a miss
+    bool access(uint32_t vertex)
+    {
+        if (isCached(vertex)) {
+            return false;
+        }
+        stamps[vertex] = time++;
+        return true;
+    }
+
+    void flush() { time += cacheSize + 1; }
+};
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, std::size_t vertexCount, uint32_t cacheSize)
+{
+    if (indices.size() < 3 || vertexCount == 0) {
+        return {};
+    }
+
+    CacheSimulation cache(vertexCount, cacheSize);
+    std::size_t     misses = 0;
+    for (uint32_t index : indices) {
+        misses += cache.access(index) ? 1 : 0;
+    }
+
+    return VertexCacheStats{
+        .acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3),
+        .atvr = static_cast<float>(misses) / static_cast<float>(vertexCount),
+    };
+}
+
+std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices, std::size_t vertexCount, std::vector<uint32_t> &out,
+                                          uint32_t cacheSize)
+{
+    out.clear();
+    std::vector<uint32_t> clusters;
+
+    std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return clusters;
+    }
+    out.reserve(triangleCount * 3);
+
+    // vertex -> triangle adjacency, `liveTriangles` counts the ones not emitted yet
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        ++liveTriangles[indices[i]];
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    CacheSimulation       cache(vertexCount, cacheSize);
+    std::vector<uint8_t>  emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds; // recently used vertices, to restart near the cache when a fan runs out
+    std::vector<uint32_t> candidates;
+    deadEnds.reserve(triangleCount * 3);
+    std::size_t scanCursor = 0;
+
+    auto skipDeadEnd = [&]() -> uint32_t {
+        while (!deadEnds.empty()) {
+            uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        for (; scanCursor < vertexCount; ++scanCursor) {
+            if (liveTriangles[scanCursor] > 0) {
+                return static_cast<uint32_t>(scanCursor);
+            }
+        }
+        return INVALID_INDEX;
+    };
+
+    uint32_t fanning = skipDeadEnd();
+    clusters.push_back(0);
+    while (fanning != INVALID_INDEX) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; ++a) {
+            uint32_t triangle = adjacency[a];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = 1;
+            for (std::size_t c = 0; c < 3; ++c) {
+                uint32_t vertex = indices[triangle * 3 + c];
+                out.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                cache.access(vertex);
+            }
+        }
+
+        // next fan: the oldest candidate that stays in the cache while its own fan is emitted
+        uint32_t next         = INVALID_INDEX;
+        int64_t  bestPriority = 0; // none in the cache: fall back to the dead-end stack
+        for (uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t age      = static_cast<int64_t>(cache.time - cache.stamps[vertex]);
+            int64_t priority = age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= cacheSize ? age : 0;
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next         = vertex;
+            }
+        }
+
+        if (next == INVALID_INDEX) {
+            next = skipDeadEnd();
+            // a jump to an unconnected vertex, the overdraw pass may reorder from here
+            uint32_t emittedTriangles = static_cast<uint32_t>(out.size() / 3);
+            if (next != INVALID_INDEX && emittedTriangles != clusters.back()) {
+                clusters.push_back(emittedTriangles);
+            }
+        }
+        fanning = next;
+    }
+
+    return clusters;
+}
+
+void optimizeOverdraw(std::vector<uint32_t> &indices, std::span<const Vertex> vertices, std::span<const uint32_t> clusters,
+                      float threshold, uint32_t cacheSize)
+{
+    std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || clusters.empty()) {
+        return;
+    }
+
+    // split the clusters where the cache has warmed up enough, each piece keeps most of the cluster's locality
+    std::vector<uint32_t> pieces;
+    CacheSimulation       cache(vertices.size(), cacheSize);
+    for (std::size_t c = 0; c < clusters.size(); ++c) {
+        std::size_t begin = clusters[c];
+        std::size_t end   = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        cache.flush();
+        std::size_t clusterMisses = 0;
+        for (std::size_t i = begin * 3; i < end * 3; ++i) {
+            clusterMisses += cache.access(indices[i]) ? 1 : 0;
+        }
+        float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        pieces.push_back(static_cast<uint32_t>(begin));
+        cache.flush();
+        std::size_t misses = 0, triangles = 0;
+        for (std::size_t t = begin; t < end; ++t) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                misses += cache.access(indices[t * 3 + k]) ? 1 : 0;
+            }
+            ++triangles;
+            if (t + 1 < end && static_cast<float>(misses) / static_cast<float>(triangles) <= threshold * clusterAcmr) {
+                pieces.push_back(static_cast<uint32_t>(t + 1));
+                cache.flush();
+                misses    = 0;
+                triangles = 0;
+            }
+        }
+    }
+
+    struct Piece
+    {
+        uint32_t  begin;
+        uint32_t  end;
+        glm::vec3 centroid;
+        glm::vec3 normal; // area weighted
+        float     sortKey;
+    };
+    std::vector<Piece> sorted(pieces.size());
+
+    glm::vec3 meshCentroid(0.0f);
+    float     meshArea = 0.0f;
+    for (std::size_t p = 0; p < pieces.size(); ++p) {
+        Piece &piece = sorted[p];
+        piece.begin  = pieces[p];
+        piece.end    = p + 1 < pieces.size() ? pieces[p + 1] : static_cast<uint32_t>(triangleCount);
+
+        glm::vec3 centroid(0.0f), plainCentroid(0.0f), normal(0.0f);
+        float     area = 0.0f;
+        for (uint32_t t = piece.begin; t < piece.end; ++t) {
+            const glm::vec3 &a = vertices[indices[t * 3 + 0]].position;
+            const glm::vec3 &b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3 &c = vertices[indices[t * 3 + 2]].position;
+
+            glm::vec3 cross       = glm::cross(b - a, c - a);
+            float     doubleArea  = glm::length(cross);
+            glm::vec3 triangleMid = (a + b + c) / 3.0f;
+            centroid += triangleMid * doubleArea;
+            plainCentroid += triangleMid;
+            normal += cross;
+            area += doubleArea;
+        }
+        piece.centroid = area > 0.0f ? centroid / area : plainCentroid / static_cast<float>(piece.end - piece.begin);
+        piece.normal   = normal;
+
+        meshCentroid += piece.centroid * area;
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    // outward facing pieces first, they are the likeliest to occlude the rest
+    for (Piece &piece : sorted) {
+        float length  = glm::length(piece.normal);
+        piece.sortKey = length > 0.0f ? glm::dot(piece.centroid - meshCentroid, piece.normal / length) : 0.0f;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Piece &a, const Piece &b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> reordered;
+    reordered.reserve(triangleCount * 3);
+    for (const Piece &piece : sorted) {
+        reordered.insert(reordered.end(), indices.begin() + piece.begin * 3, indices.begin() + piece.end * 3);
+    }
+    indices.swap(reordered);
+}
+
+std::size_t optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    uint32_t              nextVertex = 0;
+    for (uint32_t &index : indices) {
+        if (remap[index] == INVALID_INDEX) {
+            remap[index] = nextVertex++;
+        }
+        index = remap[index];
+    }
+
+    std::vector<Vertex> reordered(nextVertex);
+    for (std::size_t v = 0; v < vertices.size(); ++v) {
+        if (remap[v] != INVALID_INDEX) {
+            reordered[remap[v]] = vertices[v];
+        }
+    }
+    vertices.swap(reordered);
+    return vertices.size();
+}
+
+Report optimize(Mesh &mesh)
+{
+    Report report;
+    if (mesh.vertices.empty() || mesh.indices.empty() || mesh.indices.size() % 3 != 0) {
+        return report;
+    }
+    if (std::any_of(mesh.indices.begin(), mesh.indices.end(), [&](uint32_t index) { return index >= mesh.vertices.size(); })) {
+        NE_CORE_WARN("MeshOptimizer: {} has out of range indices, left as is", mesh.name);
+        return report;
+    }
+
+    report.before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+    std::vector<uint32_t> reordered;
+    std::vector<uint32_t> clusters = optimizeVertexCache(mesh.indices, mesh.vertices.size(), reordered);
+    optimizeOverdraw(reordered, mesh.vertices, clusters);
+    mesh.indices.swap(reordered);
+    optimizeVertexFetch(mesh.vertices, mesh.indices);
+
+    report.after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    return report;
+}
+
+} // namespace MeshOptimizer
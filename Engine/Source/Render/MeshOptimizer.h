@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct Vertex;
+struct Mesh;
+
+// Index and vertex reordering run on triangle lists at import, so the cooked data is already in draw order:
+//   optimizeVertexCache   Tipsify (Sander et al. 2007), linear time post-transform cache reordering
+//   optimizeOverdraw      sorts the Tipsify clusters so outward facing ones draw first, keeping most of the cache gain
+//   optimizeVertexFetch   renumbers the vertices in first use order so the fetches walk the buffer linearly
+// The statistics simulate a FIFO post-transform cache, which is what the hardware that still has one uses
+namespace MeshOptimizer
+{
+
+inline constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    float acmr = 0.0f; // transformed vertices per triangle, 0.5 is the ideal for a regular grid, 3 is the worst
+    float atvr = 0.0f; // transformed vertices per vertex, 1 is the ideal
+};
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, std::size_t vertexCount, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+// Writes the reordered triangles of `indices` to `out` (not in place) and returns the first triangle of each cluster,
+// a cluster ends where Tipsify had to jump to an unconnected vertex
+std::vector<uint32_t> optimizeVertexCache(std::span<const uint32_t> indices, std::size_t vertexCount, std::vector<uint32_t> &out,
+                                          uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+// Reorders the clusters of a vertex cache optimized `indices` in place. The clusters are split further where
+// their running ACMR falls under `threshold` times their own, so a higher threshold trades cache hits for less overdraw
+void optimizeOverdraw(std::vector<uint32_t> &indices, std::span<const Vertex> vertices, std::span<const uint32_t> clusters,
+                      float threshold = 1.05f, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+// Reorders `vertices` by first use in `indices` and rewrites the indices, unreferenced vertices are dropped.
+// Returns the new vertex count
+std::size_t optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+struct Report
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// all of the above on `mesh.vertices` and `mesh.indices`, run before packing and building the LODs.
+// Meshes that are not triangle lists are left alone
+Report optimize(Mesh &mesh);
+
+} // namespace MeshOptimizer
@@ -0,0 +1,384 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Core/Hash.h"
+#include "Render/MeshOptimizer.h"
+#include "Render/Model.h"
+
+namespace MeshSimplifier
+{
+
+// weight of the squared attribute differences against the squared distances, positions are scaled to a unit extent
+static constexpr float ATTRIBUTE_WEIGHT = 0.01f;
+// weight of the border edge planes against the triangle planes
+static constexpr float BORDER_WEIGHT = 10.0f;
+// a triangle whose normal turns further than ~75 degrees blocks the collapse
+static constexpr float MIN_NORMAL_DOT = 0.25f;
+// levels smaller than this are not worth a draw range
+static constexpr std::size_t MIN_LOD_INDICES = 3 * 16;
+// a level keeping more than this of the previous one means the mesh stopped simplifying
+static constexpr float MIN_LOD_REDUCTION = 0.85f;
+
+struct Quadric
+{
+    // symmetric 3x3 `a`, `b` and `c` of  p^T a p + 2 b^T p + c, `weight` is the summed area for normalization
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c      = 0;
+    double weight = 0;
+
+    static Quadric fromPlane(const glm::vec3 &normal, float distance, float weight)
+    {
+        double nx = normal.x, ny = normal.y, nz = normal.z, d = distance;
+        return Quadric{
+            .a00    = weight * nx * nx,
+            .a01    = weight * nx * ny,
+            .a02    = weight * nx * nz,
+            .a11    = weight * ny * ny,
+            .a12    = weight * ny * nz,
+            .a22    = weight * nz * nz,
+            .b0     = weight * nx * d,
+            .b1     = weight * ny * d,
+            .b2     = weight * nz * d,
+            .c      = weight * d * d,
+            .weight = weight,
+        };
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        a00 += other.a00, a01 += other.a01, a02 += other.a02, a11 += other.a11, a12 += other.a12, a22 += other.a22;
+        b0 += other.b0, b1 += other.b1, b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    // weighted mean squared distance of `p` to the planes
+    double error(const glm::vec3 &p) const
+    {
+        if (weight <= 0) {
+            return 0;
+        }
+        double x = p.x, y = p.y, z = p.z;
+        double e = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2 * (b0 * x + b1 * y + b2 * z) +
+                   c;
+        return std::max(e, 0.0) / weight;
+    }
+};
+
+static uint64_t edgeKey(uint32_t from, uint32_t to)
+{
+    return (uint64_t(from) << 32) | to;
+}
+
+static float attributeDistance(const Vertex &a, const Vertex &b)
+{
+    glm::vec3 normal   = a.normal - b.normal;
+    glm::vec2 texCoord = a.texCoord - b.texCoord;
+    glm::vec4 color    = a.color - b.color;
+    return glm::dot(normal, normal) + glm::dot(texCoord, texCoord) + glm::dot(color, color);
+}
+
+std::vector<uint32_t> simplify(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::size_t targetIndexCount,
+                               float targetError, float *outError)
+{
+    std::size_t vertexCount = vertices.size();
+
+    // identical vertices collapse as one, vertices sharing only the position are a seam
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<uint8_t>  seam(vertexCount, 0);
+    {
+        auto vertexHash = [&](uint32_t v) { return Hash::fnv1a64(&vertices[v], sizeof(Vertex)); };
+        auto vertexEq   = [&](uint32_t a, uint32_t b) { return std::memcmp(&vertices[a], &vertices[b], sizeof(Vertex)) == 0; };
+        auto positionHash = [&](uint32_t v) { return Hash::fnv1a64(&vertices[v].position, sizeof(glm::vec3)); };
+        auto positionEq   = [&](uint32_t a, uint32_t b) { return vertices[a].position == vertices[b].position; };
+
+        std::unordered_set<uint32_t, decltype(vertexHash), decltype(vertexEq)>     unique(vertexCount, vertexHash, vertexEq);
+        std::unordered_map<uint32_t, uint32_t, decltype(positionHash), decltype(positionEq)> positions(vertexCount, positionHash, positionEq);
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            canonical[v] = *unique.insert(v).first;
+            if (canonical[v] == v) {
+                ++positions[v];
+            }
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v) {
+            seam[v] = positions.find(v)->second > 1 ? 1 : 0;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t a = canonical[indices[i + 0]], b = canonical[indices[i + 1]], c = canonical[indices[i + 2]];
+        if (a != b && b != c && c != a) {
+            result.insert(result.end(), {a, b, c});
+        }
+    }
+
+    // work on a unit extent so the attribute weight means the same for every mesh
+    glm::vec3 minimum(std::numeric_limits<float>::max()), maximum(-std::numeric_limits<float>::max());
+    for (uint32_t index : result) {
+        minimum = glm::min(minimum, vertices[index].position);
+        maximum = glm::max(maximum, vertices[index].position);
+    }
+    float extent = result.empty() ? 0.0f : std::max({maximum.x - minimum.x, maximum.y - minimum.y, maximum.z - minimum.z});
+    float scale  = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+    std::vector<glm::vec3> positions(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        positions[v] = (vertices[v].position - minimum) * scale;
+    }
+
+    auto buildEdges = [](const std::vector<uint32_t> &triangles) {
+        std::unordered_set<uint64_t> edges;
+        edges.reserve(triangles.size());
+        for (std::size_t i = 0; i < triangles.size(); i += 3) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                edges.insert(edgeKey(triangles[i + k], triangles[i + (k + 1) % 3]));
+            }
+        }
+        return edges;
+    };
+    auto isBorderEdge = [](const std::unordered_set<uint64_t> &edges, uint32_t a, uint32_t b) {
+        return edges.count(edgeKey(a, b)) != edges.count(edgeKey(b, a));
+    };
+
+    std::vector<Quadric> quadrics(vertexCount);
+    {
+        std::unordered_set<uint64_t> edges = buildEdges(result);
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            const glm::vec3 &p0 = positions[result[i + 0]];
+            const glm::vec3 &p1 = positions[result[i + 1]];
+            const glm::vec3 &p2 = positions[result[i + 2]];
+
+            glm::vec3 cross  = glm::cross(p1 - p0, p2 - p0);
+            float     length = glm::length(cross);
+            if (length <= 0.0f) {
+                continue;
+            }
+            glm::vec3 normal = cross / length;
+            Quadric   plane  = Quadric::fromPlane(normal, -glm::dot(normal, p0), length * 0.5f);
+            for (std::size_t k = 0; k < 3; ++k) {
+                quadrics[result[i + k]] += plane;
+            }
+
+            // a plane through each border edge, perpendicular to the triangle, pins the border in place
+            for (std::size_t k = 0; k < 3; ++k) {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                if (!isBorderEdge(edges, a, b)) {
+                    continue;
+                }
+                glm::vec3 edge       = positions[b] - positions[a];
+                float     edgeLength = glm::length(edge);
+                if (edgeLength <= 0.0f) {
+                    continue;
+                }
+                glm::vec3 edgeNormal = glm::normalize(glm::cross(edge, normal));
+                Quadric   border     = Quadric::fromPlane(edgeNormal, -glm::dot(edgeNormal, positions[a]), edgeLength * edgeLength * BORDER_WEIGHT);
+                quadrics[a] += border;
+                quadrics[b] += border;
+            }
+        }
+    }
+
+    struct Collapse
+    {
+        float    cost;
+        uint32_t from;
+        uint32_t to;
+    };
+
+    double                maxCost     = double(targetError) * targetError * scale * scale;
+    double                reachedCost = 0.0;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> collapseTo(vertexCount);
+    std::vector<uint8_t>  locked(vertexCount);
+    std::vector<uint8_t>  border(vertexCount);
+    std::vector<Collapse> collapses;
+
+    // each pass collapses the cheapest edges whose neighborhoods do not overlap, then rebuilds the adjacency
+    while (result.size() > targetIndexCount) {
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : result) {
+            ++adjacencyOffsets[index + 1];
+        }
+        for (std::size_t v = 0; v < vertexCount; ++v) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (std::size_t i = 0; i < result.size(); ++i) {
+                adjacency[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::unordered_set<uint64_t> edges = buildEdges(result);
+        std::fill(border.begin(), border.end(), 0);
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                if (isBorderEdge(edges, a, b)) {
+                    border[a] = border[b] = 1;
+                }
+            }
+        }
+
+        // the cheapest allowed collapse of every vertex
+        collapses.clear();
+        for (uint32_t from = 0; from < vertexCount; ++from) {
+            if (seam[from] || adjacencyOffsets[from] == adjacencyOffsets[from + 1]) {
+                continue;
+            }
+            Collapse best{.cost = std::numeric_limits<float>::max(), .from = from, .to = from};
+            for (uint32_t a = adjacencyOffsets[from]; a < adjacencyOffsets[from + 1]; ++a) {
+                const uint32_t *triangle = &result[adjacency[a] * 3];
+                for (std::size_t k = 0; k < 3; ++k) {
+                    uint32_t to = triangle[k];
+                    if (to == from || seam[to] || (border[from] && !isBorderEdge(edges, from, to))) {
+                        continue;
+                    }
+                    float cost = static_cast<float>(quadrics[from].error(positions[to])) +
+                                 ATTRIBUTE_WEIGHT * attributeDistance(vertices[from], vertices[to]);
+                    if (cost < best.cost) {
+                        best.cost = cost;
+                        best.to   = to;
+                    }
+                }
+            }
+            if (best.to != from) {
+                collapses.push_back(best);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+        for (std::size_t v = 0; v < vertexCount; ++v) {
+            collapseTo[v] = static_cast<uint32_t>(v);
+        }
+        std::fill(locked.begin(), locked.end(), 0);
+
+        std::size_t triangleCount = result.size() / 3;
+        std::size_t collapsed     = 0;
+        if (collapses.empty()) {
+            break;
+        }
+
+        // a collapse removes about two triangles, do not go past the cost of the ones needed to reach the target,
+        // the next pass gets another chance at the cheap ones blocked by the locks
+        std::size_t needed   = (triangleCount - targetIndexCount / 3 + 1) / 2;
+        double      passCost = std::min(maxCost, double(collapses[std::min(needed, collapses.size() - 1)].cost));
+        for (const Collapse &collapse : collapses) {
+            if (triangleCount * 3 <= targetIndexCount || collapse.cost > passCost) {
+                break;
+            }
+            if (locked[collapse.from] || locked[collapse.to]) {
+                continue;
+            }
+
+            // moving `from` onto `to` must not fold any remaining triangle over
+            bool        bFlips  = false;
+            std::size_t removed = 0;
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !bFlips; ++a) {
+                const uint32_t *triangle = &result[adjacency[a] * 3];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    ++removed;
+                    continue;
+                }
+                glm::vec3 p[3], moved[3];
+                for (std::size_t k = 0; k < 3; ++k) {
+                    p[k]     = positions[triangle[k]];
+                    moved[k] = triangle[k] == collapse.from ? positions[collapse.to] : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after  = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                bFlips           = glm::dot(before, after) <= MIN_NORMAL_DOT * glm::length(before) * glm::length(after);
+            }
+            if (bFlips) {
+                continue;
+            }
+
+            collapseTo[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            reachedCost = std::max(reachedCost, double(collapse.cost));
+            triangleCount -= removed;
+            ++collapsed;
+
+            // the whole fan changes, keep the other collapses of this pass out of it
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; ++a) {
+                const uint32_t *triangle = &result[adjacency[a] * 3];
+                locked[triangle[0]] = locked[triangle[1]] = locked[triangle[2]] = 1;
+            }
+        }
+        if (collapsed == 0) {
+            break;
+        }
+
+        std::size_t write = 0;
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = collapseTo[result[i + 0]], b = collapseTo[result[i + 1]], c = collapseTo[result[i + 2]];
+            if (a != b && b != c && c != a) {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    if (outError) {
+        *outError = static_cast<float>(std::sqrt(reachedCost)) / scale;
+    }
+    return result;
+}
+
+void generateLods(Mesh &mesh, uint32_t lodCount, float maxError)
+{
+    if (mesh.lods.empty() || mesh.vertices.empty()) {
+        return;
+    }
+    lodCount = std::min(lodCount, MAX_LOD_COUNT);
+
+    glm::vec3 size   = mesh.bounds.max - mesh.bounds.min;
+    float     extent = std::max({size.x, size.y, size.z});
+
+    const MeshLod        &base = mesh.lods.front();
+    std::vector<uint32_t> previous(mesh.indices.begin() + base.firstIndex, mesh.indices.begin() + base.firstIndex + base.indexCount);
+    float                 error = 0.0f;
+
+    std::vector<uint32_t> ordered;
+    for (uint32_t level = 1; level < lodCount; ++level) {
+        std::size_t target = previous.size() / 6 * 3;
+        if (target < MIN_LOD_INDICES) {
+            break;
+        }
+
+        float                 levelError = 0.0f;
+        std::vector<uint32_t> lod        = simplify(mesh.vertices, previous, target, maxError * extent, &levelError);
+        if (lod.empty() || static_cast<float>(lod.size()) > MIN_LOD_REDUCTION * static_cast<float>(previous.size())) {
+            break;
+        }
+        // each level simplifies the previous one, so the errors add up
+        error += levelError;
+
+        MeshOptimizer::optimizeVertexCache(lod, mesh.vertices.size(), ordered);
+        mesh.lods.push_back(MeshLod{
+            .firstIndex = static_cast<uint32_t>(mesh.indices.size()),
+            .indexCount = static_cast<uint32_t>(ordered.size()),
+            .error      = error,
+        });
+        mesh.indices.insert(mesh.indices.end(), ordered.begin(), ordered.end());
+        previous.swap(lod);
+    }
+}
+
+} // namespace MeshSimplifier
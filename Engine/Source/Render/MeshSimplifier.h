@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct Vertex;
+struct Mesh;
+
+// Quadric error edge collapse (Garland & Heckbert 1997) on indexed triangle lists.
+// Collapses are half edge: a vertex moves onto a neighbor, so the simplified indices reference the original vertices
+// and every LOD of a mesh shares its vertex buffer. Attributes are preserved by
+//   - adding the normal, texcoord and color difference of the two vertices to the collapse cost
+//   - locking the attribute seams (one position, several vertices), neither side of a seam moves or is collapsed onto
+//   - letting open borders collapse only along themselves, with edge planes keeping their shape
+namespace MeshSimplifier
+{
+
+inline constexpr uint32_t MAX_LOD_COUNT = 5; // including LOD 0
+
+// Simplifies `indices` towards `targetIndexCount` without any collapse costing more than `targetError`,
+// both errors are object space distances. `outError` gets the largest error reached
+std::vector<uint32_t> simplify(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::size_t targetIndexCount,
+                               float targetError, float *outError = nullptr);
+
+// Appends up to `lodCount - 1` simplified levels after LOD 0 to `mesh.indices` and `mesh.lods`, each halving the
+// triangles of the previous one. `maxError` is relative to the mesh extent, stops early when the mesh stops simplifying
+void generateLods(Mesh &mesh, uint32_t lodCount = MAX_LOD_COUNT, float maxError = 0.1f);
+
+} // namespace MeshSimplifier
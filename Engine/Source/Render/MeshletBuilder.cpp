@@ -0,0 +1,134 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Render/Model.h"
+
+namespace MeshletBuilder
+{
+
+// a cone wider than ~84 degrees off the axis culls too rarely to be worth testing
+static constexpr float MIN_CONE_DOT = 0.1f;
+
+std::vector<Meshlet> build(std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint32_t firstIndex, uint32_t indexCount,
+                           uint32_t maxVertices, uint32_t maxTriangles)
+{
+    std::vector<Meshlet> meshlets;
+    if (indexCount < 3 || vertices.empty() || uint64_t(firstIndex) + indexCount > indices.size()) {
+        return meshlets;
+    }
+
+    // the meshlet a vertex was last counted in, + 1 so 0 means none
+    std::vector<uint32_t> lastMeshlet(vertices.size(), 0);
+    Meshlet               current{.firstIndex = firstIndex};
+
+    auto flush = [&]() {
+        if (current.indexCount == 0) {
+            return;
+        }
+        meshlets.push_back(current);
+        current = Meshlet{.firstIndex = current.firstIndex + current.indexCount};
+    };
+
+    for (std::size_t i = firstIndex; i + 2 < uint64_t(firstIndex) + indexCount; i += 3) {
+        uint32_t id = static_cast<uint32_t>(meshlets.size()) + 1;
+
+        uint32_t newVertices = 0;
+        for (std::size_t k = 0; k < 3; ++k) {
+            newVertices += lastMeshlet[indices[i + k]] != id ? 1 : 0;
+        }
+        // a repeated index in a degenerate triangle is counted twice here, which only makes the meshlet end early
+        if (current.vertexCount + newVertices > maxVertices || current.indexCount / 3 + 1 > maxTriangles) {
+            flush();
+            id = static_cast<uint32_t>(meshlets.size()) + 1;
+        }
+
+        for (std::size_t k = 0; k < 3; ++k) {
+            if (lastMeshlet[indices[i + k]] != id) {
+                lastMeshlet[indices[i + k]] = id;
+                ++current.vertexCount;
+            }
+        }
+        current.indexCount += 3;
+    }
+    flush();
+
+    for (Meshlet &meshlet : meshlets) {
+        computeBounds(meshlet, vertices, indices);
+    }
+    return meshlets;
+}
+
+void computeBounds(Meshlet &meshlet, std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+{
+    std::span<const uint32_t> triangles = indices.subspan(meshlet.firstIndex, meshlet.indexCount);
+    if (triangles.empty()) {
+        return;
+    }
+    auto position = [&](std::size_t i) -> const glm::vec3 & { return vertices[triangles[i]].position; };
+
+    // Ritter's sphere: start from two far apart points, then grow to cover the rest
+    auto farthestFrom = [&](const glm::vec3 &from) {
+        std::size_t farthest = 0;
+        float       distance = -1.0f;
+        for (std::size_t i = 0; i < triangles.size(); ++i) {
+            glm::vec3 d      = position(i) - from;
+            float     length = glm::dot(d, d);
+            if (length > distance) {
+                distance = length;
+                farthest = i;
+            }
+        }
+        return position(farthest);
+    };
+    glm::vec3 a      = farthestFrom(position(0));
+    glm::vec3 b      = farthestFrom(a);
+    glm::vec3 center = (a + b) * 0.5f;
+    float     radius = glm::length(b - a) * 0.5f;
+    for (std::size_t i = 0; i < triangles.size(); ++i) {
+        float distance = glm::length(position(i) - center);
+        if (distance > radius) {
+            float grown = (radius + distance) * 0.5f;
+            center += (position(i) - center) * ((grown - radius) / distance);
+            radius = grown;
+        }
+    }
+    meshlet.center = center;
+    meshlet.radius = radius;
+
+    // the cone axis is the mean of the triangle normals, its cutoff comes from the one furthest off the axis
+    std::vector<glm::vec3> normals;
+    normals.reserve(triangles.size() / 3);
+    glm::vec3 axis(0.0f);
+    for (std::size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        glm::vec3 normal = glm::cross(position(i + 1) - position(i), position(i + 2) - position(i));
+        float     length = glm::length(normal);
+        if (length > 0.0f) {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+
+    meshlet.coneAxis   = glm::vec3(0.0f);
+    meshlet.coneCutoff = 1.0f;
+    float axisLength   = glm::length(axis);
+    if (normals.empty() || axisLength <= 0.0f) {
+        return;
+    }
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const glm::vec3 &normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, axis));
+    }
+    if (minDot <= MIN_CONE_DOT) {
+        return;
+    }
+    // the view directions seeing only back faces form the cone widened by 90 degrees and inverted,
+    // its cosine is -cos(angle + 90) = sin(angle)
+    meshlet.coneAxis   = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace MeshletBuilder
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct Vertex;
+struct Meshlet;
+
+// Splits a triangle list into meshlets for ClusterCulling. The triangles are taken in order, which after
+// MeshOptimizer is already spatially coherent, so a meshlet is a contiguous index range and the index buffer is
+// left untouched: culled meshlets are skipped by drawing only the ranges that survive
+namespace MeshletBuilder
+{
+
+inline constexpr uint32_t MAX_VERTICES  = 64;
+inline constexpr uint32_t MAX_TRIANGLES = 124;
+
+// meshlets of the `indexCount` indices at `firstIndex` of the mesh index buffer `indices`
+std::vector<Meshlet> build(std::span<const Vertex> vertices, std::span<const uint32_t> indices, uint32_t firstIndex, uint32_t indexCount,
+                           uint32_t maxVertices = MAX_VERTICES, uint32_t maxTriangles = MAX_TRIANGLES);
+
+// bounding sphere and normal cone of the triangles of `meshlet`, `indices` is the whole mesh index buffer
+void computeBounds(Meshlet &meshlet, std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+
+} // namespace MeshletBuilder
@@ -7,13 +7,10 @@
 #include "Texture.h"
 
 #include "Core/FileSystem/FileSystem.h"
+#include "Core/FileSystem/MappedFile.h"
 #include "Core/Log.h"
 #include "Render/CommandBuffer.h"
 
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
-
 
 
 void Model::draw(SDL_GPURenderPass *renderPass, SDL_GPUTexture *defaultTexture)
@@ -22,3 +19,18 @@ void Model::draw(SDL_GPURenderPass *renderPass, SDL_GPUTexture *defaultTexture)
     // In our current setup, we'll refactor Entry.cpp to handle the drawing
     // This is just a placeholder for potential future improvements
 }
+
+std::size_t Model::getMemoryUsage() const
+{
+    auto bytes = [](const auto &vector) { return vector.capacity() * sizeof(vector[0]); };
+
+    std::size_t usage = sizeof(Model) + bytes(meshes) + bytes(materials);
+    for (const Mesh &mesh : meshes) {
+        usage += bytes(mesh.vertices) + bytes(mesh.indices) + bytes(mesh.indices16) + bytes(mesh.packed.vertices) +
+                 bytes(mesh.lods) + bytes(mesh.meshlets);
+    }
+    if (mappedFile) {
+        usage += mappedFile->getSize();
+    }
+    return usage;
+}
@@ -3,12 +3,15 @@
 #include <SDL3/SDL_gpu.h>
 #include <glm/glm.hpp>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "Render/Texture.h"
+#include "Render/VertexCompression.h"
 
 struct CommandBuffer;
+class MappedFile;
 
 struct Vertex
 {
@@ -18,22 +21,119 @@ struct Vertex
     glm::vec4 color = {1.0f, 1.0f, 1.0f, 1.0f}; // Default white color
 };
 
+// object space box and sphere, computed at import (see MeshBounds)
+struct Bounds
+{
+    glm::vec3 min          = glm::vec3(0.0f);
+    glm::vec3 max          = glm::vec3(0.0f);
+    glm::vec3 sphereCenter = glm::vec3(0.0f);
+    float     sphereRadius = 0.0f;
+};
+
+// a range of `Mesh::indices`, LOD 0 is the full mesh
+struct MeshLod
+{
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float    error      = 0.0f; // object space error of the simplification
+};
+
+// a cluster of LOD 0 triangles, a contiguous range of `Mesh::indices`, see MeshletBuilder and ClusterCulling
+struct Meshlet
+{
+    glm::vec3 center = glm::vec3(0.0f); // bounding sphere
+    float     radius = 0.0f;
+    // normal cone, backfacing from `eye` if dot(center - eye, coneAxis) >= coneCutoff * |center - eye| + radius.
+    // A zero axis with a cutoff of 1 never culls
+    glm::vec3 coneAxis    = glm::vec3(0.0f);
+    float     coneCutoff  = 1.0f;
+    uint32_t  firstIndex  = 0;
+    uint32_t  indexCount  = 0;
+    uint32_t  vertexCount = 0; // unique vertices referenced
+    uint32_t  padding     = 0;
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet is stored as is in .nmesh files");
+
+struct Material
+{
+    std::string name;
+    std::string diffuseTexture; // relative to the model directory, empty if none
+};
+
 struct Mesh
 {
+    // 16 bit indices address this many vertices, larger meshes are split at import (see ModelImporter)
+    static constexpr std::size_t MAX_INDEX16_VERTICES = 65535;
+
     std::vector<Vertex>      vertices;
     std::vector<uint32_t>    indices;
+    std::vector<uint16_t>    indices16; // replaces `indices` once narrowed, see narrowIndices
     std::string              name;
+
+    // compact copy of `vertices` for the PACKED_VERTEX shaders, empty unless the importer packs it
+    VertexCompression::PackedMesh packed;
+
+    // Meshes loaded from a cooked .nmesh leave the vectors above empty and point into the mapped file instead,
+    // use the getters below to read either
+    std::span<const Vertex>                          mappedVertices;
+    std::span<const uint32_t>                        mappedIndices;
+    std::span<const uint16_t>                        mappedIndices16;
+    std::span<const VertexCompression::PackedVertex> mappedPackedVertices;
+    std::span<const Meshlet>                         mappedMeshlets;
+
+    Bounds               bounds;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets; // of LOD 0, empty if not built
+    uint32_t             materialIndex = 0;
+
     std::shared_ptr<Texture> diffuseTexture = nullptr;
 
     Mesh()  = default;
     ~Mesh() = default;
+
+    std::span<const Vertex>   getVertices() const { return vertices.empty() ? mappedVertices : std::span<const Vertex>(vertices); }
+    std::span<const uint32_t> getIndices() const { return indices.empty() ? mappedIndices : std::span<const uint32_t>(indices); }
+    std::span<const uint16_t> getIndices16() const { return indices16.empty() ? mappedIndices16 : std::span<const uint16_t>(indices16); }
+    std::span<const Meshlet>  getMeshlets() const { return meshlets.empty() ? mappedMeshlets : std::span<const Meshlet>(meshlets); }
+    std::span<const VertexCompression::PackedVertex> getPackedVertices() const
+    {
+        return packed.vertices.empty() ? mappedPackedVertices : std::span<const VertexCompression::PackedVertex>(packed.vertices);
+    }
+
+    // the index stream as it is uploaded, whichever of the 16 or 32 bit ones the mesh has
+    bool        hasIndices16() const { return !getIndices16().empty(); }
+    uint32_t    getIndexElementSize() const { return hasIndices16() ? sizeof(uint16_t) : sizeof(uint32_t); }
+    std::size_t getIndexCount() const { return hasIndices16() ? getIndices16().size() : getIndices().size(); }
+    std::span<const std::byte> getIndexBytes() const
+    {
+        return hasIndices16() ? std::as_bytes(getIndices16()) : std::as_bytes(getIndices());
+    }
+    uint32_t getIndex(std::size_t i) const { return hasIndices16() ? getIndices16()[i] : getIndices()[i]; }
+
+    // Moves `indices` into `indices16` if every vertex fits, false if the mesh stays 32 bit.
+    // Run last at import, the processing steps work on `indices`
+    bool narrowIndices()
+    {
+        if (indices.empty() || getVertices().size() > MAX_INDEX16_VERTICES) {
+            return false;
+        }
+        indices16.assign(indices.begin(), indices.end());
+        indices.clear();
+        indices.shrink_to_fit();
+        return true;
+    }
 };
 
 class Model
 {
   private:
-    std::vector<Mesh> meshes;
-    glm::mat4         transform = glm::mat4(1.0f);
+    std::vector<Mesh>     meshes;
+    std::vector<Material> materials;
+    glm::mat4             transform = glm::mat4(1.0f);
+    Bounds                bounds; // of all meshes, before `transform`
+
+    // the cooked file the meshes point into, null for imported models
+    std::shared_ptr<const MappedFile> mappedFile;
 
     bool        isLoaded = false;
     std::string directory;
@@ -47,6 +147,15 @@ class Model
     const std::vector<Mesh> &getMeshes() const { return meshes; }
     std::vector<Mesh>       &getMeshes() { return meshes; } // Non-const version for adding meshes
 
+    const std::vector<Material> &getMaterials() const { return materials; }
+    std::vector<Material>       &getMaterials() { return materials; }
+
+    const std::shared_ptr<const MappedFile> &getMappedFile() const { return mappedFile; }
+    void                                     setMappedFile(std::shared_ptr<const MappedFile> file) { mappedFile = std::move(file); }
+
+    const Bounds &getBounds() const { return bounds; }
+    void          setBounds(const Bounds &bounds) { this->bounds = bounds; }
+
     glm::mat4 getTransform() const { return transform; }
     void      setTransform(const glm::mat4 &transform) { this->transform = transform; }
 
@@ -55,4 +164,7 @@ class Model
 
     const std::string &getDirectory() const { return directory; }
     void               setDirectory(const std::string &directory) { this->directory = directory; }
+
+    // CPU bytes held by the meshes, the mapped file for cooked models. Textures live on the GPU and are not counted
+    std::size_t getMemoryUsage() const;
 };
@@ -0,0 +1,232 @@
+#include "ModelImporter.h"
+
+#if NE_WITH_ASSET_IMPORTER
+
+    #include <algorithm>
+    #include <filesystem>
+    #include <string>
+
+    #include <assimp/Importer.hpp>
+    #include <assimp/postprocess.h>
+    #include <assimp/scene.h>
+
+    #include "Core/Log.h"
+    #include "Render/AssimpIOSystem.h"
+    #include "Render/MeshBounds.h"
+    #include "Render/MeshOptimizer.h"
+    #include "Render/MeshSimplifier.h"
+    #include "Render/MeshletBuilder.h"
+    #include "Render/Model.h"
+    #include "Render/VertexWelder.h"
+
+namespace ModelImporter
+{
+
+static constexpr unsigned int POST_PROCESS_FLAGS = aiProcess_Triangulate |
+                                                   aiProcess_GenSmoothNormals |
+                                                   aiProcess_FlipUVs |
+                                                   aiProcess_CalcTangentSpace |
+                                                   aiProcess_SplitLargeMeshes;
+
+struct ThreadImporter
+{
+    Assimp::Importer    importer;
+    FileSystemIOSystem *ioSystem = new FileSystemIOSystem(); // owned by the importer
+
+    ThreadImporter()
+    {
+        importer.SetIOHandler(ioSystem);
+        // split meshes so every part can use 16 bit indices, see Mesh::narrowIndices
+        importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, static_cast<int>(Mesh::MAX_INDEX16_VERTICES));
+    }
+};
+
+// an Importer is not thread safe but expensive to create, keep one per thread (the loads and the cooker run on pools)
+static ThreadImporter &threadImporter()
+{
+    thread_local ThreadImporter importer;
+    return importer;
+}
+
+static std::shared_ptr<Model> convert(Assimp::Importer &importer, const aiScene *scene, const Options &options)
+{
+    // Check for errors
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        NE_CORE_ERROR("Assimp error: {}", importer.GetErrorString());
+        return nullptr;
+    }
+
+    auto model = std::make_shared<Model>();
+
+    for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+        const aiMaterial *material = scene->mMaterials[i];
+        Material          newMaterial;
+        newMaterial.name = material->GetName().C_Str();
+
+        aiString texturePath;
+        if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0 &&
+            material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS)
+        {
+            newMaterial.diffuseTexture = texturePath.C_Str();
+        }
+        model->getMaterials().push_back(std::move(newMaterial));
+    }
+
+    // Process all meshes in the scene
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+        aiMesh *mesh = scene->mMeshes[i];
+        Mesh    newMesh;
+
+        // Get mesh name
+        newMesh.name          = mesh->mName.length > 0 ? mesh->mName.C_Str() : "unnamed_mesh";
+        newMesh.materialIndex = mesh->mMaterialIndex;
+
+        // Process vertices
+        for (unsigned int j = 0; j < mesh->mNumVertices; j++) {
+            Vertex vertex;
+
+            // Position
+            vertex.position.x = mesh->mVertices[j].x;
+            vertex.position.y = mesh->mVertices[j].y;
+            vertex.position.z = mesh->mVertices[j].z;
+
+            // Normal
+            if (mesh->HasNormals()) {
+                vertex.normal.x = mesh->mNormals[j].x;
+                vertex.normal.y = mesh->mNormals[j].y;
+                vertex.normal.z = mesh->mNormals[j].z;
+            }
+
+            // Texture coordinates
+            if (mesh->mTextureCoords[0]) {
+                vertex.texCoord.x = mesh->mTextureCoords[0][j].x;
+                vertex.texCoord.y = mesh->mTextureCoords[0][j].y;
+            }
+            else {
+                vertex.texCoord = glm::vec2(0.0f, 0.0f);
+            }
+
+            // Colors - default white if no colors are available
+            if (mesh->HasVertexColors(0)) {
+                vertex.color.r = mesh->mColors[0][j].r;
+                vertex.color.g = mesh->mColors[0][j].g;
+                vertex.color.b = mesh->mColors[0][j].b;
+                vertex.color.a = mesh->mColors[0][j].a;
+            }
+            else {
+                vertex.color = glm::vec4(1.0f);
+            }
+
+            newMesh.vertices.push_back(std::move(vertex));
+        }
+
+        // Process indices
+        for (unsigned int j = 0; j < mesh->mNumFaces; j++) {
+            aiFace face = mesh->mFaces[j];
+            for (unsigned int k = 0; k < face.mNumIndices; k++) {
+                newMesh.indices.push_back(face.mIndices[k]);
+            }
+        }
+
+        // Assimp emits a vertex per face corner for formats like OBJ, weld before anything counts them
+        if (options.bWeldVertices) {
+            VertexWelder::Stats stats = VertexWelder::weld(newMesh);
+            if (stats.verticesAfter != stats.verticesBefore) {
+                NE_CORE_INFO("ModelImporter: {} welded {} -> {} vertices, {:.1f} KiB saved",
+                             newMesh.name,
+                             stats.verticesBefore,
+                             stats.verticesAfter,
+                             stats.bytesSaved() / 1024.0);
+            }
+        }
+
+        // the reorders below keep the positions, the LODs and packing read the bounds
+        newMesh.bounds = MeshBounds::compute(newMesh.vertices);
+
+        // reorders both, so before anything that copies them
+        if (options.bOptimize) {
+            MeshOptimizer::Report report = MeshOptimizer::optimize(newMesh);
+            NE_CORE_INFO("ModelImporter: {} ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                         newMesh.name,
+                         report.before.acmr,
+                         report.after.acmr,
+                         report.before.atvr,
+                         report.after.atvr);
+        }
+
+        newMesh.lods.push_back(MeshLod{.firstIndex = 0, .indexCount = static_cast<uint32_t>(newMesh.indices.size())});
+        if (options.lodCount > 1 && newMesh.indices.size() % 3 == 0) {
+            MeshSimplifier::generateLods(newMesh, options.lodCount);
+        }
+        if (options.bBuildMeshlets && newMesh.indices.size() % 3 == 0) {
+            newMesh.meshlets = MeshletBuilder::build(newMesh.vertices, newMesh.indices, 0, newMesh.lods.front().indexCount);
+        }
+
+        if (options.bPackVertices) {
+            newMesh.packed = VertexCompression::pack(newMesh.vertices);
+        }
+        // last, everything above works on the 32 bit indices
+        if (options.bNarrowIndices) {
+            newMesh.narrowIndices();
+        }
+
+        // Process materials/textures
+        // if (mesh->mMaterialIndex >= 0 && commandBuffer) {
+        //     aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+
+        //     // Load diffuse texture
+        //     if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+        //         aiString texturePath;
+        //         if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS) {
+        //             std::string fullPath = (std::filesystem::path(directory) / texturePath.C_Str()).string();
+        //             if (FileSystem::get()->isFileExists(fullPath)) {
+        //                 newMesh.diffuseTexture = Texture::CreateFromFile(fullPath, commandBuffer);
+        //             }
+        //         }
+        //     }
+        //     // You can add more texture types here (normal maps, specular maps, etc.)
+        // }
+
+        model->getMeshes().push_back(newMesh);
+    }
+
+    model->setBounds(MeshBounds::merge(model->getMeshes()));
+
+    // the scene is owned by the importer, release it now instead of on the next import of this thread
+    importer.FreeScene();
+
+    model->setIsLoaded(true);
+    return model;
+}
+
+std::shared_ptr<Model> importFromMemory(const void *data, std::size_t size, std::string_view hint, const Options &options)
+{
+    Assimp::Importer &importer = threadImporter().importer;
+
+    std::string    formatHint(hint.starts_with('.') ? hint.substr(1) : hint);
+    const aiScene *scene = importer.ReadFileFromMemory(data, size, POST_PROCESS_FLAGS, formatHint.c_str());
+    return convert(importer, scene, options);
+}
+
+std::shared_ptr<Model> import(std::string_view filepath, const Options &options, std::vector<std::string> *dependencies)
+{
+    auto &[importer, ioSystem] = threadImporter();
+
+    // the files are mapped by the IOSystem, sidecars are opened relative to the model
+    ioSystem->recordOpenedFiles(dependencies);
+    const aiScene *scene = importer.ReadFile(std::string(filepath), POST_PROCESS_FLAGS);
+    ioSystem->recordOpenedFiles(nullptr);
+
+    if (dependencies) {
+        // the model itself is not a dependency
+        std::string self = std::filesystem::path(filepath).lexically_normal().generic_string();
+        std::erase(*dependencies, self);
+        std::sort(dependencies->begin(), dependencies->end());
+        dependencies->erase(std::unique(dependencies->begin(), dependencies->end()), dependencies->end());
+    }
+    return convert(importer, scene, options);
+}
+
+} // namespace ModelImporter
+
+#endif
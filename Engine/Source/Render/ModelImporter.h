@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef NE_WITH_ASSET_IMPORTER
+    #define NE_WITH_ASSET_IMPORTER 1
+#endif
+
+class Model;
+
+// Source model import through Assimp, shared by AssetManager (runtime imports) and neon-cook (offline cooking).
+// Builds without NE_WITH_ASSET_IMPORTER only load cooked .nmesh files and do not link Assimp
+namespace ModelImporter
+{
+
+// bump when the imported data changes, the cooker rebuilds everything cooked by an older version
+inline constexpr uint32_t VERSION = 7;
+
+struct Options
+{
+    bool     bWeldVertices  = true; // merge the bitwise equal vertices, see VertexWelder
+    bool     bOptimize      = true; // vertex cache, overdraw and vertex fetch reordering, see MeshOptimizer
+    bool     bPackVertices  = false; // also produce Mesh::packed, uploaded instead of `vertices` by SDLRender3D
+    uint32_t lodCount       = 5;    // LOD 0 and up to lodCount - 1 simplified levels, see MeshSimplifier
+    bool     bBuildMeshlets = true; // LOD 0 clusters for ClusterCulling
+    bool     bNarrowIndices = true; // 16 bit indices, meshes over Mesh::MAX_INDEX16_VERTICES vertices are split by Assimp
+};
+
+#if NE_WITH_ASSET_IMPORTER
+// `hint` is the file extension, Assimp picks the format by it. nullptr on failure
+std::shared_ptr<Model> importFromMemory(const void *data, std::size_t size, std::string_view hint, const Options &options = {});
+// `filepath` is relative to the project root, the model and the files it references are mapped, not copied.
+// The other files it opened (.mtl, .bin, textures, ...) are appended to `dependencies`
+std::shared_ptr<Model> import(std::string_view filepath, const Options &options = {}, std::vector<std::string> *dependencies = nullptr);
+#endif
+
+} // namespace ModelImporter
@@ -1,25 +1,116 @@
 #include "Render.h"
 
+#include <algorithm>
+
+#include "Core/Hash.h"
+#include "Render/Shader.h"
+#include "Render/VertexLayout.h"
+
 
 namespace EVertexAttributeFormat
 {
 std::size_t T2Size(T type)
 {
-    switch (type) {
-    case Float2:
-        return sizeof(float) * 2;
-    case Float3:
-        return sizeof(float) * 3;
-    case Float4:
-        return sizeof(float) * 4;
-    default:
-        NE_CORE_ASSERT(false, "Invalid vertex attribute format {}", int(type));
-        return 0;
-    }
+    uint32_t size = sizeOf(type);
+    NE_CORE_ASSERT(size != 0, "Invalid vertex attribute format {}", int(type));
+    return size;
 }
 
 } // namespace EVertexAttributeFormat
 
+uint64_t GraphicsPipelineCreateInfo::hash() const
+{
+    uint64_t h = Hash::FNV_OFFSET_BASIS;
+
+    auto mix = [&h](uint64_t value) { h = Hash::fnv1a64(&value, sizeof(value), h); };
+
+    h = Hash::fnv1a64(shaderCreateInfo.shaderName, h);
+    mix(0xFF); // separator, "ab" + "c" != "a" + "bc"
+    h = Hash::fnv1a64(ShaderPermutation(shaderCreateInfo.defines).key(), h);
+
+    mix(bDeriveInfoFromShader);
+    // the explicit vertex layout is ignored when it is derived from the shader
+    if (!bDeriveInfoFromShader)
+    {
+        mix(vertexBufferDescs.size());
+        for (const auto &desc : vertexBufferDescs) {
+            mix(desc.slot);
+            mix(desc.pitch);
+        }
+        mix(vertexAttributes.size());
+        for (const auto &attr : vertexAttributes) {
+            mix(attr.location);
+            mix(attr.bufferSlot);
+            mix(attr.format);
+            mix(attr.offset);
+        }
+    }
+
+    mix(static_cast<uint64_t>(primitiveType));
+    mix(frontFaceType);
+    mix(blendMode);
+    mix(depthStencil.bDepthTest);
+    mix(depthStencil.bDepthWrite);
+    mix(depthStencil.compareOp);
+    mix(targetFormats.colorFormat ? static_cast<uint64_t>(*targetFormats.colorFormat) + 1 : 0);
+    mix(targetFormats.depthFormat);
+
+    // the mirrors change what the pipeline is validated against, two lookups that differ only there must not collide
+    mix(uniformLayouts.size());
+    for (const auto &layout : uniformLayouts) {
+        h = Hash::fnv1a64(layout.blockName, h);
+        mix(layout.size);
+        mix(layout.members.size());
+        for (const auto &member : layout.members) {
+            h = Hash::fnv1a64(member.name, h);
+            mix(member.offset);
+            mix(member.size);
+        }
+    }
+    return h;
+}
+
+bool GraphicsPipelineCreateInfo::samePipeline(const GraphicsPipelineCreateInfo &other) const
+{
+    if (shaderCreateInfo.shaderName != other.shaderCreateInfo.shaderName ||
+        ShaderPermutation(shaderCreateInfo.defines).key() != ShaderPermutation(other.shaderCreateInfo.defines).key() ||
+        bDeriveInfoFromShader != other.bDeriveInfoFromShader)
+    {
+        return false;
+    }
+    if (!bDeriveInfoFromShader)
+    {
+        auto sameDesc = [](const VertexBufferDescription &a, const VertexBufferDescription &b) {
+            return a.slot == b.slot && a.pitch == b.pitch;
+        };
+        auto sameAttr = [](const VertexAttribute &a, const VertexAttribute &b) {
+            return a.location == b.location && a.bufferSlot == b.bufferSlot && a.format == b.format && a.offset == b.offset;
+        };
+        if (!std::ranges::equal(vertexBufferDescs, other.vertexBufferDescs, sameDesc) ||
+            !std::ranges::equal(vertexAttributes, other.vertexAttributes, sameAttr))
+        {
+            return false;
+        }
+    }
+    auto sameMember = [](const UniformMemberLayout &a, const UniformMemberLayout &b) {
+        return std::string_view(a.name) == b.name && a.offset == b.offset && a.size == b.size;
+    };
+    auto sameLayout = [&sameMember](const UniformLayoutInfo &a, const UniformLayoutInfo &b) {
+        return std::string_view(a.blockName) == b.blockName && a.size == b.size && std::ranges::equal(a.members, b.members, sameMember);
+    };
+    if (!std::ranges::equal(uniformLayouts, other.uniformLayouts, sameLayout)) {
+        return false;
+    }
+    return primitiveType == other.primitiveType &&
+           frontFaceType == other.frontFaceType &&
+           blendMode == other.blendMode &&
+           depthStencil.bDepthTest == other.depthStencil.bDepthTest &&
+           depthStencil.bDepthWrite == other.depthStencil.bDepthWrite &&
+           depthStencil.compareOp == other.depthStencil.compareOp &&
+           targetFormats.colorFormat == other.targetFormats.colorFormat &&
+           targetFormats.depthFormat == other.targetFormats.depthFormat;
+}
+
 // namespace ETextureFormat
 // {
 // // Add texture format handling if needed
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <source_location>
+#include <span>
+#include <string>
 #include <vector>
 
 #include "Core/Log.h"
@@ -49,6 +53,11 @@ enum T
     Float2 = 0,
     Float3,
     Float4,
+    // compact formats, see Render/VertexCompression.h for the kernels producing them
+    Half2,      // uv
+    UByte4Norm, // color
+    Short2Norm, // octahedral normal
+    Short4Norm, // quantized position, dequantized in the shader (w unused)
     ENUM_MAX,
 };
 
@@ -67,9 +76,25 @@ struct VertexAttribute
     uint32_t                  offset;
 };
 
+// A C++ mirror of a uniform block, built with makeUniformLayout (Render/UniformLayout.h)
+struct UniformMemberLayout
+{
+    const char *name;
+    uint32_t    offset;
+    uint32_t    size;
+};
+
+struct UniformLayoutInfo
+{
+    const char                          *blockName; // instance name in the shader, e.g. uLight
+    uint32_t                             size;
+    std::span<const UniformMemberLayout> members;
+};
+
 struct ShaderCreateInfo
 {
-    std::string shaderName; // we use single glsl now
+    std::string              shaderName; // we use single glsl now
+    std::vector<std::string> defines;    // permutation keys passed as macros, e.g. TEXTURED, LIT, INSTANCED
 };
 
 namespace EFrontFaceType
@@ -81,6 +106,60 @@ enum T
 };
 };
 
+namespace EBlendMode
+{
+enum T
+{
+    Opaque = 0,
+    AlphaBlend, // src * src.a + dst * (1 - src.a)
+    Additive,   // src * src.a + dst
+    ENUM_MAX,
+};
+GENERATED_ENUM_MISC(T);
+}; // namespace EBlendMode
+
+namespace ECompareOp
+{
+enum T
+{
+    Never = 0,
+    Less,
+    Equal,
+    LessOrEqual,
+    Greater,
+    NotEqual,
+    GreaterOrEqual,
+    Always,
+    ENUM_MAX,
+};
+GENERATED_ENUM_MISC(T);
+}; // namespace ECompareOp
+
+namespace EDepthFormat
+{
+enum T
+{
+    None = 0, // no depth target
+    D24_UNORM_S8_UINT,
+    D32_FLOAT,
+    ENUM_MAX,
+};
+GENERATED_ENUM_MISC(T);
+}; // namespace EDepthFormat
+
+struct DepthStencilState
+{
+    bool          bDepthTest  = true;
+    bool          bDepthWrite = true;
+    ECompareOp::T compareOp   = ECompareOp::Greater; // -z forward
+};
+
+struct RenderTargetFormats
+{
+    std::optional<ETextureFormat> colorFormat; // empty: the swapchain format of the window
+    EDepthFormat::T               depthFormat = EDepthFormat::None;
+};
+
 struct GraphicsPipelineCreateInfo
 {
     bool                                 bDeriveInfoFromShader = true;
@@ -89,6 +168,17 @@ struct GraphicsPipelineCreateInfo
     std::vector<VertexAttribute>         vertexAttributes;
     EGraphicPipeLinePrimitiveType        primitiveType = EGraphicPipeLinePrimitiveType::TriangleList;
     EFrontFaceType::T                    frontFaceType = EFrontFaceType::CounterClockWise;
+    EBlendMode::T                        blendMode     = EBlendMode::AlphaBlend;
+    DepthStencilState                    depthStencil;
+    RenderTargetFormats                  targetFormats;
+    // checked against the reflected uniform blocks when the pipeline is created
+    std::vector<UniformLayoutInfo>       uniformLayouts;
+
+    // Stable across runs, covers every field that ends up in the native pipeline.
+    // The defines are hashed as a normalized set, so their order does not matter
+    uint64_t hash() const;
+    // equal on the fields hash() covers, for the lookups keyed by it
+    bool samePipeline(const GraphicsPipelineCreateInfo &other) const;
 };
 
 #define STRINGIFY_IMPL(x) #x
@@ -10,13 +10,17 @@
 #include "Shader.h"
 
 
-#include <shaderc/shaderc.hpp>
+#include <algorithm>
+#include <cstring>
 #include <stdio.h>
 #include <string>
 #include <unordered_map>
 
-#include <spirv_cross/spirv.h>
-#include <spirv_cross/spirv_cross.hpp>
+#if NE_WITH_SHADER_COMPILER
+    #include <shaderc/shaderc.hpp>
+    #include <spirv_cross/spirv.h>
+    #include <spirv_cross/spirv_cross.hpp>
+#endif
 
 #include "utility/string_utils.h"
 
@@ -24,7 +28,9 @@
 #include <SDL3/SDL_gpu.h>
 
 
+#include "Core/FileSystem/BinaryStream.h"
 #include "Core/FileSystem/FileSystem.h"
+#include "Core/Hash.h"
 
 
 static const char *eolFlag =
@@ -39,6 +45,7 @@ namespace EShaderStage
 {
 
 
+#if NE_WITH_SHADER_COMPILER
 shaderc_shader_kind toShadercType(EShaderStage::T Stage)
 {
     switch (Stage) {
@@ -53,6 +60,7 @@ shaderc_shader_kind toShadercType(EShaderStage::T Stage)
     NE_CORE_ASSERT(false, "Unknown shader type!");
     return shaderc_shader_kind(0);
 }
+#endif
 
 const char *getOpenGLCacheFileExtension(EShaderStage::T stage)
 {
@@ -102,18 +110,141 @@ SDL_GPUShaderStage toSDLStage(EShaderStage::T Stage)
 
 
 
-std::filesystem::path GLSLScriptProcessor::GetCachePath(bool bVulkan, EShaderStage::T stage)
+static constexpr uint32_t SPIRV_CACHE_META_MAGIC   = 0x4D56504E; // "NPVM"
+static constexpr uint32_t SPIRV_CACHE_META_VERSION = 1;
+static constexpr uint32_t REFLECTION_CACHE_MAGIC   = 0x4C46524E; // "NRFL"
+static constexpr uint32_t REFLECTION_CACHE_VERSION = 3; // 2: storage buffers, 3: uniform block instance names
+
+static uint64_t hashSpirv(const ShaderScriptProcessor::spirv_ir_t &spirv)
 {
-    // auto cached_dir = GetBaseCachePath();
-    // auto filename   = m_FilePath.filename().string() +
-    //                 (bVulkan
-    //                      ? utils::ShaderStage2CachedFileExtension_Vulkan(stage)
-    //                      : utils::ShaderStage2CachedFileExtension_OpenGL(stage));
-    // return cached_dir / filename;
+    return Hash::fnv1a64(spirv.data(), spirv.size() * sizeof(ShaderScriptProcessor::ir_t));
+}
 
-    return "";
+ShaderPermutation::ShaderPermutation(std::vector<std::string> inDefines)
+    : defines(std::move(inDefines))
+{
+    std::sort(defines.begin(), defines.end());
+    defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+}
+
+std::string ShaderPermutation::key() const
+{
+    std::string ret;
+    for (const auto &define : defines) {
+        if (!ret.empty()) {
+            ret += ';';
+        }
+        ret += define;
+    }
+    return ret;
+}
+
+uint64_t ShaderPermutation::hash() const
+{
+    return empty() ? 0 : Hash::fnv1a64(key());
+}
+
+std::string ShaderPermutation::variantName(std::string_view fileName) const
+{
+    if (empty()) {
+        return std::string(fileName);
+    }
+    return std::format("{}.{:016x}", fileName, hash());
+}
+
+std::filesystem::path GLSLScriptProcessor::GetCachePath(std::string_view fileName, bool bVulkan, EShaderStage::T stage)
+{
+    std::string filename = std::string(fileName) +
+                           (bVulkan
+                                ? EShaderStage::getVulkanCacheFileExtension(stage)
+                                : EShaderStage::getOpenGLCacheFileExtension(stage));
+    return std::filesystem::path(cachedStoragePath) / filename;
+}
+
+std::filesystem::path GLSLScriptProcessor::GetCacheMetaPath(std::string_view fileName)
+{
+    return std::filesystem::path(cachedStoragePath) / (std::string(fileName) + ".cached.meta");
+}
+
+std::string ShaderScriptProcessor::getReflectionCachePath(std::string_view fileName) const
+{
+    return cachedStoragePath + "/" + std::string(fileName) + ".cached.refl";
 }
 
+std::optional<GLSLScriptProcessor::stage2spirv_t> GLSLScriptProcessor::loadSpirvCache(std::string_view cacheName, uint64_t sourceHash)
+{
+    auto fs       = FileSystem::get();
+    auto metaPath = GetCacheMetaPath(cacheName).string();
+    if (!fs->isFileExists(metaPath)) {
+        return {};
+    }
+
+    std::string metaContent;
+    if (!fs->readFileToString(metaPath, metaContent)) {
+        return {};
+    }
+
+    BinaryReader reader(metaContent);
+    uint32_t     magic = 0, version = 0, stageCount = 0;
+    uint64_t     cachedSourceHash = 0;
+    reader.read(magic);
+    reader.read(version);
+    reader.read(cachedSourceHash);
+    reader.read(stageCount);
+    if (!reader.bOk || magic != SPIRV_CACHE_META_MAGIC || version != SPIRV_CACHE_META_VERSION || cachedSourceHash != sourceHash) {
+        return {};
+    }
+
+    stage2spirv_t ret;
+    for (uint32_t i = 0; i < stageCount; ++i)
+    {
+        uint32_t stage = 0;
+        if (!reader.read(stage) || stage >= EShaderStage::ENUM_MAX) {
+            return {};
+        }
+
+        auto        stagePath = GetCachePath(cacheName, true, (EShaderStage::T)stage).string();
+        std::string code;
+        if (!fs->isFileExists(stagePath) || !fs->readFileToString(stagePath, code) || code.size() % sizeof(ir_t) != 0) {
+            return {};
+        }
+
+        spirv_ir_t spirv(code.size() / sizeof(ir_t));
+        std::memcpy(spirv.data(), code.data(), code.size());
+        if (spirv.empty() || spirv[0] != 0x07230203) {
+            return {};
+        }
+        ret[(EShaderStage::T)stage] = std::move(spirv);
+    }
+
+    NE_CORE_TRACE("Use cached SPIR-V for {}", cacheName);
+    return {std::move(ret)};
+}
+
+void GLSLScriptProcessor::saveSpirvCache(std::string_view cacheName, uint64_t sourceHash, const stage2spirv_t &spirv)
+{
+    auto fs = FileSystem::get();
+    for (auto &[stage, code] : spirv) {
+        std::string_view bytes(reinterpret_cast<const char *>(code.data()), code.size() * sizeof(ir_t));
+        if (!fs->writeFile(GetCachePath(cacheName, true, stage).string(), bytes)) {
+            NE_CORE_WARN("Failed to write SPIR-V cache for {} ({})", cacheName, EShaderStage::T2Strings[stage]);
+            return;
+        }
+    }
+
+    // meta is written last, so a partial cache is never considered valid
+    BinaryWriter writer;
+    writer.write(SPIRV_CACHE_META_MAGIC);
+    writer.write(SPIRV_CACHE_META_VERSION);
+    writer.write(sourceHash);
+    writer.write<uint32_t>(static_cast<uint32_t>(spirv.size()));
+    for (auto &[stage, _] : spirv) {
+        writer.write<uint32_t>(stage);
+    }
+    fs->writeFile(GetCacheMetaPath(cacheName).string(), writer.view());
+}
+
+#if NE_WITH_SHADER_COMPILER
 namespace SPIRVHelper
 {
 
@@ -199,23 +330,19 @@ uint32_t getSpirvTypeSize(const spirv_cross::SPIRType &type)
 // Get the offset for a member in a struct with proper C++ alignment
 uint32_t getVertexAlignedOffset(uint32_t current_offset, const spirv_cross::SPIRType &type)
 {
-    // Determine the alignment requirement based on std140 layout rules
-    uint32_t alignment = 4; // Default to 4 bytes for basic types
-
-    return (current_offset + alignment) % alignment == 0 ? current_offset : current_offset + alignment;
+    // vertex attributes are tightly packed like a C++ struct of glm vectors, every component type is 4 bytes wide,
+    // so only the scalar alignment applies (not the std140 vec4 one)
+    uint32_t alignment = std::max(type.width / 8, 1u);
 
-
-    // if ((current_offset + size) % alignment != 0) {
-    //     // Align to the next multiple of the alignment size
-    //     current_offset += (alignment - (current_offset % alignment));
-    // }
-    // return aligned_offset;
+    return (current_offset + alignment - 1) / alignment * alignment;
 }
 } // namespace SPIRVHelper
+#endif
 
 namespace ShaderReflection
 {
 
+#if NE_WITH_SHADER_COMPILER
 DataType getSpirvBaseType(const spirv_cross::SPIRType &type)
 {
     switch (type.basetype) {
@@ -268,6 +395,7 @@ DataType getSpirvBaseType(const spirv_cross::SPIRType &type)
 
     return DataType::Unknown;
 }
+#endif
 
 SDL_GPUVertexElementFormat dataTypeToSDLFormat(DataType type)
 {
@@ -319,18 +447,232 @@ uint32_t getDataTypeSize(DataType type)
     }
 }
 
+static void writeStageIO(BinaryWriter &writer, const std::vector<StageIOData> &ios)
+{
+    writer.write<uint32_t>(static_cast<uint32_t>(ios.size()));
+    for (const auto &io : ios) {
+        writer.writeString(io.name);
+        writer.write<uint32_t>(static_cast<uint32_t>(io.type));
+        writer.write(io.location);
+        writer.write(io.offset);
+        writer.write(io.size);
+        writer.write<uint32_t>(static_cast<uint32_t>(io.format));
+    }
+}
+
+static bool readStageIO(BinaryReader &reader, std::vector<StageIOData> &ios)
+{
+    uint32_t count = 0;
+    reader.read(count);
+    for (uint32_t i = 0; i < count && reader.bOk; ++i) {
+        StageIOData io;
+        uint32_t    type = 0, format = 0;
+        reader.readString(io.name);
+        reader.read(type);
+        reader.read(io.location);
+        reader.read(io.offset);
+        reader.read(io.size);
+        reader.read(format);
+        io.type   = static_cast<DataType>(type);
+        io.format = static_cast<SDL_GPUVertexElementFormat>(format);
+        ios.push_back(std::move(io));
+    }
+    return reader.bOk;
+}
+
+void serialize(const ShaderResources &resources, uint64_t spirvHash, std::vector<uint8_t> &out)
+{
+    BinaryWriter writer;
+    writer.buffer = std::move(out);
+
+    writer.write<uint32_t>(resources.stage);
+    writer.write(spirvHash);
+
+    writeStageIO(writer, resources.inputs);
+    writeStageIO(writer, resources.outputs);
+
+    writer.write<uint32_t>(static_cast<uint32_t>(resources.uniformBuffers.size()));
+    for (const auto &ubo : resources.uniformBuffers) {
+        writer.writeString(ubo.name);
+        writer.writeString(ubo.instanceName);
+        writer.write(ubo.set);
+        writer.write(ubo.binding);
+        writer.write(ubo.size);
+        writer.write<uint32_t>(static_cast<uint32_t>(ubo.members.size()));
+        for (const auto &member : ubo.members) {
+            writer.writeString(member.name);
+            writer.write<uint32_t>(static_cast<uint32_t>(member.type));
+            writer.write(member.offset);
+            writer.write(member.size);
+        }
+    }
+
+    writer.write<uint32_t>(static_cast<uint32_t>(resources.sampledImages.size()));
+    for (const auto &image : resources.sampledImages) {
+        writer.writeString(image.name);
+        writer.write(image.binding);
+        writer.write(image.set);
+        writer.write<uint32_t>(static_cast<uint32_t>(image.type));
+    }
+
+    writer.write<uint32_t>(static_cast<uint32_t>(resources.storageBuffers.size()));
+    for (const auto &buffer : resources.storageBuffers) {
+        writer.writeString(buffer.name);
+        writer.write(buffer.binding);
+        writer.write(buffer.set);
+    }
+
+    out = std::move(writer.buffer);
+}
+
+bool deserialize(const uint8_t *data, std::size_t size, std::size_t &cursor, ShaderResources &out, uint64_t &spirvHash)
+{
+    BinaryReader reader(data, size);
+    reader.cursor = cursor;
+
+    uint32_t stage = 0;
+    reader.read(stage);
+    reader.read(spirvHash);
+    if (!reader.bOk || stage >= EShaderStage::ENUM_MAX) {
+        return false;
+    }
+    out.stage = static_cast<EShaderStage::T>(stage);
+
+    readStageIO(reader, out.inputs);
+    readStageIO(reader, out.outputs);
+
+    uint32_t uboCount = 0;
+    reader.read(uboCount);
+    for (uint32_t i = 0; i < uboCount && reader.bOk; ++i) {
+        UniformBuffer ubo;
+        uint32_t      memberCount = 0;
+        reader.readString(ubo.name);
+        reader.readString(ubo.instanceName);
+        reader.read(ubo.set);
+        reader.read(ubo.binding);
+        reader.read(ubo.size);
+        reader.read(memberCount);
+        for (uint32_t j = 0; j < memberCount && reader.bOk; ++j) {
+            UniformBufferMember member;
+            uint32_t            type = 0;
+            reader.readString(member.name);
+            reader.read(type);
+            reader.read(member.offset);
+            reader.read(member.size);
+            member.type = static_cast<DataType>(type);
+            ubo.members.push_back(std::move(member));
+        }
+        out.uniformBuffers.push_back(std::move(ubo));
+    }
+
+    uint32_t imageCount = 0;
+    reader.read(imageCount);
+    for (uint32_t i = 0; i < imageCount && reader.bOk; ++i) {
+        Resource image;
+        uint32_t type = 0;
+        reader.readString(image.name);
+        reader.read(image.binding);
+        reader.read(image.set);
+        reader.read(type);
+        image.type = static_cast<DataType>(type);
+        out.sampledImages.push_back(std::move(image));
+    }
+
+    uint32_t storageBufferCount = 0;
+    reader.read(storageBufferCount);
+    for (uint32_t i = 0; i < storageBufferCount && reader.bOk; ++i) {
+        Resource buffer;
+        reader.readString(buffer.name);
+        reader.read(buffer.binding);
+        reader.read(buffer.set);
+        buffer.type = DataType::Unknown;
+        out.storageBuffers.push_back(std::move(buffer));
+    }
+
+    cursor = reader.cursor;
+    return reader.bOk;
+}
+
 } // namespace ShaderReflection
 
+
+ShaderScriptProcessor::stage2reflection_t ShaderScriptProcessor::reflectWithCache(std::string_view fileName, const stage2spirv_t &spirv)
+{
+    stage2reflection_t ret;
+    auto               fs        = FileSystem::get();
+    auto               cachePath = getReflectionCachePath(fileName);
+
+    // load the sidecar, only keep the stages whose SPIR-V is unchanged
+    std::string content;
+    if (fs->isFileExists(cachePath) && fs->readFileToString(cachePath, content))
+    {
+        BinaryReader reader(content);
+        uint32_t     magic = 0, version = 0, stageCount = 0;
+        reader.read(magic);
+        reader.read(version);
+        reader.read(stageCount);
+
+        if (reader.bOk && magic == REFLECTION_CACHE_MAGIC && version == REFLECTION_CACHE_VERSION)
+        {
+            std::size_t cursor = reader.cursor;
+            for (uint32_t i = 0; i < stageCount; ++i)
+            {
+                ShaderReflection::ShaderResources resources;
+                uint64_t                          cachedHash = 0;
+                if (!ShaderReflection::deserialize(reinterpret_cast<const uint8_t *>(content.data()), content.size(), cursor, resources, cachedHash)) {
+                    NE_CORE_WARN("Corrupted reflection cache: {}", cachePath);
+                    ret.clear();
+                    break;
+                }
+
+                auto it = spirv.find(resources.stage);
+                if (it != spirv.end() && hashSpirv(it->second) == cachedHash) {
+                    ret[resources.stage] = std::move(resources);
+                }
+            }
+        }
+    }
+
+    bool bDirty = false;
+    for (const auto &[stage, code] : spirv) {
+        if (!ret.contains(stage)) {
+            ret[stage] = reflect(stage, code);
+            bDirty     = true;
+        }
+    }
+
+    if (bDirty)
+    {
+        std::vector<uint8_t> bytes;
+        {
+            BinaryWriter writer;
+            writer.write(REFLECTION_CACHE_MAGIC);
+            writer.write(REFLECTION_CACHE_VERSION);
+            writer.write<uint32_t>(static_cast<uint32_t>(ret.size()));
+            bytes = std::move(writer.buffer);
+        }
+        for (const auto &[stage, resources] : ret) {
+            ShaderReflection::serialize(resources, hashSpirv(spirv.at(stage)), bytes);
+        }
+        fs->writeFile(cachePath, std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()));
+    }
+    else {
+        NE_CORE_TRACE("Use cached reflection for {}", fileName);
+    }
+
+    return ret;
+}
+
 ShaderReflection::ShaderResources GLSLScriptProcessor::reflect(EShaderStage::T stage, const std::vector<ir_t> &spirvData)
 {
+#if NE_WITH_SHADER_COMPILER
     std::vector<uint32_t>        spirv_ir(spirvData.begin(), spirvData.end());
     spirv_cross::Compiler        compiler(spirv_ir);
     spirv_cross::ShaderResources spirvResources = compiler.get_shader_resources();
 
     // Create our custom shader resources structure
     ShaderReflection::ShaderResources resources;
-    resources.stage          = stage;
-    resources.spirvResources = spirvResources; // Store original spirv resources
+    resources.stage = stage;
 
     NE_CORE_TRACE("===============================================================================");
     NE_CORE_TRACE("OpenGLShader:Reflect {} -> {}", tempProcessingPath, EShaderStage::T2Strings[stage]);
@@ -346,7 +688,13 @@ ShaderReflection::ShaderResources GLSLScriptProcessor::reflect(EShaderStage::T s
     NE_CORE_TRACE("Stage Inputs (with alignment information):");
     uint32_t   struct_offset      = 0;
     const bool IS_CPP_STRUCT_PACK = true;
-    for (const auto &input : spirvResources.stage_inputs) {
+
+    // SPIRV-Cross does not list the inputs by location, the offsets must follow the locations
+    auto stageInputs = spirvResources.stage_inputs;
+    std::sort(stageInputs.begin(), stageInputs.end(), [&compiler](const auto &a, const auto &b) {
+        return compiler.get_decoration(a.id, spv::DecorationLocation) < compiler.get_decoration(b.id, spv::DecorationLocation);
+    });
+    for (const auto &input : stageInputs) {
 
         uint32_t location = compiler.get_decoration(input.id, spv::DecorationLocation);
         uint32_t offset   = compiler.get_decoration(input.id, spv::DecorationOffset);
@@ -415,12 +763,13 @@ ShaderReflection::ShaderResources GLSLScriptProcessor::reflect(EShaderStage::T s
 
         // Create uniform buffer
         ShaderReflection::UniformBuffer uniformBuffer;
-        uniformBuffer.name    = resource.name;
-        uniformBuffer.binding = binding;
-        uniformBuffer.set     = set;
-        uniformBuffer.size    = bufferSize;
+        uniformBuffer.name         = resource.name;
+        uniformBuffer.instanceName = compiler.get_name(resource.id);
+        uniformBuffer.binding      = binding;
+        uniformBuffer.set          = set;
+        uniformBuffer.size         = bufferSize;
 
-        NE_CORE_TRACE("Buffer Name:  {0}", resource.name);
+        NE_CORE_TRACE("Buffer Name:  {0} ({1})", resource.name, uniformBuffer.instanceName);
         NE_CORE_TRACE("\tSize = {0}", bufferSize);
         NE_CORE_TRACE("\tBinding = {0}", binding);
         NE_CORE_TRACE("\tSet = {0}", set);
@@ -490,104 +839,322 @@ ShaderReflection::ShaderResources GLSLScriptProcessor::reflect(EShaderStage::T s
         NE_CORE_TRACE("\tSampled Image: {0} (binding: {1}, set: {2}, type: {3})", resource.name, binding, set, ShaderReflection::DataType2Strings[sampledImage.type]);
     }
 
+    NE_CORE_TRACE("Storage buffers:");
+    for (const auto &resource : spirvResources.storage_buffers) {
+        ShaderReflection::Resource storageBuffer;
+        storageBuffer.name    = resource.name;
+        storageBuffer.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+        storageBuffer.set     = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+        storageBuffer.type    = ShaderReflection::DataType::Unknown;
+
+        resources.storageBuffers.push_back(storageBuffer);
+
+        NE_CORE_TRACE("\tStorage Buffer: {0} (binding: {1}, set: {2})", resource.name, storageBuffer.binding, storageBuffer.set);
+    }
+
     return resources;
+#else
+    NE_CORE_ERROR("Cannot reflect {}: built without SPIRV-Cross", tempProcessingPath);
+    return {};
+#endif
 }
 
 
-std::optional<GLSLScriptProcessor::stage2spirv_t> GLSLScriptProcessor::process(std::string_view fileName)
+bool GLSLScriptProcessor::readSource(std::string_view fileName, std::string &out, std::vector<std::string> *dependencies)
 {
-    std::string contentStr;
-    std::string fullPath = this->shaderStoragePath + "/" + fileName.data();
-    if (!FileSystem::get()->readFileToString(fullPath, contentStr))
+    std::string fullPath = this->shaderStoragePath + "/" + std::string(fileName);
+    std::string content;
+    if (!FileSystem::get()->readFileToString(fullPath, content))
     {
         NE_CORE_ERROR("Failed to read shader file: {}", fullPath);
-        return {};
+        return false;
     }
+    // Record the processing path for reflection logging
+    tempProcessingPath = fullPath;
 
+    out.clear();
+    return expandIncludes(fileName, content, out, dependencies, 0);
+}
 
-    // Preprocess
-    std::unordered_map<EShaderStage::T, std::string> shaderSources;
+bool GLSLScriptProcessor::expandIncludes(const std::filesystem::path &filePath, std::string_view source, std::string &out, std::vector<std::string> *dependencies, int depth)
+{
+    if (depth > MAX_INCLUDE_DEPTH) {
+        NE_CORE_ERROR("Include depth exceeds {} in {}, recursive include?", MAX_INCLUDE_DEPTH, filePath.generic_string());
+        return false;
+    }
+
+    std::string_view includeToken = "#include";
+
+    size_t lineBegin = 0;
+    while (lineBegin < source.size())
     {
-        std::string_view source(contentStr.begin(), contentStr.end());
+        size_t lineEnd = source.find('\n', lineBegin);
+        lineEnd        = lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+
+        std::string_view line    = source.substr(lineBegin, lineEnd - lineBegin);
+        std::string_view trimmed = ut::str::trim(line);
+        lineBegin                = lineEnd;
 
+        if (!trimmed.starts_with(includeToken)) {
+            out += line;
+            continue;
+        }
 
-        // We split the source by "#type <vertex/fragment>" preprocessing directives
-        std::string_view typeToken    = "#type";
-        const size_t     typeTokenLen = typeToken.size();
-        size_t           pos          = source.find(typeToken, 0);
+        // #include "relative/path.glsl", looked up next to the including file first, then from the shader dir
+        size_t quoteBegin = trimmed.find('"');
+        size_t quoteEnd   = quoteBegin == std::string_view::npos ? std::string_view::npos : trimmed.find('"', quoteBegin + 1);
+        if (quoteEnd == std::string_view::npos) {
+            NE_CORE_ERROR("Syntax error in {}: {}", filePath.generic_string(), trimmed);
+            return false;
+        }
+        std::string_view includeName = trimmed.substr(quoteBegin + 1, quoteEnd - quoteBegin - 1);
 
-        while (pos != std::string ::npos)
-        {
-            // get the type string
-            size_t eol = source.find_first_of(eolFlag, pos);
-            NE_CORE_ASSERT(eol != std::string ::npos, "Syntax error");
+        auto fs = FileSystem::get();
 
-            size_t           begin = pos + typeTokenLen + 1;
-            std::string_view type  = source.substr(begin, eol - begin);
-            type                   = ut::str::trim(type);
+        std::filesystem::path includePath = (filePath.parent_path() / includeName).lexically_normal();
+        if (!fs->isFileExists(shaderStoragePath + "/" + includePath.generic_string())) {
+            includePath = std::filesystem::path(includeName).lexically_normal();
+        }
+
+        std::string content;
+        if (!fs->readFileToString(shaderStoragePath + "/" + includePath.generic_string(), content)) {
+            NE_CORE_ERROR("Failed to resolve #include \"{}\" in {}", includeName, filePath.generic_string());
+            return false;
+        }
 
-            EShaderStage::T shader_type = EShaderStage::fromString(type);
-            NE_CORE_ASSERT(shader_type, "Invalid shader type specific");
+        if (dependencies) {
+            auto name = includePath.generic_string();
+            if (std::find(dependencies->begin(), dependencies->end(), name) == dependencies->end()) {
+                dependencies->push_back(std::move(name));
+            }
+        }
+
+        if (!expandIncludes(includePath, content, out, dependencies, depth + 1)) {
+            return false;
+        }
+        if (!out.empty() && out.back() != '\n') {
+            out += '\n';
+        }
+    }
+    return true;
+}
 
-            // get the shader content range
-            size_t nextLinePos = source.find_first_not_of(eolFlag, eol);
+std::optional<GLSLScriptProcessor::stage2source_t> GLSLScriptProcessor::splitStages(std::string_view source)
+{
+    stage2source_t shaderSources;
 
-            pos          = source.find(typeToken, nextLinePos);
-            size_t count = (nextLinePos == std::string ::npos ? source.size() - 1 : nextLinePos);
+    // We split the source by "#type <vertex/fragment>" preprocessing directives
+    std::string_view typeToken    = "#type";
+    const size_t     typeTokenLen = typeToken.size();
+    size_t           pos          = source.find(typeToken, 0);
 
-            std::string codes = std::string(source.substr(nextLinePos, pos - count));
+    while (pos != std::string ::npos)
+    {
+        // get the type string
+        size_t eol = source.find_first_of(eolFlag, pos);
+        if (eol == std::string::npos) {
+            NE_CORE_ERROR("Syntax error: missing shader stage after #type");
+            return {};
+        }
 
-            auto [_, Ok] = shaderSources.insert({shader_type, codes});
+        size_t           begin = pos + typeTokenLen + 1;
+        std::string_view type  = source.substr(begin, eol - begin);
+        type                   = ut::str::trim(type);
 
-            NE_CORE_ASSERT(Ok, "Failed to insert this shader source");
+        EShaderStage::T shader_type = EShaderStage::fromString(type);
+        if (shader_type == EShaderStage::Undefined) {
+            NE_CORE_ERROR("Unknown shader stage '#type {}', expected vertex, fragment or pixel", type);
+            return {};
+        }
+
+        // get the shader content range
+        size_t nextLinePos = source.find_first_not_of(eolFlag, eol);
+
+        pos          = source.find(typeToken, nextLinePos);
+        size_t count = (nextLinePos == std::string ::npos ? source.size() - 1 : nextLinePos);
+
+        std::string codes = std::string(source.substr(nextLinePos, pos - count));
+
+        auto [_, Ok] = shaderSources.insert({shader_type, codes});
+        if (!Ok) {
+            NE_CORE_ERROR("Duplicated shader stage {}", EShaderStage::T2Strings[shader_type]);
+            return {};
         }
     }
 
-    // Record the processing path for reflection logging
-    tempProcessingPath = fullPath;
+    return {std::move(shaderSources)};
+}
 
-    // Compile
-    stage2spirv_t ret;
+std::vector<ShaderPermutation> GLSLScriptProcessor::parsePermutations(std::string_view source)
+{
+    std::vector<ShaderPermutation> ret;
+
+    std::string_view permutationToken = "#permutation";
+    std::string_view header           = source.substr(0, source.find("#type"));
+
+    size_t lineBegin = 0;
+    while (lineBegin < header.size())
     {
-        shaderc::Compiler       compiler;
-        shaderc::CompileOptions options;
-        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
-        options.SetTargetSpirv(shaderc_spirv_version_1_3);
-        const bool optimize = true;
-        if (optimize) {
-            options.SetOptimizationLevel(shaderc_optimization_level_performance);
+        size_t lineEnd = header.find('\n', lineBegin);
+        lineEnd        = lineEnd == std::string_view::npos ? header.size() : lineEnd;
+
+        std::string_view line = ut::str::trim(header.substr(lineBegin, lineEnd - lineBegin));
+        lineBegin             = lineEnd + 1;
+        if (!line.starts_with(permutationToken)) {
+            continue;
         }
 
+        std::vector<std::string> defines;
+        std::string_view         rest = line.substr(permutationToken.size());
+        size_t                   pos  = 0;
+        while ((pos = rest.find_first_not_of(" \t\r", pos)) != std::string_view::npos) {
+            size_t end = rest.find_first_of(" \t\r", pos);
+            end        = end == std::string_view::npos ? rest.size() : end;
+            defines.emplace_back(rest.substr(pos, end - pos));
+            pos = end;
+        }
 
-        for (auto &&[stage, source] : shaderSources)
-        {
-            // recompile
-            shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
-                source,
-                EShaderStage::toShadercType(stage),
-                std::format("{} ({})", fullPath, EShaderStage::T2Strings[stage]).c_str(),
-                stage == EShaderStage::Vertex ? "vs_main\0" : "fs_main\0",
-                options);
-
-            if (result.GetCompilationStatus() != shaderc_compilation_status_success)
-            {
-                NE_CORE_ERROR("\n{}", result.GetErrorMessage());
-                NE_CORE_ASSERT(false, "Shader compilation failed!");
-            }
+        ShaderPermutation permutation(std::move(defines));
+        if (std::none_of(ret.begin(), ret.end(), [&](const ShaderPermutation &p) { return p.defines == permutation.defines; })) {
+            ret.push_back(std::move(permutation));
+        }
+    }
+
+    if (ret.empty()) {
+        ret.emplace_back();
+    }
+    return ret;
+}
 
-            // store compile result into memory
-            ret[stage] = spirv_ir_t(result.begin(), result.end());
+std::optional<GLSLScriptProcessor::spirv_ir_t> GLSLScriptProcessor::compileStage(std::string_view debugName, EShaderStage::T stage, const std::string &source, const ShaderPermutation &permutation)
+{
+#if NE_WITH_SHADER_COMPILER
+    // shaderc::Compiler is not safe to share across threads, keep one per worker thread
+    thread_local shaderc::Compiler compiler;
+
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+    options.SetTargetSpirv(shaderc_spirv_version_1_3);
+    const bool optimize = true;
+    if (optimize) {
+        options.SetOptimizationLevel(shaderc_optimization_level_performance);
+    }
+    for (const auto &define : permutation.defines) {
+        // "NAME" or "NAME=VALUE"
+        size_t eq = define.find('=');
+        if (eq == std::string::npos) {
+            options.AddMacroDefinition(define);
+        }
+        else {
+            options.AddMacroDefinition(define.substr(0, eq), define.substr(eq + 1));
         }
     }
 
-    // Validate SPIR-V magic number
-    for (auto &[stage, spirv] : ret) {
-        if (spirv.empty() || spirv[0] != 0x07230203) {
-            NE_CORE_ERROR("Invalid SPIR-V module for stage {}: Missing or incorrect magic number.", EShaderStage::T2Strings[stage]);
-            NE_CORE_ASSERT(false, "SPIR-V validation failed for stage {}", EShaderStage::T2Strings[stage]);
+    shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(
+        source,
+        EShaderStage::toShadercType(stage),
+        std::format("{} ({})", debugName, EShaderStage::T2Strings[stage]).c_str(),
+        stage == EShaderStage::Vertex ? "vs_main\0" : "fs_main\0",
+        options);
+
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        NE_CORE_ERROR("\n{}", result.GetErrorMessage());
+        return {};
+    }
+
+    spirv_ir_t spirv(result.begin(), result.end());
+
+    std::string error;
+    if (!validateSpirv(spirv, &error)) {
+        NE_CORE_ERROR("Invalid SPIR-V module for stage {}: {}", EShaderStage::T2Strings[stage], error);
+        return {};
+    }
+    return {std::move(spirv)};
+#else
+    NE_CORE_ERROR("Cannot compile {}: built without the shader compiler, cook the shader library instead", debugName);
+    return {};
+#endif
+}
+
+bool GLSLScriptProcessor::validateSpirv(const spirv_ir_t &spirv, std::string *error)
+{
+    auto fail = [error](std::string message) {
+        if (error) {
+            *error = std::move(message);
+        }
+        return false;
+    };
+
+    // magic, version, generator, bound, schema
+    static constexpr std::size_t HEADER_WORDS = 5;
+    if (spirv.size() < HEADER_WORDS) {
+        return fail("module is shorter than the header");
+    }
+    if (spirv[0] != 0x07230203) {
+        return fail("missing or incorrect magic number");
+    }
+    uint32_t major = (spirv[1] >> 16) & 0xFF;
+    uint32_t minor = (spirv[1] >> 8) & 0xFF;
+    if (major != 1 || minor > 6) {
+        return fail(std::format("unsupported version {}.{}", major, minor));
+    }
+    if (spirv[3] == 0) {
+        return fail("id bound is 0");
+    }
+    if (spirv[4] != 0) {
+        return fail("reserved schema word is not 0");
+    }
+
+    // every instruction starts with (word count << 16 | opcode)
+    std::size_t cursor = HEADER_WORDS;
+    while (cursor < spirv.size()) {
+        uint32_t wordCount = spirv[cursor] >> 16;
+        if (wordCount == 0) {
+            return fail(std::format("instruction at word {} has a word count of 0", cursor));
+        }
+        if (cursor + wordCount > spirv.size()) {
+            return fail(std::format("instruction at word {} runs past the end of the module", cursor));
+        }
+        cursor += wordCount;
+    }
+    return true;
+}
+
+std::optional<GLSLScriptProcessor::stage2spirv_t> GLSLScriptProcessor::process(std::string_view fileName, const ShaderPermutation &permutation)
+{
+    std::string contentStr;
+    if (!readSource(fileName, contentStr)) {
+        return {};
+    }
+
+    // Skip the whole compilation if the source is unchanged since the last run
+    const std::string cacheName  = permutation.variantName(fileName);
+    const uint64_t    sourceHash = Hash::fnv1a64(contentStr, Hash::fnv1a64(permutation.key()));
+    if (auto cached = loadSpirvCache(cacheName, sourceHash)) {
+        return cached;
+    }
+
+    // Preprocess
+    auto shaderSources = splitStages(contentStr);
+    if (!shaderSources) {
+        return {};
+    }
+
+    // Compile
+    stage2spirv_t ret;
+    for (auto &&[stage, source] : *shaderSources)
+    {
+        auto spirv = compileStage(tempProcessingPath, stage, source, permutation);
+        if (!spirv) {
+            NE_CORE_ERROR("Shader compilation failed: {} [{}]", tempProcessingPath, permutation.key());
+            return {};
         }
+        // store compile result into memory
+        ret[stage] = std::move(*spirv);
     }
 
+    saveSpirvCache(cacheName, sourceHash, ret);
 
     return {std::move(ret)};
 }
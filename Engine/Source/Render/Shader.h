@@ -1,17 +1,24 @@
 #pragma once
 #include <cstdint>
 #include <filesystem>
+#include <initializer_list>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "SDL3/SDL_storage.h"
 #include <SDL3/SDL_gpu.h>
 
-#include <spirv_cross/spirv_cross.hpp>
-
 #include "../Core/Log.h"
 
 #include "reflect.cc/enum"
+
+// shaderc + SPIRV-Cross are linked in, shipping builds turn this off and only load the cooked ShaderLibrary
+#ifndef NE_WITH_SHADER_COMPILER
+    #define NE_WITH_SHADER_COMPILER 1
+#endif
+
 namespace EShaderStage
 {
 enum T
@@ -24,6 +31,7 @@ enum T
 
 GENERATED_ENUM_MISC(T);
 
+// Undefined for an unknown name, the callers report it with the file it came from
 inline T fromString(std::string_view type)
 {
     if (type == "vertex")
@@ -35,7 +43,6 @@ inline T fromString(std::string_view type)
         return EShaderStage::Fragment;
     }
 
-    NE_CORE_ASSERT(false, "Unknown shader type! {}", type);
     return EShaderStage::Undefined;
 }
 
@@ -87,7 +94,8 @@ struct UniformBufferMember
 
 struct UniformBuffer
 {
-    std::string                      name;
+    std::string                      name;         // block type, e.g. LightBuffer
+    std::string                      instanceName; // e.g. uLight, what the C++ mirrors are keyed by
     uint32_t                         set;
     uint32_t                         binding;
     uint32_t                         size;
@@ -109,24 +117,40 @@ struct ShaderResources
     std::vector<StageIOData>   outputs;
     std::vector<UniformBuffer> uniformBuffers;
     std::vector<Resource>      sampledImages;
-
-    // Original SPIRV-Cross resources
-    spirv_cross::ShaderResources spirvResources;
+    std::vector<Resource>      storageBuffers; // readonly buffers, e.g. the per-draw data of SDLUniformRing
 };
 
 // Utility functions for shader reflection
-DataType                   SpirType2DataType(const spirv_cross::SPIRType &type);
 SDL_GPUVertexElementFormat DataType2SDLFormat(DataType type);
 uint32_t                   getDataTypeSize(DataType type);
+
+// Compact binary form of the reflected data, cached next to the SPIR-V so we do not need SPIRV-Cross at startup
+// `spirvHash` is the hash of the SPIR-V that produced the resources, used to validate the cache
+void serialize(const ShaderResources &resources, uint64_t spirvHash, std::vector<uint8_t> &out);
+bool deserialize(const uint8_t *data, std::size_t size, std::size_t &cursor, ShaderResources &out, uint64_t &spirvHash);
 } // namespace ShaderReflection
 
-namespace SPIRVHelper
+
+
+// Preprocessor defines a shader variant is compiled with, e.g. {"TEXTURED", "LIT"} or {"MAX_LIGHTS=4"}.
+// Kept sorted and unique, so the same set of defines always maps to the same variant
+struct ShaderPermutation
 {
-extern SDL_GPUVertexElementFormat spirvType2SDLFormat(const spirv_cross::SPIRType &type);
-extern uint32_t                   getVertexAlignedOffset(uint32_t current_offset, const spirv_cross::SPIRType &type);
-extern uint32_t                   getSpirvTypeSize(const spirv_cross::SPIRType &type);
-} // namespace SPIRVHelper
+    std::vector<std::string> defines;
+
+    ShaderPermutation() = default;
+    ShaderPermutation(std::vector<std::string> defines);
+    ShaderPermutation(std::initializer_list<std::string> defines) : ShaderPermutation(std::vector<std::string>(defines)) {}
+
+    bool empty() const { return defines.empty(); }
 
+    // "LIT;TEXTURED", empty for the default variant
+    std::string key() const;
+    // 0 for the default variant
+    uint64_t hash() const;
+    // name used for the cache files, `fileName` itself for the default variant, `fileName.<hash>` otherwise
+    std::string variantName(std::string_view fileName) const;
+};
 
 
 struct Shader
@@ -154,12 +178,21 @@ struct ShaderScriptProcessor
     std::string tempProcessingPath;
 
   public:
-    using ir_t          = uint32_t;
-    using spirv_ir_t    = std::vector<ir_t>;
-    using stage2spirv_t = std::unordered_map<EShaderStage::T, spirv_ir_t>;
+    using ir_t               = uint32_t;
+    using spirv_ir_t         = std::vector<ir_t>;
+    using stage2spirv_t      = std::unordered_map<EShaderStage::T, spirv_ir_t>;
+    using stage2reflection_t = std::unordered_map<EShaderStage::T, ShaderReflection::ShaderResources>;
+    using stage2source_t     = std::unordered_map<EShaderStage::T, std::string>;
+
+    virtual std::optional<stage2spirv_t>                    process(std::string_view fileName, const ShaderPermutation &permutation = {}) = 0;
+    [[nodiscard]] virtual ShaderReflection::ShaderResources reflect(EShaderStage::T stage, const std::vector<ir_t> &spirvData)            = 0;
+
+    // Load the reflection sidecar of `fileName` (the variant name, see ShaderPermutation::variantName) if it matches the given SPIR-V,
+    // otherwise reflect the stale stages and rewrite the sidecar
+    [[nodiscard]] stage2reflection_t reflectWithCache(std::string_view fileName, const stage2spirv_t &spirv);
 
-    virtual std::optional<stage2spirv_t>                    process(std::string_view fileName)                                 = 0;
-    [[nodiscard]] virtual ShaderReflection::ShaderResources reflect(EShaderStage::T stage, const std::vector<ir_t> &spirvData) = 0;
+  protected:
+    std::string getReflectionCachePath(std::string_view fileName) const;
 };
 
 
@@ -187,17 +220,36 @@ struct GLSLScriptProcessor : public ShaderScriptProcessor
 
   public:
 
-    std::optional<stage2spirv_t>      process(std::string_view fileName) override;
+    static constexpr int MAX_INCLUDE_DEPTH = 16;
+
+    std::optional<stage2spirv_t>      process(std::string_view fileName, const ShaderPermutation &permutation = {}) override;
     ShaderReflection::ShaderResources reflect(EShaderStage::T stage, const std::vector<ir_t> &spirvData) override;
 
+    // The phases of `process`, exposed so the build service can run the stages concurrently.
+    // `readSource` expands the `#include "..."` directives, so the hash of its output covers the included files too,
+    // the included paths (relative to the shader dir) are appended to `dependencies`
+    bool                                 readSource(std::string_view fileName, std::string &out, std::vector<std::string> *dependencies = nullptr);
+    static std::optional<stage2source_t> splitStages(std::string_view source);
+    // The variants declared with `#permutation DEFINE_A DEFINE_B ...` lines before the first `#type`,
+    // a bare `#permutation` declares the default variant. Only the default one if there is no declaration
+    static std::vector<ShaderPermutation> parsePermutations(std::string_view source);
+    static std::optional<spirv_ir_t>     compileStage(std::string_view debugName, EShaderStage::T stage, const std::string &source, const ShaderPermutation &permutation = {});
+    // Structural check of a module: header, version, id bound and that every instruction fits in the module.
+    // Not a full spirv-val, it catches truncated or corrupted binaries (e.g. a broken cache file)
+    static bool validateSpirv(const spirv_ir_t &spirv, std::string *error = nullptr);
+    // `cacheName` is the variant name, see ShaderPermutation::variantName
+    std::optional<stage2spirv_t> loadSpirvCache(std::string_view cacheName, uint64_t sourceHash);
+    void                         saveSpirvCache(std::string_view cacheName, uint64_t sourceHash, const stage2spirv_t &spirv);
+
   private:
+    bool expandIncludes(const std::filesystem::path &filePath, std::string_view source, std::string &out, std::vector<std::string> *dependencies, int depth);
 
 
     void CreateGLBinaries(bool bSourceChanged);
     void CreateVulkanBinaries(const std::unordered_map<EShaderStage::T, std::string> &shader_sources, bool bSourceChanged);
 
-    std::filesystem::path GetCachePath(bool bVulkan, EShaderStage::T stage);
-    std::filesystem::path GetCacheMetaPath();
+    std::filesystem::path GetCachePath(std::string_view fileName, bool bVulkan, EShaderStage::T stage);
+    std::filesystem::path GetCacheMetaPath(std::string_view fileName);
 };
 
 
@@ -234,6 +286,16 @@ struct ShaderScriptProcessorFactory
     }
 
 
+    // engine default locations of the glsl sources and their compiled cache
+    static Self defaultGLSL()
+    {
+        Self factory;
+        factory.withProcessorType(EProcessorType::GLSL)
+            .withShaderStoragePath("Engine/Shader/GLSL")
+            .withCachedStoragePath("Engine/Intermediate/Shader/GLSL");
+        return factory;
+    }
+
     std::shared_ptr<ShaderScriptProcessor> FactoryNew()
     {
         std::shared_ptr<ShaderScriptProcessor> processor;
@@ -0,0 +1,224 @@
+#include "ShaderBuildService.h"
+
+#include <atomic>
+#include <optional>
+
+#include "Core/Hash.h"
+#include "Core/Log.h"
+
+
+
+ShaderBuildService *ShaderBuildService::instance = nullptr;
+
+struct ShaderBuildService::Request
+{
+    std::promise<CompiledShaderPtr>  promise;
+    CompiledShaderFuture             future;
+    std::mutex                       mutex;
+    bool                             bDone = false;
+    std::vector<ShaderReadyCallback> continuations; // whenReady() callers waiting on this build
+};
+
+struct ShaderBuildService::BuildState
+{
+    std::string                                      name;
+    ShaderPermutation                                permutation;
+    std::string                                      cacheName;
+    std::vector<std::string>                         dependencies;
+    std::shared_ptr<GLSLScriptProcessor>             processor;
+    std::shared_ptr<Request>                         request;
+    uint64_t                                         sourceHash = 0;
+    bool                                             bFromCache = false;
+    std::mutex                                       mutex;
+    ShaderScriptProcessor::stage2spirv_t             spirv;
+    std::atomic<int>                                 remaining = 0;
+    std::atomic<bool>                                bFailed   = false;
+};
+
+void ShaderBuildService::init()
+{
+    instance = new ShaderBuildService();
+    NE_CORE_INFO("ShaderBuildService started with {} workers", instance->pool.size());
+}
+
+void ShaderBuildService::shutdown()
+{
+    // joins the workers, pending builds are finished first
+    delete instance;
+    instance = nullptr;
+}
+
+std::shared_ptr<ShaderBuildService::Request> ShaderBuildService::findOrStart(std::string_view shaderName, const ShaderPermutation &permutation, bool bForceRebuild)
+{
+    std::string name(shaderName);
+    std::string key = variantKey(name, permutation);
+
+    auto request    = std::make_shared<Request>();
+    request->future = request->promise.get_future().share();
+    {
+        std::lock_guard lock(mutex);
+        if (!bForceRebuild) {
+            if (auto it = requests.find(key); it != requests.end()) {
+                return it->second;
+            }
+        }
+        requests[key] = request;
+    }
+
+    pool.enqueue([this, name, permutation, request]() { build(name, permutation, request); });
+    return request;
+}
+
+CompiledShaderFuture ShaderBuildService::request(std::string_view shaderName, const ShaderPermutation &permutation, bool bForceRebuild)
+{
+    return findOrStart(shaderName, permutation, bForceRebuild)->future;
+}
+
+std::vector<CompiledShaderFuture> ShaderBuildService::requestAll(const std::vector<ShaderCreateInfo> &shaderCIs)
+{
+    std::vector<CompiledShaderFuture> ret;
+    ret.reserve(shaderCIs.size());
+    for (const auto &shaderCI : shaderCIs) {
+        ret.push_back(request(shaderCI));
+    }
+    return ret;
+}
+
+void ShaderBuildService::whenReady(const ShaderCreateInfo &shaderCI, ShaderReadyCallback onReady)
+{
+    auto request = findOrStart(shaderCI.shaderName, shaderCI.defines, false);
+    {
+        std::lock_guard lock(request->mutex);
+        if (!request->bDone) {
+            request->continuations.push_back(std::move(onReady));
+            return;
+        }
+    }
+    onReady(request->future.get());
+}
+
+void ShaderBuildService::complete(Request &request, CompiledShaderPtr compiled)
+{
+    request.promise.set_value(compiled);
+
+    std::vector<ShaderReadyCallback> continuations;
+    {
+        std::lock_guard lock(request.mutex);
+        request.bDone = true;
+        continuations.swap(request.continuations);
+    }
+    for (auto &onReady : continuations) {
+        onReady(compiled);
+    }
+}
+
+void ShaderBuildService::build(std::string name, ShaderPermutation permutation, std::shared_ptr<Request> request)
+{
+    auto state         = std::make_shared<BuildState>();
+    state->name        = name;
+    state->cacheName   = permutation.variantName(name);
+    state->permutation = std::move(permutation);
+    state->request     = request;
+    state->processor   = std::static_pointer_cast<GLSLScriptProcessor>(ShaderScriptProcessorFactory::defaultGLSL().FactoryNew());
+
+    // a throwing task would leave the promise unset and every waiter blocked, report it as a failed build instead
+    std::optional<GLSLScriptProcessor::stage2source_t> sources;
+    try {
+        std::string content;
+        if (!state->processor->readSource(name, content, &state->dependencies)) {
+            fail(state->name, state->permutation, request);
+            return;
+        }
+
+        // the defines are part of the hash, each variant has its own cache files named by `cacheName`
+        state->sourceHash = Hash::fnv1a64(content, Hash::fnv1a64(state->permutation.key()));
+        if (auto cached = state->processor->loadSpirvCache(state->cacheName, state->sourceHash)) {
+            state->spirv      = std::move(*cached);
+            state->bFromCache = true;
+            finish(state);
+            return;
+        }
+
+        sources = GLSLScriptProcessor::splitStages(content);
+    }
+    catch (const std::exception &e) {
+        NE_CORE_ERROR("Shader build of {} [{}] threw: {}", state->name, state->permutation.key(), e.what());
+        fail(state->name, state->permutation, request);
+        return;
+    }
+    if (!sources || sources->empty()) {
+        NE_CORE_ERROR("No shader stage found in {}", name);
+        fail(state->name, state->permutation, request);
+        return;
+    }
+
+    // fan out one task per stage, the last one to finish joins the results
+    state->remaining = static_cast<int>(sources->size());
+    for (auto &[stage, source] : *sources)
+    {
+        pool.enqueue([this, state, stage = stage, source = std::move(source)]() {
+            try {
+                auto spirv = GLSLScriptProcessor::compileStage(state->processor->tempProcessingPath, stage, source, state->permutation);
+                if (spirv) {
+                    std::lock_guard lock(state->mutex);
+                    state->spirv[stage] = std::move(*spirv);
+                }
+                else {
+                    state->bFailed = true;
+                }
+            }
+            catch (const std::exception &e) {
+                NE_CORE_ERROR("Compiling the {} stage of {} threw: {}", EShaderStage::T2Strings[stage], state->name, e.what());
+                state->bFailed = true;
+            }
+
+            if (--state->remaining == 0) {
+                finish(state);
+            }
+        });
+    }
+}
+
+void ShaderBuildService::finish(std::shared_ptr<BuildState> state)
+{
+    if (state->bFailed) {
+        NE_CORE_ERROR("Shader compilation failed: {} [{}]", state->name, state->permutation.key());
+        fail(state->name, state->permutation, state->request);
+        return;
+    }
+
+    auto compiled = std::make_shared<CompiledShader>();
+    try {
+        if (!state->bFromCache) {
+            state->processor->saveSpirvCache(state->cacheName, state->sourceHash, state->spirv);
+        }
+
+        compiled->name         = state->name;
+        compiled->permutation  = state->permutation;
+        compiled->dependencies = std::move(state->dependencies);
+        compiled->resources    = state->processor->reflectWithCache(state->cacheName, state->spirv);
+        compiled->spirv        = std::move(state->spirv);
+    }
+    catch (const std::exception &e) {
+        NE_CORE_ERROR("Reflecting {} [{}] threw: {}", state->name, state->permutation.key(), e.what());
+        fail(state->name, state->permutation, state->request);
+        return;
+    }
+
+    NE_CORE_TRACE("Shader build finished: {} [{}]", state->name, state->permutation.key());
+    complete(*state->request, std::move(compiled));
+}
+
+void ShaderBuildService::fail(const std::string &name, const ShaderPermutation &permutation, const std::shared_ptr<Request> &request)
+{
+    {
+        // not cached, the next request tries again (e.g. once the source is fixed). The entry is only dropped
+        // if it is still this failed build, a forced rebuild may have replaced it meanwhile
+        std::lock_guard lock(mutex);
+        auto            it = requests.find(variantKey(name, permutation));
+        if (it != requests.end() && it->second == request) {
+            requests.erase(it);
+        }
+    }
+    complete(*request, nullptr);
+}
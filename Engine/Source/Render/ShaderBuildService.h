@@ -0,0 +1,71 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/ThreadPool.h"
+#include "Render/Render.h"
+#include "Render/Shader.h"
+
+struct CompiledShader
+{
+    std::string                               name;
+    ShaderPermutation                         permutation;
+    std::vector<std::string>                  dependencies; // included files, relative to the shader dir
+    ShaderScriptProcessor::stage2spirv_t      spirv;
+    ShaderScriptProcessor::stage2reflection_t resources;
+};
+
+using CompiledShaderPtr    = std::shared_ptr<const CompiledShader>;
+using CompiledShaderFuture = std::shared_future<CompiledShaderPtr>; // holds nullptr if the build failed
+using ShaderReadyCallback  = std::function<void(const CompiledShaderPtr &)>;
+
+// Compiles shaders on a worker pool: each stage of each requested file is its own task,
+// and every worker keeps its own shaderc::Compiler (see GLSLScriptProcessor::compileStage).
+// Requests for the same shader variant share one build, variants are only compiled when first requested
+// and stay in memory until they are rebuilt. Failed builds are not kept, the next request tries again.
+class ShaderBuildService
+{
+    static ShaderBuildService *instance;
+
+    struct Request;
+
+    ThreadPool                                                pool{"ShaderBuild"};
+    std::mutex                                                mutex;
+    std::unordered_map<std::string, std::shared_ptr<Request>> requests;
+
+  public:
+    static void                init();
+    static void                shutdown();
+    static ShaderBuildService *get() { return instance; }
+
+    // Returns the in-flight/finished build of the `shaderName` variant, starts one if there is none.
+    // `bForceRebuild` drops the previous result, e.g. when the source changed on disk
+    CompiledShaderFuture request(std::string_view shaderName, const ShaderPermutation &permutation = {}, bool bForceRebuild = false);
+    CompiledShaderFuture request(const ShaderCreateInfo &shaderCI, bool bForceRebuild = false)
+    {
+        return request(shaderCI.shaderName, shaderCI.defines, bForceRebuild);
+    }
+    std::vector<CompiledShaderFuture> requestAll(const std::vector<ShaderCreateInfo> &shaderCIs);
+
+    // Like request(), but instead of a future `onReady` gets the result (nullptr if the build failed): right away when
+    // the variant is already built, otherwise on the worker finishing it, so hand anything long to another pool.
+    // Lets the callers start on each shader as it finishes instead of waiting on them in submission order
+    void whenReady(const ShaderCreateInfo &shaderCI, ShaderReadyCallback onReady);
+
+  private:
+    struct BuildState;
+
+    std::shared_ptr<Request> findOrStart(std::string_view shaderName, const ShaderPermutation &permutation, bool bForceRebuild);
+    void                     build(std::string name, ShaderPermutation permutation, std::shared_ptr<Request> request);
+    void                     finish(std::shared_ptr<BuildState> state);
+    void                     fail(const std::string &name, const ShaderPermutation &permutation, const std::shared_ptr<Request> &request);
+    static void              complete(Request &request, CompiledShaderPtr compiled);
+
+    static std::string variantKey(const std::string &name, const ShaderPermutation &permutation) { return name + "|" + permutation.key(); }
+};
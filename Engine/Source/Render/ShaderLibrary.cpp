@@ -0,0 +1,195 @@
+#include "ShaderLibrary.h"
+
+#include <cstring>
+
+#include "Core/FileSystem/BinaryStream.h"
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/Hash.h"
+#include "Core/Log.h"
+
+
+
+ShaderLibrary *ShaderLibrary::instance = nullptr;
+
+void ShaderLibrary::init(std::string_view path)
+{
+    if (!FileSystem::get()->isFileExists(std::string(path))) {
+        NE_CORE_WARN("No cooked shader library at {}", path);
+        return;
+    }
+
+    auto library = new ShaderLibrary();
+    if (!library->load(path)) {
+        delete library;
+        return;
+    }
+    instance = library;
+    NE_CORE_INFO("Loaded shader library {} with {} variants", path, instance->size());
+}
+
+void ShaderLibrary::shutdown()
+{
+    delete instance;
+    instance = nullptr;
+}
+
+bool ShaderLibrary::load(std::string_view path)
+{
+    if (!FileSystem::get()->readFileToString(path, data)) {
+        return false;
+    }
+
+    BinaryReader reader(data);
+    uint32_t     magic = 0, version = 0, entryCount = 0, blobOffset = 0;
+    reader.read(magic);
+    reader.read(version);
+    reader.read(entryCount);
+    reader.read(blobOffset);
+    if (!reader.bOk || magic != MAGIC || version != VERSION || blobOffset > data.size()) {
+        NE_CORE_ERROR("Invalid shader library: {}", path);
+        return false;
+    }
+
+    entries.clear();
+    for (uint32_t i = 0; i < entryCount; ++i)
+    {
+        Entry       entry;
+        std::string permutationKey;
+        uint32_t    stageCount = 0;
+        reader.readString(entry.name);
+        reader.readString(permutationKey);
+        reader.read(stageCount);
+
+        for (uint32_t s = 0; s < stageCount && reader.bOk; ++s)
+        {
+            uint32_t    stage = 0;
+            StageRecord record{};
+            reader.read(stage);
+            reader.read(record.spirvOffset);
+            reader.read(record.spirvSize);
+            reader.read(record.reflectionOffset);
+            reader.read(record.reflectionSize);
+
+            bool bInRange = uint64_t(record.spirvOffset) + record.spirvSize <= data.size() &&
+                            uint64_t(record.reflectionOffset) + record.reflectionSize <= data.size();
+            if (stage >= EShaderStage::ENUM_MAX || !bInRange || record.spirvOffset % sizeof(ShaderScriptProcessor::ir_t) != 0) {
+                reader.bOk = false;
+                break;
+            }
+            record.stage = static_cast<EShaderStage::T>(stage);
+            entry.stages.push_back(record);
+        }
+
+        if (!reader.bOk) {
+            NE_CORE_ERROR("Corrupted shader library: {}", path);
+            entries.clear();
+            return false;
+        }
+
+        // the key was normalized by the cooker, split it back into the defines
+        std::vector<std::string> defines;
+        for (size_t begin = 0; begin < permutationKey.size();) {
+            size_t end = permutationKey.find(';', begin);
+            end        = end == std::string::npos ? permutationKey.size() : end;
+            defines.push_back(permutationKey.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        entry.permutation = ShaderPermutation(std::move(defines));
+
+        std::string key = entryKey(entry.name, entry.permutation);
+        entries.emplace(std::move(key), std::move(entry));
+    }
+    return true;
+}
+
+CompiledShaderPtr ShaderLibrary::find(std::string_view shaderName, const ShaderPermutation &permutation) const
+{
+    auto it = entries.find(entryKey(shaderName, permutation));
+    if (it == entries.end()) {
+        return nullptr;
+    }
+
+    const Entry    &entry = it->second;
+    std::lock_guard lock(mutex);
+    if (entry.compiled) {
+        return entry.compiled;
+    }
+
+    auto compiled         = std::make_shared<CompiledShader>();
+    compiled->name        = entry.name;
+    compiled->permutation = entry.permutation;
+    for (const auto &record : entry.stages)
+    {
+        auto &spirv = compiled->spirv[record.stage];
+        spirv.resize(record.spirvSize / sizeof(ShaderScriptProcessor::ir_t));
+        std::memcpy(spirv.data(), data.data() + record.spirvOffset, record.spirvSize);
+
+        std::size_t cursor    = record.reflectionOffset;
+        uint64_t    spirvHash = 0;
+        if (!ShaderReflection::deserialize(reinterpret_cast<const uint8_t *>(data.data()), record.reflectionOffset + record.reflectionSize,
+                                           cursor, compiled->resources[record.stage], spirvHash))
+        {
+            NE_CORE_ERROR("Corrupted reflection data of {} in the shader library", entry.name);
+            return nullptr;
+        }
+    }
+
+    entry.compiled = compiled;
+    return compiled;
+}
+
+void ShaderLibrary::write(const std::vector<CompiledShaderPtr> &shaders, std::vector<uint8_t> &out)
+{
+    // The blob offsets are relative while building, the table is rebased once its size is known
+    BinaryWriter         table;
+    std::vector<uint8_t> blob;
+    std::vector<size_t>  patchPositions; // positions in `table` of the offsets to rebase
+
+    for (const auto &shader : shaders)
+    {
+        table.writeString(shader->name);
+        table.writeString(shader->permutation.key());
+        table.write<uint32_t>(static_cast<uint32_t>(shader->spirv.size()));
+
+        for (const auto &[stage, spirv] : shader->spirv)
+        {
+            uint32_t spirvOffset = static_cast<uint32_t>(blob.size());
+            uint32_t spirvSize   = static_cast<uint32_t>(spirv.size() * sizeof(ShaderScriptProcessor::ir_t));
+            blob.insert(blob.end(), reinterpret_cast<const uint8_t *>(spirv.data()), reinterpret_cast<const uint8_t *>(spirv.data()) + spirvSize);
+
+            uint32_t reflectionOffset = static_cast<uint32_t>(blob.size());
+            ShaderReflection::serialize(shader->resources.at(stage), Hash::fnv1a64(spirv.data(), spirvSize), blob);
+            uint32_t reflectionSize = static_cast<uint32_t>(blob.size()) - reflectionOffset;
+            blob.resize((blob.size() + 3) & ~size_t(3)); // keep the next SPIR-V aligned
+
+            table.write<uint32_t>(stage);
+            patchPositions.push_back(table.buffer.size());
+            table.write(spirvOffset);
+            table.write(spirvSize);
+            patchPositions.push_back(table.buffer.size());
+            table.write(reflectionOffset);
+            table.write(reflectionSize);
+        }
+    }
+
+    constexpr size_t headerSize = sizeof(uint32_t) * 4;
+    const uint32_t   blobOffset = static_cast<uint32_t>((headerSize + table.buffer.size() + 3) & ~size_t(3));
+
+    for (size_t pos : patchPositions) {
+        uint32_t offset = 0;
+        std::memcpy(&offset, table.buffer.data() + pos, sizeof(offset));
+        offset += blobOffset;
+        std::memcpy(table.buffer.data() + pos, &offset, sizeof(offset));
+    }
+
+    BinaryWriter writer;
+    writer.write(MAGIC);
+    writer.write(VERSION);
+    writer.write<uint32_t>(static_cast<uint32_t>(shaders.size()));
+    writer.write(blobOffset);
+    writer.writeBytes(table.buffer.data(), table.buffer.size());
+    writer.buffer.resize(blobOffset);
+    writer.writeBytes(blob.data(), blob.size());
+
+    out = std::move(writer.buffer);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Render/ShaderBuildService.h"
+
+// The cooked shader pack written by `neon-shadercook`: every stage of every declared permutation
+// with its reflection data, so the runtime needs neither shaderc nor SPIRV-Cross.
+//
+// Layout (all offsets from the start of the file, SPIR-V 4 byte aligned):
+//   header   magic "NSLB", version, entry count, blob offset
+//   entries  name, permutation key, stage count, then per stage: stage, spirv offset/size, reflection offset/size
+//   blob     SPIR-V words and serialized ShaderReflection::ShaderResources
+class ShaderLibrary
+{
+    static ShaderLibrary *instance;
+
+    struct StageRecord
+    {
+        EShaderStage::T stage;
+        uint32_t        spirvOffset;
+        uint32_t        spirvSize;
+        uint32_t        reflectionOffset;
+        uint32_t        reflectionSize;
+    };
+
+    struct Entry
+    {
+        std::string               name;
+        ShaderPermutation         permutation;
+        std::vector<StageRecord>  stages;
+        mutable CompiledShaderPtr compiled; // unpacked on first use
+    };
+
+    std::string                            data; // the whole pack, read at once
+    std::unordered_map<std::string, Entry> entries;
+    mutable std::mutex                     mutex;
+
+  public:
+    static constexpr uint32_t         MAGIC        = 0x424C534E; // "NSLB"
+    static constexpr uint32_t         VERSION      = 3; // 2: storage buffers in the reflection data, 3: uniform block instance names
+    static constexpr std::string_view DEFAULT_PATH = "Engine/Intermediate/Shader/ShaderLibrary.nslib";
+
+    // Loads the pack at `path`, the instance stays null if there is none or it is invalid
+    static void           init(std::string_view path = DEFAULT_PATH);
+    static void           shutdown();
+    static ShaderLibrary *get() { return instance; }
+
+    bool load(std::string_view path);
+
+    // nullptr if the variant was not cooked
+    CompiledShaderPtr find(std::string_view shaderName, const ShaderPermutation &permutation = {}) const;
+    CompiledShaderPtr find(const ShaderCreateInfo &shaderCI) const { return find(shaderCI.shaderName, shaderCI.defines); }
+
+    std::size_t size() const { return entries.size(); }
+
+    // Used by the cooker
+    static void write(const std::vector<CompiledShaderPtr> &shaders, std::vector<uint8_t> &out);
+
+  private:
+    static std::string entryKey(std::string_view shaderName, const ShaderPermutation &permutation)
+    {
+        return std::string(shaderName) + "|" + permutation.key();
+    }
+};
@@ -11,9 +11,21 @@ class CommandBuffer;
 
 enum class ETextureFormat
 {
-    R8G8B8A8_UNORM,
-    R8G8B8_UNORM,
-    RGBA32_FLOAT,
+    // the values are stored in .ntex files (see TextureFile), append new formats, never renumber
+    R8G8B8A8_UNORM = 0,
+    R8G8B8_UNORM   = 1,
+    RGBA32_FLOAT   = 2,
+    // block compressed, 4x4 texels per block (see BlockCompression)
+    BC1_RGBA_UNORM = 3,
+    BC3_RGBA_UNORM = 4,
+    BC5_RG_UNORM   = 5,
+    BC7_RGBA_UNORM = 6,
+    // the swapchain formats, render targets only
+    B8G8R8A8_UNORM      = 7,
+    B8G8R8A8_UNORM_SRGB = 8,
+    R8G8B8A8_UNORM_SRGB = 9,
+    R10G10B10A2_UNORM   = 10,
+    RGBA16_FLOAT        = 11,
     // Add more formats as needed
 };
 
@@ -0,0 +1,130 @@
+#include "TextureFile.h"
+
+#include <cstring>
+
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "Core/Log.h"
+
+namespace
+{
+
+uint64_t levelsSize(ETextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    auto levels = TextureFile::layout(format, width, height, mipCount);
+    return levels.empty() ? 0 : levels.back().offset + levels.back().size;
+}
+
+} // namespace
+
+uint32_t TextureFile::bytesPerPixel(ETextureFormat format)
+{
+    switch (format) {
+    case ETextureFormat::R8G8B8A8_UNORM:
+    case ETextureFormat::B8G8R8A8_UNORM:
+    case ETextureFormat::B8G8R8A8_UNORM_SRGB:
+    case ETextureFormat::R8G8B8A8_UNORM_SRGB:
+    case ETextureFormat::R10G10B10A2_UNORM:
+        return 4;
+    case ETextureFormat::R8G8B8_UNORM:
+        return 3;
+    case ETextureFormat::RGBA16_FLOAT:
+        return 8;
+    case ETextureFormat::RGBA32_FLOAT:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+uint32_t TextureFile::blockSize(ETextureFormat format)
+{
+    switch (format) {
+    case ETextureFormat::BC1_RGBA_UNORM:
+        return 8;
+    case ETextureFormat::BC3_RGBA_UNORM:
+    case ETextureFormat::BC5_RG_UNORM:
+    case ETextureFormat::BC7_RGBA_UNORM:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+uint64_t TextureFile::levelSize(ETextureFormat format, uint32_t width, uint32_t height)
+{
+    if (uint32_t block = blockSize(format)) {
+        return uint64_t((width + 3) / 4) * ((height + 3) / 4) * block;
+    }
+    return uint64_t(width) * height * bytesPerPixel(format);
+}
+
+std::vector<TextureMips::Level> TextureFile::layout(ETextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    std::vector<TextureMips::Level> levels = TextureMips::layout(width, height, mipCount, 0);
+    uint64_t                        offset = 0;
+    for (TextureMips::Level &level : levels) {
+        level.offset = offset;
+        level.size   = levelSize(format, level.width, level.height);
+        offset += level.size;
+    }
+    return levels;
+}
+
+void TextureFile::write(uint32_t width, uint32_t height, ETextureFormat format, uint32_t mipCount, const void *pixels, std::vector<uint8_t> &out)
+{
+    constexpr uint64_t dataOffset = (sizeof(Header) + 15) & ~uint64_t(15);
+
+    Header header{
+        .magic      = MAGIC,
+        .version    = VERSION,
+        .width      = width,
+        .height     = height,
+        .format     = static_cast<uint32_t>(format),
+        .mipCount   = mipCount,
+        .dataOffset = dataOffset,
+        .dataSize   = levelsSize(format, width, height, mipCount),
+    };
+    header.fileSize = header.dataOffset + header.dataSize;
+
+    out.assign(header.fileSize, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (header.dataSize > 0) {
+        std::memcpy(out.data() + header.dataOffset, pixels, header.dataSize);
+    }
+}
+
+std::optional<TextureFile::View> TextureFile::load(std::string_view path)
+{
+    auto file = FileSystem::get()->mapFile(path);
+    if (!file) {
+        return {};
+    }
+
+    Header header;
+    if (file->getSize() < sizeof(Header)) {
+        NE_CORE_ERROR("Invalid texture file {}: too small", path);
+        return {};
+    }
+    std::memcpy(&header, file->getData(), sizeof(header));
+
+    auto format   = static_cast<ETextureFormat>(header.format);
+    bool bKnown   = levelSize(format, 1, 1) != 0;
+    bool bInRange = header.dataOffset <= file->getSize() && header.dataSize <= file->getSize() - header.dataOffset;
+    if (header.magic != MAGIC || header.version != VERSION || header.fileSize != file->getSize() || !bKnown || !bInRange ||
+        header.mipCount == 0 || header.mipCount > TextureMips::levelCount(header.width, header.height) ||
+        header.dataSize != levelsSize(format, header.width, header.height, header.mipCount))
+    {
+        NE_CORE_ERROR("Invalid texture file {}", path);
+        return {};
+    }
+
+    return View{
+        .width    = header.width,
+        .height   = header.height,
+        .format   = format,
+        .mipCount = header.mipCount,
+        .pixels   = {file->getData() + header.dataOffset, header.dataSize},
+        .file     = std::move(file),
+    };
+}
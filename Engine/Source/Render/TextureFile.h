@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "Render/Texture.h"
+#include "Render/TextureMips.h"
+
+class MappedFile;
+
+// The cooked texture format (.ntex) written by neon-cook: the decoded pixels as they are uploaded,
+// loading maps the file and hands the pixel range to the upload, no image decoding at runtime.
+//
+// Layout: Header, then the pixels at `dataOffset` (16 byte aligned): `mipCount` levels one after the other,
+// level 0 first, rows tightly packed (see TextureMips::layout)
+class TextureFile
+{
+  public:
+    static constexpr uint32_t         MAGIC     = 0x5845544E; // "NTEX"
+    static constexpr uint32_t         VERSION   = 2;
+    static constexpr std::string_view EXTENSION = ".ntex";
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t width;
+        uint32_t height;
+        uint32_t format; // ETextureFormat
+        uint32_t mipCount;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+        uint64_t fileSize;
+    };
+
+    // points into the mapping, which it keeps alive
+    struct View
+    {
+        uint32_t                          width  = 0;
+        uint32_t                          height = 0;
+        ETextureFormat                    format   = ETextureFormat::R8G8B8A8_UNORM;
+        uint32_t                          mipCount = 1;
+        std::span<const uint8_t>          pixels; // every level
+        std::shared_ptr<const MappedFile> file;
+    };
+
+    // 0 for the block compressed formats
+    static uint32_t bytesPerPixel(ETextureFormat format);
+    // bytes of a 4x4 block of the block compressed formats, 0 for the others
+    static uint32_t blockSize(ETextureFormat format);
+    // bytes of a `width` x `height` level, whole blocks for the block compressed formats. 0 for an unknown format
+    static uint64_t levelSize(ETextureFormat format, uint32_t width, uint32_t height);
+    // the levels one after the other, level 0 first
+    static std::vector<TextureMips::Level> layout(ETextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount);
+
+    // `pixels` holds `mipCount` levels of tightly packed rows
+    static void write(uint32_t width, uint32_t height, ETextureFormat format, uint32_t mipCount, const void *pixels, std::vector<uint8_t> &out);
+
+    // `path` is relative to the project root
+    static std::optional<View> load(std::string_view path);
+};
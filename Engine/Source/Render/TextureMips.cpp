@@ -0,0 +1,224 @@
+#include "TextureMips.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define NE_TEXTURE_MIPS_SSE 1
+#else
+    #include <glm/glm.hpp>
+    #define NE_TEXTURE_MIPS_SSE 0
+#endif
+
+namespace TextureMips
+{
+
+namespace
+{
+
+// one RGBA texel per register, the filters run on all 4 channels at once
+#if NE_TEXTURE_MIPS_SSE
+using Texel = __m128;
+
+Texel zero() { return _mm_setzero_ps(); }
+Texel load(const float *texel) { return _mm_loadu_ps(texel); }
+void  store(float *texel, Texel value) { _mm_storeu_ps(texel, value); }
+Texel madd(Texel sum, Texel value, float weight) { return _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weight))); }
+#else
+using Texel = glm::vec4;
+
+Texel zero() { return Texel(0.0f); }
+Texel load(const float *texel) { return Texel(texel[0], texel[1], texel[2], texel[3]); }
+void  store(float *texel, Texel value) { std::memcpy(texel, &value, sizeof(Texel)); }
+Texel madd(Texel sum, Texel value, float weight) { return sum + value * weight; }
+#endif
+
+constexpr float KAISER_SUPPORT = 1.5f; // in destination texels, 3 source texels each side for a 2x reduction
+constexpr float KAISER_ALPHA   = 4.0f;
+
+// RGBA, linear
+struct Image
+{
+    uint32_t           width  = 0;
+    uint32_t           height = 0;
+    std::vector<float> texels;
+};
+
+float srgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// modified Bessel function of the first kind, order 0
+float besselI0(float x)
+{
+    float sum  = 1.0f;
+    float term = 1.0f;
+    for (int k = 1; k < 32 && term > sum * 1e-7f; ++k) {
+        term *= (x * 0.5f / k) * (x * 0.5f / k);
+        sum += term;
+    }
+    return sum;
+}
+
+float sinc(float x)
+{
+    if (std::abs(x) < 1e-6f) {
+        return 1.0f;
+    }
+    float px = 3.14159265358979f * x;
+    return std::sin(px) / px;
+}
+
+// `t` in destination texels from the destination texel center
+float evaluate(EFilter filter, float t)
+{
+    t = std::abs(t);
+    if (filter == EFilter::Box) {
+        return t < 0.5f ? 1.0f : t == 0.5f ? 0.5f : 0.0f;
+    }
+    if (t >= KAISER_SUPPORT) {
+        return 0.0f;
+    }
+    float x = t / KAISER_SUPPORT;
+    return sinc(t) * besselI0(KAISER_ALPHA * std::sqrt(1.0f - x * x)) / besselI0(KAISER_ALPHA);
+}
+
+// the source texels and weights of each destination texel along one axis, `taps` per texel
+struct Kernel
+{
+    uint32_t              taps = 0;
+    std::vector<uint32_t> indices;
+    std::vector<float>    weights;
+};
+
+Kernel makeKernel(uint32_t sourceSize, uint32_t size, EFilter filter)
+{
+    float scale   = float(sourceSize) / float(size);
+    float support = (filter == EFilter::Box ? 0.5f : KAISER_SUPPORT) * scale;
+
+    Kernel kernel;
+    kernel.taps = static_cast<uint32_t>(std::ceil(support * 2.0f)) + 1;
+    kernel.indices.assign(std::size_t(size) * kernel.taps, 0);
+    kernel.weights.assign(std::size_t(size) * kernel.taps, 0.0f);
+
+    for (uint32_t x = 0; x < size; ++x) {
+        float center = (x + 0.5f) * scale;
+        int   first  = static_cast<int>(std::floor(center - support));
+        float total  = 0.0f;
+        for (uint32_t k = 0; k < kernel.taps; ++k) {
+            int   i      = first + static_cast<int>(k);
+            float weight = evaluate(filter, ((i + 0.5f) - center) / scale);
+            // clamped to the edge, the texels past it repeat the last one
+            kernel.indices[x * kernel.taps + k] = static_cast<uint32_t>(std::clamp(i, 0, static_cast<int>(sourceSize) - 1));
+            kernel.weights[x * kernel.taps + k] = weight;
+            total += weight;
+        }
+        for (uint32_t k = 0; k < kernel.taps; ++k) {
+            kernel.weights[x * kernel.taps + k] /= total;
+        }
+    }
+    return kernel;
+}
+
+// separable: the rows to the new width, then the columns to the new height
+Image resample(const Image &source, uint32_t width, uint32_t height, EFilter filter)
+{
+    Kernel horizontal = makeKernel(source.width, width, filter);
+    Kernel vertical   = makeKernel(source.height, height, filter);
+
+    std::vector<float> rows(std::size_t(width) * source.height * 4);
+    for (uint32_t y = 0; y < source.height; ++y) {
+        const float *row = &source.texels[std::size_t(y) * source.width * 4];
+        for (uint32_t x = 0; x < width; ++x) {
+            Texel sum = zero();
+            for (uint32_t k = 0; k < horizontal.taps; ++k) {
+                std::size_t tap = std::size_t(x) * horizontal.taps + k;
+                sum             = madd(sum, load(&row[horizontal.indices[tap] * 4]), horizontal.weights[tap]);
+            }
+            store(&rows[(std::size_t(y) * width + x) * 4], sum);
+        }
+    }
+
+    Image result{.width = width, .height = height};
+    result.texels.resize(std::size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            Texel sum = zero();
+            for (uint32_t k = 0; k < vertical.taps; ++k) {
+                std::size_t tap = std::size_t(y) * vertical.taps + k;
+                sum             = madd(sum, load(&rows[(std::size_t(vertical.indices[tap]) * width + x) * 4]), vertical.weights[tap]);
+            }
+            store(&result.texels[(std::size_t(y) * width + x) * 4], sum);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+uint32_t levelCount(uint32_t width, uint32_t height)
+{
+    return std::bit_width(std::max({width, height, 1u}));
+}
+
+std::vector<Level> layout(uint32_t width, uint32_t height, uint32_t levelCount, uint32_t bytesPerPixel)
+{
+    std::vector<Level> levels;
+    uint64_t           offset = 0;
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        Level current{
+            .width  = std::max(width >> level, 1u),
+            .height = std::max(height >> level, 1u),
+            .offset = offset,
+        };
+        current.size = uint64_t(current.width) * current.height * bytesPerPixel;
+        offset += current.size;
+        levels.push_back(current);
+    }
+    return levels;
+}
+
+std::vector<uint8_t> generate(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t levelCount, EFilter filter, bool bSRGB)
+{
+    std::vector<Level>   levels = layout(width, height, std::max(levelCount, 1u), 4);
+    std::vector<uint8_t> out(levels.back().offset + levels.back().size);
+    std::memcpy(out.data(), rgba, levels[0].size);
+
+    std::array<float, 256> decode;
+    for (int i = 0; i < 256; ++i) {
+        decode[i] = bSRGB ? srgbToLinear(i / 255.0f) : i / 255.0f;
+    }
+    auto encode = [bSRGB](float value, bool bAlpha) {
+        value = std::clamp(value, 0.0f, 1.0f);
+        value = bSRGB && !bAlpha ? linearToSrgb(value) : value;
+        return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    };
+
+    Image image{.width = width, .height = height};
+    image.texels.resize(std::size_t(width) * height * 4);
+    for (std::size_t i = 0; i < image.texels.size(); ++i) {
+        image.texels[i] = i % 4 == 3 ? rgba[i] / 255.0f : decode[rgba[i]];
+    }
+
+    for (std::size_t level = 1; level < levels.size(); ++level) {
+        image = resample(image, levels[level].width, levels[level].height, filter);
+
+        uint8_t *pixels = out.data() + levels[level].offset;
+        for (std::size_t i = 0; i < image.texels.size(); ++i) {
+            pixels[i] = encode(image.texels[i], i % 4 == 3);
+        }
+    }
+    return out;
+}
+
+} // namespace TextureMips
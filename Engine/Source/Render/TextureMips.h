@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Mip chains of RGBA8 images, generated by neon-cook so the cooked textures upload every level as is.
+// Each level is resampled from the previous one kept in float, so the rounding does not add up down the chain.
+// sRGB images are filtered in linear space (alpha is always linear), an average of the encoded values would
+// darken every level.
+//
+// The levels are stored tightly packed one after the other, level 0 first, see `layout`
+namespace TextureMips
+{
+
+enum class EFilter
+{
+    Box,    // the 2x2 average, cheap and soft
+    Kaiser, // Kaiser windowed sinc over 6x6 texels, keeps the detail the box blurs out, may ring a little
+};
+
+struct Level
+{
+    uint32_t width  = 0;
+    uint32_t height = 0;
+    uint64_t offset = 0; // from the start of level 0
+    uint64_t size   = 0;
+};
+
+// log2 of the largest side + 1, down to 1x1
+uint32_t levelCount(uint32_t width, uint32_t height);
+
+// the size of each level, halved and rounded down (at least 1), the last one ends at the total size
+std::vector<Level> layout(uint32_t width, uint32_t height, uint32_t levelCount, uint32_t bytesPerPixel);
+
+// `rgba` is level 0, `height` tightly packed rows. Returns all `levelCount` levels (level 0 copied first)
+std::vector<uint8_t> generate(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t levelCount, EFilter filter, bool bSRGB);
+
+} // namespace TextureMips
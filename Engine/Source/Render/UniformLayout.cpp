@@ -0,0 +1,64 @@
+#include "UniformLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/Log.h"
+#include "Render/Shader.h"
+
+bool validateUniformLayouts(const std::vector<UniformLayoutInfo>                                      &layouts,
+                            const std::unordered_map<EShaderStage::T, ShaderReflection::ShaderResources> &shaderResources)
+{
+    bool              bValid = true;
+    std::vector<bool> matched(layouts.size(), false);
+
+    for (const auto &[stage, resources] : shaderResources) {
+        for (const auto &buffer : resources.uniformBuffers) {
+            auto layout = std::find_if(layouts.begin(), layouts.end(), [&](const UniformLayoutInfo &l) { return buffer.instanceName == l.blockName; });
+            if (layout == layouts.end()) {
+                continue;
+            }
+            matched[layout - layouts.begin()] = true;
+
+            if (layout->size < buffer.size) {
+                // the shader would read past the pushed data
+                NE_CORE_ERROR("Uniform block {} ({} stage) is {} bytes but its C++ mirror only {}",
+                              buffer.instanceName,
+                              EShaderStage::T2Strings[stage],
+                              buffer.size,
+                              layout->size);
+                bValid = false;
+            }
+
+            for (const auto &member : buffer.members) {
+                auto it = std::find_if(layout->members.begin(), layout->members.end(), [&](const UniformMemberLayout &m) {
+                    return member.name == m.name;
+                });
+                if (it == layout->members.end()) {
+                    NE_CORE_ERROR("Uniform block {}: member '{}' is missing in the C++ mirror", buffer.instanceName, member.name);
+                    bValid = false;
+                }
+                else if (it->offset != member.offset || it->size != member.size) {
+                    NE_CORE_ERROR("Uniform block {}: member '{}' is at offset {} size {} in the shader but at offset {} size {} in C++",
+                                  buffer.instanceName,
+                                  member.name,
+                                  member.offset,
+                                  member.size,
+                                  it->offset,
+                                  it->size);
+                    bValid = false;
+                }
+            }
+        }
+    }
+
+    // a renamed block or a typo in the mirror would otherwise silently skip the check
+    for (std::size_t i = 0; i < layouts.size(); ++i) {
+        if (!matched[i]) {
+            NE_CORE_ERROR("Uniform mirror {} matches no uniform block of the shader", layouts[i].blockName);
+            bValid = false;
+        }
+    }
+
+    return bValid;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Render/Render.h"
+#include "Render/Shader.h"
+
+// C++ mirrors of std140 uniform blocks:
+//
+//   struct LightUniforms { glm::vec4 lightDir; glm::vec4 lightColor; float ambientIntensity; float specularPower; };
+//   static constexpr auto LightUniformsLayout = makeUniformLayout<LightUniforms>("uLight",
+//       NE_UNIFORM_MEMBER(LightUniforms, lightDir),
+//       ...);
+//
+// makeUniformLayout fails to compile when a member breaks the std140 alignment (a vec3 or vec4 off a 16 byte boundary,
+// two packed vec3, glm::mat3, ...), add explicit padding members to fix the C++ side.
+// The names are the block instance names (uLight, not LightBuffer), they are compared against the reflected block when
+// the pipeline is created, see validateUniformLayouts
+
+namespace Std140
+{
+// base alignment and size of the supported member types
+template <typename T>
+struct Rule;
+
+template <>
+struct Rule<float>
+{
+    static constexpr uint32_t alignment = 4, size = 4;
+};
+template <>
+struct Rule<int32_t>
+{
+    static constexpr uint32_t alignment = 4, size = 4;
+};
+template <>
+struct Rule<uint32_t>
+{
+    static constexpr uint32_t alignment = 4, size = 4;
+};
+template <>
+struct Rule<glm::vec2>
+{
+    static constexpr uint32_t alignment = 8, size = 8;
+};
+template <>
+struct Rule<glm::vec3>
+{
+    static constexpr uint32_t alignment = 16, size = 12;
+};
+template <>
+struct Rule<glm::vec4>
+{
+    static constexpr uint32_t alignment = 16, size = 16;
+};
+template <>
+struct Rule<glm::ivec4>
+{
+    static constexpr uint32_t alignment = 16, size = 16;
+};
+template <>
+struct Rule<glm::mat4>
+{
+    static constexpr uint32_t alignment = 16, size = 64;
+};
+// no glm::mat3: its columns are padded to vec4 in std140, use a glm::mat3x4 (or mat4) on the C++ side
+template <>
+struct Rule<glm::mat3x4>
+{
+    static constexpr uint32_t alignment = 16, size = 48;
+};
+} // namespace Std140
+
+struct UniformLayoutMember
+{
+    UniformMemberLayout member;
+    uint32_t            alignment;
+    uint32_t            std140Size;
+};
+
+#define NE_UNIFORM_MEMBER(Type, field)                                                     \
+    UniformLayoutMember                                                                    \
+    {                                                                                      \
+        .member = {                                                                        \
+            .name   = #field,                                                              \
+            .offset = static_cast<uint32_t>(offsetof(Type, field)),                        \
+            .size   = static_cast<uint32_t>(sizeof(Type::field)),                          \
+        },                                                                                 \
+        .alignment  = Std140::Rule<std::remove_cvref_t<decltype(Type::field)>>::alignment, \
+        .std140Size = Std140::Rule<std::remove_cvref_t<decltype(Type::field)>>::size,      \
+    }
+
+template <std::size_t N>
+struct UniformLayout
+{
+    const char                        *blockName;
+    uint32_t                           size;
+    std::array<UniformMemberLayout, N> members;
+
+    UniformLayoutInfo info() const
+    {
+        return UniformLayoutInfo{
+            .blockName = blockName,
+            .size      = size,
+            .members   = members,
+        };
+    }
+};
+
+// consteval, so a member off its std140 offset fails to compile
+template <typename Block, typename... Members>
+consteval auto makeUniformLayout(const char *blockName, Members... members)
+{
+    UniformLayout<sizeof...(Members)> layout{
+        .blockName = blockName,
+        .size      = static_cast<uint32_t>(sizeof(Block)),
+        .members   = {},
+    };
+
+    const UniformLayoutMember list[] = {members...};
+    uint32_t                  end    = 0; // std140 end of the previous member
+    for (std::size_t i = 0; i < sizeof...(Members); ++i) {
+        const auto &m = list[i];
+        if (m.member.size != m.std140Size) {
+            throw "uniform member has a different size than in std140";
+        }
+        // unlisted members in between are padding, the exact offsets are compared with the reflection at load time
+        if (m.member.offset % m.alignment != 0 || m.member.offset < end) {
+            throw "uniform member is not at a std140 offset, add padding";
+        }
+        end               = m.member.offset + m.std140Size;
+        layout.members[i] = m.member;
+    }
+    return layout;
+}
+
+// C++ mirrors of the elements of std430 storage buffer arrays (e.g. DrawData in Include/DrawData.glsl).
+// The members follow the same rules as in std140 (the two only differ for arrays and nested structs, which are not
+// supported as members), and sizeof(Element) must be the std430 array stride: a multiple of the largest member alignment
+template <typename Element, typename... Members>
+consteval auto makeStorageLayout(const char *structName, Members... members)
+{
+    auto layout = makeUniformLayout<Element>(structName, members...);
+
+    const UniformLayoutMember list[] = {members...};
+    uint32_t                  stride = 1;
+    for (const auto &m : list) {
+        stride = m.alignment > stride ? m.alignment : stride;
+    }
+    if (sizeof(Element) % stride != 0) {
+        throw "storage element size is not its std430 array stride, add padding";
+    }
+    return layout;
+}
+
+// Compare the C++ mirrors against the reflected uniform blocks of every stage with the same instance name:
+// every reflected member must exist in the mirror at the same offset and size, and the mirror must cover the block.
+// Blocks without a mirror are skipped, a mirror without a block in any stage is an error.
+// Logs every mismatch, false if there was any
+bool validateUniformLayouts(const std::vector<UniformLayoutInfo>                                      &layouts,
+                            const std::unordered_map<EShaderStage::T, ShaderReflection::ShaderResources> &shaderResources);
@@ -0,0 +1,215 @@
+#include "VertexCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Render/Model.h"
+#include "Render/VertexLayout.h"
+
+namespace VertexCompression
+{
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t abs  = bits & 0x7FFFFFFFu;
+
+    if (abs >= 0x7F800000u) {
+        // inf stays inf, nan stays a quiet nan
+        return static_cast<uint16_t>(sign | 0x7C00u | (abs > 0x7F800000u ? 0x0200u : 0u));
+    }
+    if (abs >= 0x477FF000u) {
+        // rounds to 65520 or more
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (abs < 0x38800000u) {
+        // half subnormal or zero, let the float adder do the rounding: adding 0.5 aligns the mantissa at 2^-24
+        float f;
+        std::memcpy(&f, &abs, sizeof(f));
+        f += 0.5f;
+        uint32_t fbits;
+        std::memcpy(&fbits, &f, sizeof(fbits));
+        return static_cast<uint16_t>(sign | (fbits - 0x3F000000u));
+    }
+
+    // rebias the exponent, round the 13 dropped bits to nearest even
+    uint32_t mantissaOdd = (abs >> 13) & 1u;
+    abs += (uint32_t(15 - 127) << 23) + 0xFFFu + mantissaOdd;
+    return static_cast<uint16_t>(sign | (abs >> 13));
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign     = uint32_t(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        }
+        else {
+            float f = std::ldexp(float(mantissa), -24);
+            std::memcpy(&bits, &f, sizeof(bits));
+            bits |= sign;
+        }
+    }
+    else if (exponent == 0x1F) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    }
+    else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+int16_t floatToSnorm16(float value)
+{
+    value = std::clamp(value, -1.0f, 1.0f);
+    return static_cast<int16_t>(std::nearbyint(value * 32767.0f));
+}
+
+float snorm16ToFloat(int16_t value)
+{
+    // -32768 and -32767 both map to -1
+    return std::max(float(value) / 32767.0f, -1.0f);
+}
+
+uint32_t packUnorm4x8(const glm::vec4 &value)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint32_t channel = static_cast<uint32_t>(std::nearbyint(std::clamp(value[i], 0.0f, 1.0f) * 255.0f));
+        result |= channel << (i * 8);
+    }
+    return result;
+}
+
+glm::vec4 unpackUnorm4x8(uint32_t value)
+{
+    glm::vec4 result;
+    for (int i = 0; i < 4; ++i) {
+        result[i] = float((value >> (i * 8)) & 0xFFu) / 255.0f;
+    }
+    return result;
+}
+
+static float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+glm::vec2 octahedralEncode(const glm::vec3 &normal)
+{
+    float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1 <= std::numeric_limits<float>::min()) {
+        return glm::vec2(0.0f);
+    }
+
+    // project onto the octahedron, then fold the lower hemisphere over the diagonals
+    glm::vec2 p = glm::vec2(normal.x, normal.y) / l1;
+    if (normal.z < 0.0f) {
+        p = glm::vec2((1.0f - std::abs(p.y)) * signNotZero(p.x),
+                      (1.0f - std::abs(p.x)) * signNotZero(p.y));
+    }
+    return p;
+}
+
+glm::vec3 octahedralDecode(const glm::vec2 &encoded)
+{
+    glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    if (n.z < 0.0f) {
+        float x = (1.0f - std::abs(n.y)) * signNotZero(n.x);
+        float y = (1.0f - std::abs(n.x)) * signNotZero(n.y);
+        n.x     = x;
+        n.y     = y;
+    }
+    return glm::normalize(n);
+}
+
+PositionQuantization computeQuantization(const Vertex *vertices, std::size_t count)
+{
+    PositionQuantization quantization;
+    if (count == 0) {
+        return quantization;
+    }
+
+    glm::vec3 minPos = vertices[0].position;
+    glm::vec3 maxPos = vertices[0].position;
+    for (std::size_t i = 1; i < count; ++i) {
+        minPos = glm::min(minPos, vertices[i].position);
+        maxPos = glm::max(maxPos, vertices[i].position);
+    }
+
+    quantization.offset = (minPos + maxPos) * 0.5f;
+    quantization.scale  = (maxPos - minPos) * 0.5f;
+    for (int axis = 0; axis < 3; ++axis) {
+        // flat along this axis, any scale works, avoid dividing by zero
+        if (quantization.scale[axis] <= 0.0f) {
+            quantization.scale[axis] = 1.0f;
+        }
+    }
+    return quantization;
+}
+
+void packPositions(const Vertex *vertices, std::size_t count, const PositionQuantization &quantization, PackedVertex *out)
+{
+    const glm::vec3 invScale = 1.0f / quantization.scale;
+    for (std::size_t i = 0; i < count; ++i) {
+        glm::vec3 p        = (vertices[i].position - quantization.offset) * invScale;
+        out[i].position[0] = floatToSnorm16(p.x);
+        out[i].position[1] = floatToSnorm16(p.y);
+        out[i].position[2] = floatToSnorm16(p.z);
+        out[i].position[3] = 32767;
+    }
+}
+
+void packNormals(const Vertex *vertices, std::size_t count, PackedVertex *out)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        glm::vec2 oct    = octahedralEncode(vertices[i].normal);
+        out[i].normal[0] = floatToSnorm16(oct.x);
+        out[i].normal[1] = floatToSnorm16(oct.y);
+    }
+}
+
+void packTexCoords(const Vertex *vertices, std::size_t count, PackedVertex *out)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i].texCoord[0] = floatToHalf(vertices[i].texCoord.x);
+        out[i].texCoord[1] = floatToHalf(vertices[i].texCoord.y);
+    }
+}
+
+void packColors(const Vertex *vertices, std::size_t count, PackedVertex *out)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        uint32_t rgba = packUnorm4x8(vertices[i].color);
+        std::memcpy(out[i].color, &rgba, sizeof(rgba));
+    }
+}
+
+PackedMesh pack(const std::vector<Vertex> &vertices)
+{
+    PackedMesh packed;
+    packed.vertices.resize(vertices.size());
+    packed.quantization = computeQuantization(vertices.data(), vertices.size());
+
+    // one stream at a time keeps each loop small enough for the compiler to vectorize
+    packPositions(vertices.data(), vertices.size(), packed.quantization, packed.vertices.data());
+    packNormals(vertices.data(), vertices.size(), packed.vertices.data());
+    packTexCoords(vertices.data(), vertices.size(), packed.vertices.data());
+    packColors(vertices.data(), vertices.size(), packed.vertices.data());
+    return packed;
+}
+
+} // namespace VertexCompression
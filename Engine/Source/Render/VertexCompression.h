@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Render/Render.h"
+#include "Render/VertexLayout.h"
+
+struct Vertex;
+
+// Conversion kernels from the full float `Vertex` (48 bytes) to the compact `PackedVertex` (20 bytes):
+//   position  Short4Norm, quantized to the mesh bounds, the shader restores it with `PositionQuantization`
+//   normal    Short2Norm, octahedral encoded
+//   texCoord  Half2
+//   color     UByte4Norm
+// SDL_gpu has no 10:10:10:2 vertex format, so the normals use the 2 x 16 bit octahedral encoding instead
+namespace VertexCompression
+{
+
+struct PackedVertex
+{
+    int16_t  position[4];
+    int16_t  normal[2];
+    uint16_t texCoord[2];
+    uint8_t  color[4];
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must stay tightly packed");
+
+// position = packed.xyz * scale + offset, i.e. the center and half extent of the mesh bounds
+struct PositionQuantization
+{
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale  = glm::vec3(1.0f);
+};
+
+// std140 mirror of `uQuantization` in Include/VertexCompression.glsl
+struct QuantizationUniform
+{
+    glm::vec4 offset;
+    glm::vec4 scale;
+
+    QuantizationUniform() = default;
+    QuantizationUniform(const PositionQuantization &quantization)
+        : offset(quantization.offset, 0.0f), scale(quantization.scale, 0.0f) {}
+};
+
+struct PackedMesh
+{
+    std::vector<PackedVertex> vertices;
+    PositionQuantization      quantization;
+};
+
+// scalar kernels, round to nearest even, out of range values saturate
+uint16_t  floatToHalf(float value);
+float     halfToFloat(uint16_t value);
+int16_t   floatToSnorm16(float value);
+float     snorm16ToFloat(int16_t value);
+uint32_t  packUnorm4x8(const glm::vec4 &value);
+glm::vec4 unpackUnorm4x8(uint32_t value);
+
+// `normal` need not be normalized, a zero vector encodes +Z
+glm::vec2 octahedralEncode(const glm::vec3 &normal);
+glm::vec3 octahedralDecode(const glm::vec2 &encoded);
+
+PositionQuantization computeQuantization(const Vertex *vertices, std::size_t count);
+
+void packPositions(const Vertex *vertices, std::size_t count, const PositionQuantization &quantization, PackedVertex *out);
+void packNormals(const Vertex *vertices, std::size_t count, PackedVertex *out);
+void packTexCoords(const Vertex *vertices, std::size_t count, PackedVertex *out);
+void packColors(const Vertex *vertices, std::size_t count, PackedVertex *out);
+
+// all of the above
+PackedMesh pack(const std::vector<Vertex> &vertices);
+
+// the pipeline layout matching `PackedVertex`, the locations follow Basic.glsl
+inline constexpr auto PackedVertexLayout = makeVertexLayout<PackedVertex>(
+    NE_VERTEX_ATTRIBUTE_AS(PackedVertex, position, Short4Norm),
+    NE_VERTEX_ATTRIBUTE_AS(PackedVertex, color, UByte4Norm),
+    NE_VERTEX_ATTRIBUTE_AS(PackedVertex, texCoord, Half2),
+    NE_VERTEX_ATTRIBUTE_AS(PackedVertex, normal, Short2Norm));
+
+} // namespace VertexCompression
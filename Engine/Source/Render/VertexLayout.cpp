@@ -0,0 +1,87 @@
+#include "VertexLayout.h"
+
+#include <algorithm>
+
+#include "Core/Log.h"
+#include "Render/Shader.h"
+
+static uint32_t getInputComponentCount(ShaderReflection::DataType type)
+{
+    using ShaderReflection::DataType;
+    switch (type) {
+    case DataType::Float:
+        return 1;
+    case DataType::Vec2:
+        return 2;
+    case DataType::Vec3:
+        return 3;
+    case DataType::Vec4:
+        return 4;
+    default:
+        // integer inputs have no matching attribute format yet
+        return 0;
+    }
+}
+
+bool validateVertexLayout(const GraphicsPipelineCreateInfo &pipelineCI, const ShaderReflection::ShaderResources &vertexResources)
+{
+    const auto &shaderName = pipelineCI.shaderCreateInfo.shaderName;
+    bool        bValid     = true;
+
+    for (const auto &input : vertexResources.inputs) {
+        auto it = std::find_if(pipelineCI.vertexAttributes.begin(),
+                               pipelineCI.vertexAttributes.end(),
+                               [&](const VertexAttribute &attribute) { return attribute.location == input.location; });
+        if (it == pipelineCI.vertexAttributes.end()) {
+            NE_CORE_ERROR("{}: no vertex attribute for input '{}' at location {}", shaderName, input.name, input.location);
+            bValid = false;
+            continue;
+        }
+
+        uint32_t inputComponents  = getInputComponentCount(input.type);
+        uint32_t formatComponents = EVertexAttributeFormat::componentCount(it->format);
+        if (inputComponents == 0) {
+            NE_CORE_ERROR("{}: unsupported type {} of input '{}'", shaderName, ShaderReflection::DataType2Strings[input.type], input.name);
+            bValid = false;
+        }
+        else if (formatComponents < inputComponents) {
+            // the missing components would silently read as (0, 0, 0, 1)
+            NE_CORE_ERROR("{}: input '{}' at location {} is a {} but the attribute format {} has only {} components",
+                          shaderName,
+                          input.name,
+                          input.location,
+                          ShaderReflection::DataType2Strings[input.type],
+                          EVertexAttributeFormat::T2Strings[it->format],
+                          formatComponents);
+            bValid = false;
+        }
+    }
+
+    for (const auto &attribute : pipelineCI.vertexAttributes) {
+        auto desc = std::find_if(pipelineCI.vertexBufferDescs.begin(),
+                                 pipelineCI.vertexBufferDescs.end(),
+                                 [&](const VertexBufferDescription &d) { return d.slot == attribute.bufferSlot; });
+        if (desc == pipelineCI.vertexBufferDescs.end()) {
+            NE_CORE_ERROR("{}: vertex attribute at location {} uses undescribed buffer slot {}", shaderName, attribute.location, attribute.bufferSlot);
+            bValid = false;
+        }
+        else if (attribute.offset + EVertexAttributeFormat::sizeOf(attribute.format) > desc->pitch) {
+            NE_CORE_ERROR("{}: vertex attribute at location {} (offset {}) exceeds the pitch {} of slot {}",
+                          shaderName,
+                          attribute.location,
+                          attribute.offset,
+                          desc->pitch,
+                          desc->slot);
+            bValid = false;
+        }
+
+        bool bConsumed = std::any_of(vertexResources.inputs.begin(),
+                                     vertexResources.inputs.end(),
+                                     [&](const ShaderReflection::StageIOData &input) { return input.location == attribute.location; });
+        if (!bConsumed) {
+            NE_CORE_WARN("{}: vertex attribute at location {} is not read by the shader", shaderName, attribute.location);
+        }
+    }
+
+    return bValid;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Render/Render.h"
+
+namespace ShaderReflection
+{
+struct ShaderResources;
+}
+
+// Vertex layouts described next to the C++ vertex struct, the attribute list is built at compile time:
+//
+//   struct VertexInput { glm::vec3 position; glm::vec4 color; };
+//   static constexpr auto Layout = makeVertexLayout<VertexInput>(
+//       NE_VERTEX_ATTRIBUTE(VertexInput, position),
+//       NE_VERTEX_ATTRIBUTE(VertexInput, color));
+//
+// The locations follow the argument order, the format is deduced from the member type,
+// members with a compact format (see VertexCompression) name it with NE_VERTEX_ATTRIBUTE_AS.
+// The layout is checked against the reflected vertex inputs when the pipeline is created, see validateVertexLayout
+
+template <typename T>
+struct VertexFormatOf;
+
+template <>
+struct VertexFormatOf<glm::vec2>
+{
+    static constexpr EVertexAttributeFormat::T value = EVertexAttributeFormat::Float2;
+};
+template <>
+struct VertexFormatOf<glm::vec3>
+{
+    static constexpr EVertexAttributeFormat::T value = EVertexAttributeFormat::Float3;
+};
+template <>
+struct VertexFormatOf<glm::vec4>
+{
+    static constexpr EVertexAttributeFormat::T value = EVertexAttributeFormat::Float4;
+};
+
+namespace EVertexAttributeFormat
+{
+constexpr uint32_t sizeOf(T type)
+{
+    switch (type) {
+    case Float2:
+        return 8;
+    case Float3:
+        return 12;
+    case Float4:
+        return 16;
+    case Half2:
+    case UByte4Norm:
+    case Short2Norm:
+        return 4;
+    case Short4Norm:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+constexpr uint32_t componentCount(T type)
+{
+    switch (type) {
+    case Float2:
+    case Half2:
+    case Short2Norm:
+        return 2;
+    case Float3:
+        return 3;
+    case Float4:
+    case UByte4Norm:
+    case Short4Norm:
+        return 4;
+    default:
+        return 0;
+    }
+}
+} // namespace EVertexAttributeFormat
+
+struct VertexLayoutAttribute
+{
+    uint32_t                  offset;
+    uint32_t                  size; // of the member, at least the size of the format
+    EVertexAttributeFormat::T format;
+};
+
+#define NE_VERTEX_ATTRIBUTE(Type, member)                                             \
+    VertexLayoutAttribute                                                             \
+    {                                                                                 \
+        .offset = static_cast<uint32_t>(offsetof(Type, member)),                      \
+        .size   = static_cast<uint32_t>(sizeof(Type::member)),                        \
+        .format = VertexFormatOf<std::remove_cvref_t<decltype(Type::member)>>::value, \
+    }
+
+#define NE_VERTEX_ATTRIBUTE_AS(Type, member, fmt)                \
+    VertexLayoutAttribute                                        \
+    {                                                            \
+        .offset = static_cast<uint32_t>(offsetof(Type, member)), \
+        .size   = static_cast<uint32_t>(sizeof(Type::member)),   \
+        .format = EVertexAttributeFormat::fmt,                   \
+    }
+
+template <std::size_t N>
+struct VertexLayout
+{
+    uint32_t                       stride;
+    std::array<VertexAttribute, N> attributes;
+
+    VertexBufferDescription bufferDescription(uint32_t slot = 0) const
+    {
+        return VertexBufferDescription{
+            .slot  = slot,
+            .pitch = stride,
+        };
+    }
+
+    std::vector<VertexAttribute> attributeList(uint32_t slot = 0) const
+    {
+        std::vector<VertexAttribute> result(attributes.begin(), attributes.end());
+        for (auto &attribute : result) {
+            attribute.bufferSlot = slot;
+        }
+        return result;
+    }
+};
+
+// consteval, so a layout that does not fit its struct fails to compile
+template <typename Vertex, typename... Attributes>
+consteval auto makeVertexLayout(Attributes... attributes)
+{
+    VertexLayout<sizeof...(Attributes)> layout{
+        .stride     = static_cast<uint32_t>(sizeof(Vertex)),
+        .attributes = {},
+    };
+
+    const VertexLayoutAttribute list[] = {attributes...};
+    for (uint32_t i = 0; i < sizeof...(Attributes); ++i) {
+        const auto &attribute = list[i];
+        uint32_t    size      = EVertexAttributeFormat::sizeOf(attribute.format);
+        if (size == 0 || size > attribute.size) {
+            throw "vertex attribute format is larger than its member";
+        }
+        if (attribute.offset + size > layout.stride) {
+            throw "vertex attribute is out of the vertex struct";
+        }
+        layout.attributes[i] = VertexAttribute{
+            .location   = i,
+            .bufferSlot = 0,
+            .format     = attribute.format,
+            .offset     = attribute.offset,
+        };
+    }
+    return layout;
+}
+
+// Check the explicit layout of `pipelineCI` against the inputs of the vertex stage:
+// every input needs an attribute at its location with enough components, attributes must fit in their buffer pitch.
+// Logs every mismatch, false if there was any
+bool validateVertexLayout(const GraphicsPipelineCreateInfo &pipelineCI, const ShaderReflection::ShaderResources &vertexResources);
@@ -0,0 +1,110 @@
+#include "VertexWelder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+#include "Core/Hash.h"
+#include "Core/Log.h"
+#include "Render/Model.h"
+
+namespace VertexWelder
+{
+
+static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+// position, normal, texCoord, color
+using Key = std::array<uint32_t, 12>;
+
+static uint32_t quantize(float value, float epsilon)
+{
+    if (epsilon <= 0.0f) {
+        return std::bit_cast<uint32_t>(value + 0.0f); // -0 + 0 is +0
+    }
+    double cell = std::floor(double(value) / epsilon);
+    cell        = std::clamp(cell, double(std::numeric_limits<int32_t>::min()), double(std::numeric_limits<int32_t>::max()));
+    return static_cast<uint32_t>(static_cast<int32_t>(cell));
+}
+
+static Key makeKey(const Vertex &vertex, const Settings &settings)
+{
+    return Key{
+        quantize(vertex.position.x, settings.positionEpsilon),
+        quantize(vertex.position.y, settings.positionEpsilon),
+        quantize(vertex.position.z, settings.positionEpsilon),
+        quantize(vertex.normal.x, settings.normalEpsilon),
+        quantize(vertex.normal.y, settings.normalEpsilon),
+        quantize(vertex.normal.z, settings.normalEpsilon),
+        quantize(vertex.texCoord.x, settings.texCoordEpsilon),
+        quantize(vertex.texCoord.y, settings.texCoordEpsilon),
+        quantize(vertex.color.r, settings.colorEpsilon),
+        quantize(vertex.color.g, settings.colorEpsilon),
+        quantize(vertex.color.b, settings.colorEpsilon),
+        quantize(vertex.color.a, settings.colorEpsilon),
+    };
+}
+
+Stats weld(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, const Settings &settings)
+{
+    std::size_t vertexCount = vertices.size();
+    Stats       stats{
+              .verticesBefore = vertexCount,
+              .verticesAfter  = vertexCount,
+              .bytesBefore    = vertexCount * sizeof(Vertex) + indices.size() * sizeof(uint32_t),
+              .bytesAfter     = vertexCount * sizeof(Vertex) + indices.size() * sizeof(uint32_t),
+    };
+    if (vertexCount == 0 || std::any_of(indices.begin(), indices.end(), [&](uint32_t index) { return index >= vertexCount; })) {
+        return stats;
+    }
+
+    std::vector<Key> keys(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        keys[v] = makeKey(vertices[v], settings);
+    }
+
+    auto keyHash = [&](uint32_t v) { return Hash::fnv1a64(keys[v].data(), sizeof(Key)); };
+    auto keyEq   = [&](uint32_t a, uint32_t b) { return keys[a] == keys[b]; };
+    std::unordered_set<uint32_t, decltype(keyHash), decltype(keyEq)> unique(vertexCount, keyHash, keyEq);
+
+    // the first vertex of each key moves to the front, in order, the others point to it
+    std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+    uint32_t              uniqueCount = 0;
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        auto [it, bInserted] = unique.insert(v);
+        if (bInserted) {
+            remap[v]                = uniqueCount;
+            vertices[uniqueCount++] = vertices[v];
+        }
+        else {
+            remap[v] = remap[*it];
+        }
+    }
+
+    if (uniqueCount == vertexCount) {
+        return stats;
+    }
+    vertices.resize(uniqueCount);
+    vertices.shrink_to_fit();
+    for (uint32_t &index : indices) {
+        index = remap[index];
+    }
+
+    stats.verticesAfter = uniqueCount;
+    stats.bytesAfter    = uniqueCount * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
+    return stats;
+}
+
+Stats weld(Mesh &mesh, const Settings &settings)
+{
+    Stats stats = weld(mesh.vertices, mesh.indices, settings);
+    if (stats.verticesAfter == stats.verticesBefore &&
+        std::any_of(mesh.indices.begin(), mesh.indices.end(), [&](uint32_t index) { return index >= mesh.vertices.size(); })) {
+        NE_CORE_WARN("VertexWelder: {} has out of range indices, left as is", mesh.name);
+    }
+    return stats;
+}
+
+} // namespace VertexWelder
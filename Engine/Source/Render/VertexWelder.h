@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct Mesh;
+
+// Merges duplicated vertices and rewrites the indices, the first step after reading a mesh at import.
+// Formats like OBJ store positions, normals and uvs in separate index spaces, Assimp expands them to one
+// vertex per face corner, so a closed mesh comes in with every vertex repeated by each face around it.
+//
+// An epsilon of 0 merges bitwise equal attributes (+0 and -0 are equal). A positive one snaps the attribute
+// to a grid of that size and merges the vertices in the same cell, so two values closer than epsilon can
+// still land in neighbouring cells and stay apart; the merged vertex keeps the attributes of the first one
+namespace VertexWelder
+{
+
+struct Settings
+{
+    float positionEpsilon = 0.0f;
+    float normalEpsilon   = 0.0f;
+    float texCoordEpsilon = 0.0f;
+    float colorEpsilon    = 0.0f;
+};
+
+struct Stats
+{
+    std::size_t verticesBefore = 0;
+    std::size_t verticesAfter  = 0;
+    std::size_t bytesBefore    = 0; // of the vertex and index buffers
+    std::size_t bytesAfter     = 0;
+
+    std::size_t bytesSaved() const { return bytesBefore - bytesAfter; }
+};
+
+// Keeps the unique vertices in first occurrence order and remaps `indices` to them.
+// Indices out of range are left alone and keep every vertex (nothing is merged)
+Stats weld(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, const Settings &settings = {});
+
+// weld on `mesh.vertices` and `mesh.indices`, before the optimization and the LODs
+Stats weld(Mesh &mesh, const Settings &settings = {});
+
+} // namespace VertexWelder
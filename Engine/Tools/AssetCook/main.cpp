@@ -0,0 +1,477 @@
+// neon-cook: cooks the source assets of the content directories into the formats the runtime maps as is:
+//   models  (.obj .fbx .gltf .glb .dae .3ds .ply .stl)   -> .nmesh, imported with ModelImporter, see MeshFile
+//   images  (.png .jpg .jpeg .bmp .tga .gif .webp)        -> .ntex, decoded with SDL_image to RGBA8 with a full mip chain,
+//                                                            then BC1/BC5/BC7 encoded, see TextureFile, TextureMips and BlockCompression
+// The outputs mirror the sources under Engine/Intermediate/Cooked, e.g.
+//   Engine/Content/Misc/Monkey.obj -> Engine/Intermediate/Cooked/Engine/Content/Misc/Monkey.nmesh
+// Every asset is cooked on its own task over all cores. An asset is skipped when its output exists and the hash of
+// its source bytes, of the files it references (.mtl, .bin, ...) and of the cooker versions matches the manifest of the previous run.
+//
+// usage: neon-cook [--force] [--jobs N] [--uncompressed] [content dirs...]   (run from the project root, default Engine/Content)
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include "Core/FileSystem/BinaryStream.h"
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/FileSystem/MappedFile.h"
+#include "Core/Hash.h"
+#include "Core/Log.h"
+#include "Core/ThreadPool.h"
+#include "Render/BlockCompression.h"
+#include "Render/MeshFile.h"
+#include "Render/Model.h"
+#include "Render/ModelImporter.h"
+#include "Render/TextureFile.h"
+#include "Render/TextureMips.h"
+
+namespace
+{
+
+constexpr std::string_view OUTPUT_DIR     = "Engine/Intermediate/Cooked";
+constexpr std::string_view MANIFEST_PATH  = "Engine/Intermediate/Cooked/CookManifest.bin";
+constexpr uint32_t         MANIFEST_MAGIC = 0x4D4B434E; // "NCKM"
+constexpr uint32_t         MANIFEST_VER   = 2; // 2: dependencies
+
+constexpr TextureMips::EFilter MIP_FILTER = TextureMips::EFilter::Kaiser;
+
+enum class EAssetKind
+{
+    Model,
+    Texture,
+};
+
+enum class ECookStatus
+{
+    Cooked,
+    UpToDate,
+    Failed,
+};
+
+struct CookOptions
+{
+    bool        bForce            = false;
+    bool        bCompressTextures = true;
+    ThreadPool *encodePool        = nullptr; // the blocks of a texture, separate from the pool running the cook tasks
+};
+
+struct Asset
+{
+    EAssetKind  kind;
+    std::string source; // relative to the project root
+    std::string output;
+};
+
+struct ManifestEntry
+{
+    uint64_t                 hash = 0;
+    std::vector<std::string> dependencies; // sidecar files the importer opened, relative to the project root
+};
+
+struct CookResult
+{
+    ECookStatus   status = ECookStatus::Failed;
+    ManifestEntry entry;
+    std::size_t sourceSize = 0;
+    std::size_t outputSize = 0;
+    double      readMs     = 0.0; // map + hash
+    double      importMs   = 0.0; // Assimp or SDL_image + mips
+    double      writeMs    = 0.0; // serialize + write
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+bool isModel(const std::string &extension)
+{
+    static const std::unordered_set<std::string> extensions = {".obj", ".fbx", ".gltf", ".glb", ".dae", ".3ds", ".ply", ".stl"};
+    return extensions.contains(extension);
+}
+
+bool isTexture(const std::string &extension)
+{
+    static const std::unordered_set<std::string> extensions = {".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".webp"};
+    return extensions.contains(extension);
+}
+
+// color textures are authored in sRGB and filtered in linear space, data textures (normal maps) as they are
+bool isLinearTexture(const std::string &source)
+{
+    std::string stem = std::filesystem::path(source).stem().string();
+    std::transform(stem.begin(), stem.end(), stem.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return stem.find("normal") != std::string::npos || stem.ends_with("_n");
+}
+
+// everything the cooked bytes depend on besides the source
+uint64_t cookerHash(EAssetKind kind, const CookOptions &cookOptions)
+{
+    const ModelImporter::Options options;
+    switch (kind) {
+    case EAssetKind::Model:
+        return Hash::combine(Hash::combine(ModelImporter::VERSION, MeshFile::VERSION), options.bPackVertices);
+    case EAssetKind::Texture:
+        return Hash::combine(Hash::combine(TextureFile::VERSION, static_cast<uint64_t>(MIP_FILTER)), cookOptions.bCompressTextures);
+    }
+    return 0;
+}
+
+std::unordered_map<std::string, ManifestEntry> readManifest()
+{
+    std::unordered_map<std::string, ManifestEntry> manifest;
+
+    std::string data;
+    if (!FileSystem::get()->isFileExists(std::string(MANIFEST_PATH)) || !FileSystem::get()->readFileToString(MANIFEST_PATH, data)) {
+        return manifest;
+    }
+
+    BinaryReader reader(data);
+    uint32_t     magic = 0, version = 0, count = 0;
+    reader.read(magic);
+    reader.read(version);
+    reader.read(count);
+    if (!reader.bOk || magic != MANIFEST_MAGIC || version != MANIFEST_VER) {
+        NE_CORE_WARN("Ignoring the outdated cook manifest {}", MANIFEST_PATH);
+        return manifest;
+    }
+    for (uint32_t i = 0; i < count && reader.bOk; ++i) {
+        std::string   source;
+        ManifestEntry entry;
+        uint32_t      dependencyCount = 0;
+        reader.readString(source);
+        reader.read(entry.hash);
+        reader.read(dependencyCount);
+        for (uint32_t d = 0; d < dependencyCount && reader.bOk; ++d) {
+            reader.readString(entry.dependencies.emplace_back());
+        }
+        manifest[source] = std::move(entry);
+    }
+    if (!reader.bOk) {
+        NE_CORE_WARN("Corrupted cook manifest {}, cooking everything", MANIFEST_PATH);
+        manifest.clear();
+    }
+    return manifest;
+}
+
+bool writeManifest(const std::vector<Asset> &assets, const std::vector<CookResult> &results)
+{
+    BinaryWriter writer;
+    uint32_t     count = 0;
+    for (const auto &result : results) {
+        count += result.status != ECookStatus::Failed ? 1 : 0;
+    }
+    writer.write(MANIFEST_MAGIC);
+    writer.write(MANIFEST_VER);
+    writer.write(count);
+    for (std::size_t i = 0; i < assets.size(); ++i) {
+        if (results[i].status != ECookStatus::Failed) {
+            const auto &entry = results[i].entry;
+            writer.writeString(assets[i].source);
+            writer.write(entry.hash);
+            writer.write<uint32_t>(static_cast<uint32_t>(entry.dependencies.size()));
+            for (const auto &dependency : entry.dependencies) {
+                writer.writeString(dependency);
+            }
+        }
+    }
+    return FileSystem::get()->writeFile(MANIFEST_PATH, writer.view());
+}
+
+// the source bytes, the dependencies and the cooker versions, a missing dependency hashes differently than an empty one
+uint64_t hashAsset(const Asset &asset, const MappedFile &source, const std::vector<std::string> &dependencies, const CookOptions &cookOptions)
+{
+    uint64_t hash = Hash::combine(Hash::fnv1a64(source.getData(), source.getSize()), cookerHash(asset.kind, cookOptions));
+    for (const auto &dependency : dependencies) {
+        hash = Hash::combine(hash, Hash::fnv1a64(dependency));
+        auto mapped = FileSystem::get()->isFileExists(dependency) ? FileSystem::get()->mapFile(dependency) : nullptr;
+        hash        = Hash::combine(hash, mapped ? Hash::fnv1a64(mapped->getData(), mapped->getSize()) : 0);
+    }
+    return hash;
+}
+
+bool cookModel(const Asset &asset, CookResult &result)
+{
+    // through the FileSystem IOSystem, so the .mtl/.bin files next to the model are found and recorded
+    auto begin = Clock::now();
+    auto model = ModelImporter::import(asset.source, {}, &result.entry.dependencies);
+    result.importMs = elapsedMs(begin);
+    if (!model) {
+        return false;
+    }
+
+    begin = Clock::now();
+    std::vector<uint8_t> bytes;
+    MeshFile::write(*model, bytes);
+    bool bWritten     = FileSystem::get()->writeFile(asset.output, std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()));
+    result.writeMs    = elapsedMs(begin);
+    result.outputSize = bytes.size();
+    return bWritten;
+}
+
+// BC7 mode 6 puts alpha on the same endpoint line as the color, which breaks down in blocks where both
+// change on their own (colored art with soft edges). BC3 keeps alpha in a separate block and wins there
+bool isAlphaIndependent(const std::vector<uint8_t> &pixels, uint32_t width, uint32_t height)
+{
+    constexpr int RANGE = 32;
+    uint32_t alphaBlocks = 0, mixedBlocks = 0;
+    for (uint32_t by = 0; by < height; by += 4) {
+        for (uint32_t bx = 0; bx < width; bx += 4) {
+            uint8_t lo[4] = {255, 255, 255, 255}, hi[4] = {};
+            for (uint32_t y = by; y < by + 4; ++y) {
+                const uint8_t *pixel = &pixels[(std::size_t(y) * width + bx) * 4];
+                for (uint32_t i = 0; i < 16; ++i) {
+                    lo[i % 4] = std::min(lo[i % 4], pixel[i]);
+                    hi[i % 4] = std::max(hi[i % 4], pixel[i]);
+                }
+            }
+            if (hi[3] - lo[3] <= RANGE) {
+                continue;
+            }
+            ++alphaBlocks;
+            if (hi[0] - lo[0] > RANGE || hi[1] - lo[1] > RANGE || hi[2] - lo[2] > RANGE) {
+                ++mixedBlocks;
+            }
+        }
+    }
+    return mixedBlocks * 4 > alphaBlocks;
+}
+
+// BC5 for normal maps, BC1 when opaque, BC3 or BC7 with alpha. Uncompressed if level 0 is not whole blocks, D3D12 requires it
+ETextureFormat textureFormat(const Asset &asset, const std::vector<uint8_t> &pixels, uint32_t width, uint32_t height, const CookOptions &cookOptions)
+{
+    if (!cookOptions.bCompressTextures || width % 4 != 0 || height % 4 != 0) {
+        return ETextureFormat::R8G8B8A8_UNORM;
+    }
+    if (isLinearTexture(asset.source)) {
+        return ETextureFormat::BC5_RG_UNORM;
+    }
+    for (std::size_t i = 3; i < pixels.size(); i += 4) {
+        if (pixels[i] != 255) {
+            return isAlphaIndependent(pixels, width, height) ? ETextureFormat::BC3_RGBA_UNORM : ETextureFormat::BC7_RGBA_UNORM;
+        }
+    }
+    return ETextureFormat::BC1_RGBA_UNORM;
+}
+
+bool cookTexture(const Asset &asset, const MappedFile &source, CookResult &result, const CookOptions &cookOptions)
+{
+    auto         begin   = Clock::now();
+    SDL_Surface *decoded = IMG_Load_IO(SDL_IOFromConstMem(source.getData(), source.getSize()), true);
+    if (!decoded) {
+        NE_CORE_ERROR("Failed to decode {}: {}", asset.source, SDL_GetError());
+        return false;
+    }
+    // R, G, B, A bytes in memory, whatever the source format was
+    SDL_Surface *surface = SDL_ConvertSurface(decoded, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(decoded);
+    if (!surface) {
+        NE_CORE_ERROR("Failed to convert {} to RGBA8: {}", asset.source, SDL_GetError());
+        return false;
+    }
+
+    const std::size_t    rowSize = std::size_t(surface->w) * 4;
+    std::vector<uint8_t> pixels(rowSize * surface->h);
+    for (int y = 0; y < surface->h; ++y) {
+        std::memcpy(pixels.data() + y * rowSize, static_cast<const uint8_t *>(surface->pixels) + std::size_t(y) * surface->pitch, rowSize);
+    }
+    uint32_t width  = static_cast<uint32_t>(surface->w);
+    uint32_t height = static_cast<uint32_t>(surface->h);
+    SDL_DestroySurface(surface);
+
+    uint32_t             mipCount = TextureMips::levelCount(width, height);
+    std::vector<uint8_t> levels   = TextureMips::generate(pixels.data(), width, height, mipCount, MIP_FILTER, !isLinearTexture(asset.source));
+
+    ETextureFormat format = textureFormat(asset, pixels, width, height, cookOptions);
+    if (format != ETextureFormat::R8G8B8A8_UNORM) {
+        std::vector<uint8_t> encoded;
+        for (const TextureMips::Level &level : TextureMips::layout(width, height, mipCount, 4)) {
+            auto blocks = BlockCompression::encode(format, levels.data() + level.offset, level.width, level.height, cookOptions.encodePool);
+            encoded.insert(encoded.end(), blocks.begin(), blocks.end());
+        }
+        levels = std::move(encoded);
+    }
+    result.importMs = elapsedMs(begin);
+
+    begin = Clock::now();
+    std::vector<uint8_t> bytes;
+    TextureFile::write(width, height, format, mipCount, levels.data(), bytes);
+    bool bWritten     = FileSystem::get()->writeFile(asset.output, std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()));
+    result.writeMs    = elapsedMs(begin);
+    result.outputSize = bytes.size();
+    return bWritten;
+}
+
+CookResult cook(const Asset &asset, const ManifestEntry *previous, const CookOptions &cookOptions)
+{
+    CookResult result;
+
+    auto begin  = Clock::now();
+    auto source = FileSystem::get()->mapFile(asset.source);
+    if (!source) {
+        return result;
+    }
+    // with the dependencies of the previous cook, if they changed the hash does as well
+    result.sourceSize = source->getSize();
+    result.entry.hash = hashAsset(asset, *source, previous ? previous->dependencies : std::vector<std::string>{}, cookOptions);
+    result.readMs     = elapsedMs(begin);
+
+    if (!cookOptions.bForce && previous && result.entry.hash == previous->hash && FileSystem::get()->isFileExists(asset.output)) {
+        result.status             = ECookStatus::UpToDate;
+        result.entry.dependencies = previous->dependencies;
+        return result;
+    }
+
+    bool bOk = asset.kind == EAssetKind::Model ? cookModel(asset, result) : cookTexture(asset, *source, result, cookOptions);
+    if (bOk && (!previous || result.entry.dependencies != previous->dependencies)) {
+        result.entry.hash = hashAsset(asset, *source, result.entry.dependencies, cookOptions);
+    }
+    result.status = bOk ? ECookStatus::Cooked : ECookStatus::Failed;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FileSystem::init();
+    Logger::init();
+
+    CookOptions              cookOptions;
+    std::size_t              jobs = 0; // all cores
+    std::vector<std::string> contentDirs;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--force") {
+            cookOptions.bForce = true;
+        }
+        else if (arg == "--uncompressed") {
+            cookOptions.bCompressTextures = false;
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        }
+        else {
+            contentDirs.emplace_back(arg);
+        }
+    }
+    if (contentDirs.empty()) {
+        contentDirs.emplace_back("Engine/Content");
+    }
+
+    const auto &root = FileSystem::get()->getProjectRoot();
+
+    std::vector<Asset>              assets;
+    std::unordered_set<std::string> outputs;
+    for (const auto &dir : contentDirs) {
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(root / dir, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator();
+             it.increment(ec))
+        {
+            if (!it->is_regular_file()) {
+                continue;
+            }
+            std::string extension = it->path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+            Asset asset;
+            if (isModel(extension)) {
+                asset.kind = EAssetKind::Model;
+            }
+            else if (isTexture(extension)) {
+                asset.kind = EAssetKind::Texture;
+            }
+            else {
+                continue;
+            }
+
+            auto relative = std::filesystem::relative(it->path(), root);
+            auto output   = std::filesystem::path(OUTPUT_DIR) / relative;
+            output.replace_extension(asset.kind == EAssetKind::Model ? MeshFile::EXTENSION : TextureFile::EXTENSION);
+            asset.source = relative.generic_string();
+            asset.output = output.generic_string();
+
+            // Monkey.obj and Monkey.fbx would both cook to Monkey.nmesh
+            if (!outputs.insert(asset.output).second) {
+                NE_CORE_ERROR("{} cooks to {} which another source already cooks to, skipped", asset.source, asset.output);
+                continue;
+            }
+            assets.push_back(std::move(asset));
+        }
+        if (ec) {
+            NE_CORE_ERROR("Failed to scan {}: {}", dir, ec.message());
+        }
+    }
+    // stable order, so the log and the manifest are the same for the same content
+    std::sort(assets.begin(), assets.end(), [](const Asset &a, const Asset &b) { return a.source < b.source; });
+
+    auto manifest = readManifest();
+    auto begin    = Clock::now();
+
+    std::vector<CookResult> results(assets.size());
+    {
+        ThreadPool                           encodePool("Encode", jobs);
+        ThreadPool                           pool("Cook", jobs);
+        std::vector<std::future<CookResult>> futures;
+        cookOptions.encodePool = &encodePool;
+        futures.reserve(assets.size());
+        for (const auto &asset : assets) {
+            auto                 it       = manifest.find(asset.source);
+            const ManifestEntry *previous = it != manifest.end() ? &it->second : nullptr;
+            futures.push_back(pool.enqueue([&asset, previous, &cookOptions]() { return cook(asset, previous, cookOptions); }));
+        }
+
+        for (std::size_t i = 0; i < assets.size(); ++i) {
+            results[i]         = futures[i].get();
+            const auto &result = results[i];
+            switch (result.status) {
+            case ECookStatus::Cooked:
+                NE_CORE_INFO("Cooked {} -> {} ({} -> {} bytes) in {:.1f} ms: read {:.1f}, import {:.1f}, write {:.1f}",
+                             assets[i].source,
+                             assets[i].output,
+                             result.sourceSize,
+                             result.outputSize,
+                             result.readMs + result.importMs + result.writeMs,
+                             result.readMs,
+                             result.importMs,
+                             result.writeMs);
+                break;
+            case ECookStatus::UpToDate:
+                NE_CORE_INFO("Up to date {} ({:.1f} ms)", assets[i].source, result.readMs);
+                break;
+            case ECookStatus::Failed:
+                NE_CORE_ERROR("Failed to cook {}", assets[i].source);
+                break;
+            }
+        }
+    }
+
+    writeManifest(assets, results);
+
+    auto count = [&results](ECookStatus status) {
+        return std::count_if(results.begin(), results.end(), [status](const CookResult &result) { return result.status == status; });
+    };
+    auto failed = count(ECookStatus::Failed);
+    NE_CORE_INFO("{} assets: {} cooked, {} up to date, {} failed in {:.1f} ms",
+                 assets.size(),
+                 count(ECookStatus::Cooked),
+                 count(ECookStatus::UpToDate),
+                 failed,
+                 elapsedMs(begin));
+    return failed > 0 ? 1 : 0;
+}
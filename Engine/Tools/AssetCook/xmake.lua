@@ -0,0 +1,43 @@
+-- Offline asset cooker, writes the .nmesh/.ntex files the runtime loads without Assimp or SDL_image decoding
+-- usage: xmake run neon-cook [--force] [--jobs N] [content dirs...]
+target("neon-cook")
+do
+    set_kind("binary")
+    set_group("tools")
+
+    add_files("./main.cpp")
+    add_files(
+        "../../Source/Core/Log.cpp",
+        "../../Source/Core/FileSystem/FileSystem.cpp",
+        "../../Source/Core/FileSystem/MappedFile.cpp",
+        "../../Source/Render/AssimpIOSystem.cpp",
+        "../../Source/Render/BlockCompression.cpp",
+        "../../Source/Render/MeshBounds.cpp",
+        "../../Source/Render/MeshFile.cpp",
+        "../../Source/Render/MeshOptimizer.cpp",
+        "../../Source/Render/MeshSimplifier.cpp",
+        "../../Source/Render/MeshletBuilder.cpp",
+        "../../Source/Render/ModelImporter.cpp",
+        "../../Source/Render/TextureFile.cpp",
+        "../../Source/Render/TextureMips.cpp",
+        "../../Source/Render/VertexCompression.cpp",
+        "../../Source/Render/VertexLayout.cpp",
+        "../../Source/Render/VertexWelder.cpp"
+    )
+    add_includedirs("../../Source")
+
+    add_deps("utility.cc")
+    add_deps("log.cc")
+    add_deps("reflect.cc")
+
+    add_packages("libsdl3")
+    add_packages("libsdl3_image")
+    add_packages("glm")
+    add_packages("assimp")
+
+    add_defines("NE_WITH_ASSET_IMPORTER=1")
+
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+end
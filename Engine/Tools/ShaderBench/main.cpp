@@ -0,0 +1,364 @@
+// neon-shaderbench: times each phase of the shader path over every permutation of every shader under Engine/Shader/GLSL
+// and writes the numbers as JSON, so a regression in shader build time shows up as a diff.
+//
+// Phases, cold (every iteration goes through the whole path, the SPIR-V and reflection caches are not used):
+//   read        GLSLScriptProcessor::readSource (FileSystem::readFileToString + include expansion)
+//   split       GLSLScriptProcessor::splitStages, the #type split
+//   compile.*   GLSLScriptProcessor::compileStage per stage (shaderc)
+//   validate    GLSLScriptProcessor::validateSpirv over all stages
+//   reflect     GLSLScriptProcessor::reflect over all stages (SPIRV-Cross)
+//   sdl_create  SDL_CreateGPUShader of both stages, only with --device
+// Warm (the caches are primed once before timing):
+//   process     GLSLScriptProcessor::process, hits the SPIR-V cache
+//   reflect     ShaderScriptProcessor::reflectWithCache, hits the reflection sidecar
+//
+// usage: neon-shaderbench [--iterations N] [--mode cold|warm|both] [--device] [--output file.json|-]   (run from the project root)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/Log.h"
+#include "Platform/Render/SDL/SDLShader.h"
+#include "Render/Shader.h"
+
+namespace
+{
+
+constexpr std::string_view DEFAULT_OUTPUT = "Engine/Intermediate/ShaderBench.json";
+
+// phase name -> one sample per iteration, in ms
+using PhaseSamples = std::map<std::string, std::vector<double>>;
+
+struct Variant
+{
+    std::string       name;
+    ShaderPermutation permutation;
+    PhaseSamples      cold;
+    PhaseSamples      warm;
+    bool              bFailed = false;
+};
+
+struct Options
+{
+    int         iterations = 10;
+    bool        bCold      = true;
+    bool        bWarm      = true;
+    bool        bDevice    = false;
+    std::string output     = std::string(DEFAULT_OUTPUT);
+};
+
+template <typename Fn>
+auto timed(std::vector<double> &samples, Fn &&fn)
+{
+    auto begin  = std::chrono::steady_clock::now();
+    auto result = fn();
+    samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+    return result;
+}
+
+bool parseOptions(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg  = argv[i];
+        bool             next = i + 1 < argc;
+        if (arg == "--iterations" && next) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--mode" && next) {
+            std::string_view mode = argv[++i];
+            options.bCold         = mode == "cold" || mode == "both";
+            options.bWarm         = mode == "warm" || mode == "both";
+            if (!options.bCold && !options.bWarm) {
+                NE_CORE_ERROR("Unknown mode {}, expected cold, warm or both", mode);
+                return false;
+            }
+        }
+        else if (arg == "--device") {
+            options.bDevice = true;
+        }
+        else if (arg == "--output" && next) {
+            options.output = argv[++i];
+        }
+        else {
+            NE_CORE_ERROR("Unknown argument {}", arg);
+            return false;
+        }
+    }
+    return true;
+}
+
+// one full pass over the shader path without any cache
+bool runCold(GLSLScriptProcessor &processor, SDL_GPUDevice *device, Variant &variant)
+{
+    auto &phases = variant.cold;
+
+    std::string source;
+    if (!timed(phases["read"], [&] { return processor.readSource(variant.name, source); })) {
+        return false;
+    }
+
+    auto sources = timed(phases["split"], [&] { return GLSLScriptProcessor::splitStages(source); });
+    if (!sources) {
+        return false;
+    }
+
+    std::string                               debugName = variant.permutation.variantName(variant.name);
+    ShaderScriptProcessor::stage2spirv_t      spirv;
+    ShaderScriptProcessor::stage2reflection_t resources;
+    for (const auto &[stage, stageSource] : *sources) {
+        auto &samples = phases[std::format("compile.{}", EShaderStage::T2Strings[stage])];
+        auto  code    = timed(samples, [&] { return GLSLScriptProcessor::compileStage(debugName, stage, stageSource, variant.permutation); });
+        if (!code) {
+            return false;
+        }
+        spirv[stage] = std::move(*code);
+    }
+
+    bool bValid = timed(phases["validate"], [&] {
+        return std::all_of(spirv.begin(), spirv.end(), [](const auto &entry) { return GLSLScriptProcessor::validateSpirv(entry.second); });
+    });
+    if (!bValid) {
+        return false;
+    }
+
+    timed(phases["reflect"], [&] {
+        for (const auto &[stage, code] : spirv) {
+            resources[stage] = processor.reflect(stage, code);
+        }
+        return true;
+    });
+
+    if (device) {
+        CompiledShader compiled{
+            .name         = variant.name,
+            .permutation  = variant.permutation,
+            .dependencies = {},
+            .spirv        = std::move(spirv),
+            .resources    = std::move(resources),
+        };
+        // the create infos are prepared outside the timing, only the driver work is measured
+        SDL::SDLShaderProcessor sdlShader(*device);
+        sdlShader.preprocess(compiled);
+        timed(phases["sdl_create"], [&] {
+            sdlShader.create();
+            return true;
+        });
+        bool bCreated = sdlShader.vertexShader && sdlShader.fragmentShader;
+        sdlShader.clean();
+        if (!bCreated) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runWarm(GLSLScriptProcessor &processor, Variant &variant)
+{
+    auto &phases = variant.warm;
+
+    auto spirv = timed(phases["process"], [&] { return processor.process(variant.name, variant.permutation); });
+    if (!spirv) {
+        return false;
+    }
+    auto resources = timed(phases["reflect"], [&] { return processor.reflectWithCache(variant.permutation.variantName(variant.name), *spirv); });
+    return !resources.empty();
+}
+
+std::string escapeJson(std::string_view text)
+{
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+std::string statsJson(std::vector<double> samples)
+{
+    if (samples.empty()) {
+        return "{}";
+    }
+    std::sort(samples.begin(), samples.end());
+    double      total  = std::accumulate(samples.begin(), samples.end(), 0.0);
+    std::size_t middle = samples.size() / 2;
+    double      median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+    return std::format(R"({{"count": {}, "total_ms": {:.4f}, "min_ms": {:.4f}, "mean_ms": {:.4f}, "median_ms": {:.4f}, "max_ms": {:.4f}}})",
+                       samples.size(),
+                       total,
+                       samples.front(),
+                       total / samples.size(),
+                       median,
+                       samples.back());
+}
+
+std::string phasesJson(const PhaseSamples &phases, std::string_view indent)
+{
+    std::string out = "{";
+    bool        bFirst = true;
+    for (const auto &[phase, samples] : phases) {
+        out += std::format("{}\n{}  \"{}\": {}", bFirst ? "" : ",", indent, phase, statsJson(samples));
+        bFirst = false;
+    }
+    out += phases.empty() ? "}" : std::format("\n{}}}", indent);
+    return out;
+}
+
+std::string toJson(const Options &options, const char *deviceDriver, const std::vector<Variant> &variants)
+{
+    // every sample of every variant, per phase
+    PhaseSamples coldTotals, warmTotals;
+    int          failed = 0;
+    for (const auto &variant : variants) {
+        for (const auto &[phase, samples] : variant.cold) {
+            coldTotals[phase].insert(coldTotals[phase].end(), samples.begin(), samples.end());
+        }
+        for (const auto &[phase, samples] : variant.warm) {
+            warmTotals[phase].insert(warmTotals[phase].end(), samples.begin(), samples.end());
+        }
+        failed += variant.bFailed ? 1 : 0;
+    }
+
+    std::string out = "{\n";
+    out += std::format("  \"iterations\": {},\n", options.iterations);
+    out += std::format("  \"device\": {},\n", deviceDriver ? std::format("\"{}\"", escapeJson(deviceDriver)) : "null");
+    out += std::format("  \"failed\": {},\n", failed);
+    out += "  \"variants\": [";
+    for (std::size_t i = 0; i < variants.size(); ++i) {
+        const auto &variant = variants[i];
+        out += std::format("{}\n    {{\n", i == 0 ? "" : ",");
+        out += std::format("      \"shader\": \"{}\",\n", escapeJson(variant.name));
+        out += std::format("      \"permutation\": \"{}\",\n", escapeJson(variant.permutation.key()));
+        out += std::format("      \"failed\": {},\n", variant.bFailed);
+        out += std::format("      \"cold\": {},\n", phasesJson(variant.cold, "      "));
+        out += std::format("      \"warm\": {}\n", phasesJson(variant.warm, "      "));
+        out += "    }";
+    }
+    out += variants.empty() ? "],\n" : "\n  ],\n";
+    out += "  \"totals\": {\n";
+    out += std::format("    \"cold\": {},\n", phasesJson(coldTotals, "    "));
+    out += std::format("    \"warm\": {}\n", phasesJson(warmTotals, "    "));
+    out += "  }\n}\n";
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FileSystem::init();
+    Logger::init();
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    SDL_GPUDevice *device = nullptr;
+    if (options.bDevice) {
+        if (SDL_Init(SDL_INIT_VIDEO)) {
+            device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV, false, nullptr);
+        }
+        if (!device) {
+            NE_CORE_WARN("No GPU device, sdl_create is not measured: {}", SDL_GetError());
+        }
+    }
+
+    auto factory   = ShaderScriptProcessorFactory::defaultGLSL();
+    auto processor = std::static_pointer_cast<GLSLScriptProcessor>(factory.FactoryNew());
+    auto shaderDir = FileSystem::get()->getProjectRoot() / factory.shaderStoragePath;
+
+    std::vector<Variant> variants;
+    std::error_code      ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(shaderDir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator();
+         it.increment(ec))
+    {
+        if (!it->is_regular_file() || it->path().extension() != ".glsl") {
+            continue;
+        }
+
+        std::string name = std::filesystem::relative(it->path(), shaderDir).generic_string();
+        std::string source;
+        if (!processor->readSource(name, source)) {
+            continue;
+        }
+        // include-only files have no stage
+        if (source.find("#type") == std::string::npos) {
+            continue;
+        }
+        for (auto &permutation : GLSLScriptProcessor::parsePermutations(source)) {
+            variants.push_back(Variant{
+                .name        = name,
+                .permutation = std::move(permutation),
+            });
+        }
+    }
+    // stable order, so two runs diff line by line
+    std::sort(variants.begin(), variants.end(), [](const Variant &a, const Variant &b) {
+        return std::tie(a.name, a.permutation.defines) < std::tie(b.name, b.permutation.defines);
+    });
+
+    for (auto &variant : variants) {
+        if (options.bCold) {
+            for (int i = 0; i < options.iterations && !variant.bFailed; ++i) {
+                variant.bFailed = !runCold(*processor, device, variant);
+            }
+        }
+        if (options.bWarm && !variant.bFailed) {
+            // prime the SPIR-V cache and the reflection sidecar, not timed
+            auto spirv = processor->process(variant.name, variant.permutation);
+            if (!spirv) {
+                variant.bFailed = true;
+                continue;
+            }
+            std::ignore = processor->reflectWithCache(variant.permutation.variantName(variant.name), *spirv);
+
+            for (int i = 0; i < options.iterations && !variant.bFailed; ++i) {
+                variant.bFailed = !runWarm(*processor, variant);
+            }
+        }
+        if (variant.bFailed) {
+            NE_CORE_ERROR("Benchmark of {} [{}] failed", variant.name, variant.permutation.key());
+        }
+    }
+
+    std::string json = toJson(options, device ? SDL_GetGPUDeviceDriver(device) : nullptr, variants);
+    if (device) {
+        SDL_DestroyGPUDevice(device);
+        SDL_Quit();
+    }
+
+    if (options.output == "-") {
+        std::fputs(json.c_str(), stdout);
+    }
+    else if (!FileSystem::get()->writeFile(options.output, json)) {
+        return 1;
+    }
+    else {
+        NE_CORE_INFO("Benchmarked {} shader variants x {} iterations into {}", variants.size(), options.iterations, options.output);
+    }
+
+    bool bAnyFailed = std::any_of(variants.begin(), variants.end(), [](const Variant &variant) { return variant.bFailed; });
+    return bAnyFailed ? 1 : 0;
+}
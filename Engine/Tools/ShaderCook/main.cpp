@@ -0,0 +1,100 @@
+// neon-shadercook: compiles every stage of every declared permutation under Engine/Shader/GLSL
+// and packs them with their reflection data into one ShaderLibrary file.
+//
+// usage: neon-shadercook [output path]   (run from the project root)
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Core/FileSystem/FileSystem.h"
+#include "Core/Log.h"
+#include "Render/ShaderBuildService.h"
+#include "Render/ShaderLibrary.h"
+
+int main(int argc, char **argv)
+{
+    FileSystem::init();
+    Logger::init();
+    ShaderBuildService::init();
+
+    std::string outputPath = argc > 1 ? argv[1] : std::string(ShaderLibrary::DEFAULT_PATH);
+
+    auto factory   = ShaderScriptProcessorFactory::defaultGLSL();
+    auto processor = std::static_pointer_cast<GLSLScriptProcessor>(factory.FactoryNew());
+    auto shaderDir = FileSystem::get()->getProjectRoot() / factory.shaderStoragePath;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    // collect the variants first, the build service compiles all of them (and their stages) in parallel
+    struct Job
+    {
+        std::string          name;
+        ShaderPermutation    permutation;
+        CompiledShaderFuture future;
+    };
+    std::vector<Job> jobs;
+
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(shaderDir, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator();
+         it.increment(ec))
+    {
+        if (!it->is_regular_file() || it->path().extension() != ".glsl") {
+            continue;
+        }
+
+        std::string name = std::filesystem::relative(it->path(), shaderDir).generic_string();
+        std::string source;
+        if (!processor->readSource(name, source)) {
+            continue;
+        }
+        // include-only files have no stage
+        if (source.find("#type") == std::string::npos) {
+            continue;
+        }
+
+        for (auto &permutation : GLSLScriptProcessor::parsePermutations(source)) {
+            auto future = ShaderBuildService::get()->request(name, permutation);
+            jobs.push_back({name, std::move(permutation), std::move(future)});
+        }
+    }
+
+    std::vector<CompiledShaderPtr> shaders;
+    int                            failed = 0;
+    for (auto &job : jobs)
+    {
+        if (CompiledShaderPtr compiled = job.future.get()) {
+            shaders.push_back(std::move(compiled));
+        }
+        else {
+            NE_CORE_ERROR("Failed to cook {} [{}]", job.name, job.permutation.key());
+            ++failed;
+        }
+    }
+
+    ShaderBuildService::shutdown();
+
+    if (failed > 0) {
+        NE_CORE_ERROR("{} of {} variants failed, {} is not written", failed, jobs.size(), outputPath);
+        return 1;
+    }
+
+    // stable order, so the same sources always produce the same pack
+    std::sort(shaders.begin(), shaders.end(), [](const CompiledShaderPtr &a, const CompiledShaderPtr &b) {
+        return std::tie(a->name, a->permutation.defines) < std::tie(b->name, b->permutation.defines);
+    });
+
+    std::vector<uint8_t> bytes;
+    ShaderLibrary::write(shaders, bytes);
+    if (!FileSystem::get()->writeFile(outputPath, std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size()))) {
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    NE_CORE_INFO("Cooked {} shader variants into {} ({} bytes) in {:.1f} ms", shaders.size(), outputPath, bytes.size(), elapsed);
+    return 0;
+}
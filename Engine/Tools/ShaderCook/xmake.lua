@@ -0,0 +1,33 @@
+-- Offline shader cooker, writes Engine/Intermediate/Shader/ShaderLibrary.nslib
+-- usage: xmake run neon-shadercook [output path]
+target("neon-shadercook")
+do
+    set_kind("binary")
+    set_group("tools")
+
+    add_files("./main.cpp")
+    add_files(
+        "../../Source/Core/Log.cpp",
+        "../../Source/Core/FileSystem/FileSystem.cpp",
+        "../../Source/Core/FileSystem/MappedFile.cpp",
+        "../../Source/Render/Shader.cpp",
+        "../../Source/Render/ShaderBuildService.cpp",
+        "../../Source/Render/ShaderLibrary.cpp"
+    )
+    add_includedirs("../../Source")
+
+    add_deps("utility.cc")
+    add_deps("log.cc")
+    add_deps("reflect.cc")
+
+    add_packages("libsdl3")
+    add_packages("glm")
+    add_packages("shaderc")
+    add_packages("spirv-cross")
+
+    add_defines("NE_WITH_SHADER_COMPILER=1")
+
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+end
@@ -0,0 +1,7 @@
+local function include_xmake(path)
+    includes(path .. "/xmake.lua")
+end
+
+include_xmake("./ShaderCook")
+include_xmake("./ShaderBench")
+include_xmake("./AssetCook")